@@ -10,7 +10,7 @@
 --
 DROP TABLE IF EXISTS `custom_allowed_ips`;
 CREATE TABLE `custom_allowed_ips` (
-  `ip` varchar(15) NOT NULL DEFAULT '127.0.0.1' COMMENT 'IPv4 Address',
+  `ip` varchar(45) NOT NULL DEFAULT '127.0.0.1' COMMENT 'IPv4/IPv6 주소 또는 CIDR 대역 (예: 203.0.113.0/24)',
   `description` varchar(255) DEFAULT NULL COMMENT 'IP 주소에 대한 설명',
   `max_connections` int unsigned NOT NULL DEFAULT 2 COMMENT '이 IP에 허용되는 최대 연결 수',
   `max_unique_accounts` int unsigned NOT NULL DEFAULT 1 COMMENT '시간 빈도 우회에 허용되는 최대 고유 계정 수',
@@ -39,16 +39,55 @@ CREATE TABLE `account_formation` (
   `loginCount` INT UNSIGNED NOT NULL DEFAULT 1 COMMENT '이 IP에서 로그인한 총 수',
   PRIMARY KEY (`id`),
   UNIQUE KEY `uq_account_ip` (`accountId`, `ipAddress`),
-  KEY `idx_ipAddress` (`ipAddress`)
+  -- `.account ip` / `.ip accounts` 페이지 조회용 (InnoDB 보조 인덱스에는 기본 키 id 가 뒤에 붙습니다)
+  KEY `idx_account_lastSeen` (`accountId`, `lastSeen`),
+  KEY `idx_ip_lastSeen` (`ipAddress`, `lastSeen`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='IP Limit Manager - Logger, 계정 및 IP 관계를 추적합니다.';
 
+--
+-- Table structure for table `account_formation_daily`
+-- 설명: (계정, IP, 날짜) 별 로그인 횟수. 날짜별 파티션으로 나뉘며, 파티션 추가와
+--       보존 기간이 지난 파티션 삭제(DROP PARTITION)는 모듈이 주기적으로 수행합니다.
+--       처음에는 p_future 만 두고, 서버 시작 시 날짜 파티션이 만들어집니다.
+--
+CREATE TABLE IF NOT EXISTS `account_formation_daily` (
+  `day` DATE NOT NULL COMMENT '로그인 날짜 (서버 시간)',
+  `accountId` INT UNSIGNED NOT NULL COMMENT '계정 ID (from acore_auth.account.id)',
+  `ipAddress` VARCHAR(45) NOT NULL COMMENT '로그인 IP 주소 (IPv4/IPv6 compatible)',
+  `loginCount` INT UNSIGNED NOT NULL DEFAULT 0 COMMENT '이 날 이 IP에서 로그인한 수',
+  PRIMARY KEY (`day`, `accountId`, `ipAddress`),
+  -- `.account ip` / `.ip accounts` 기간 조회용
+  KEY `idx_account_day` (`accountId`, `day`),
+  KEY `idx_ip_day` (`ipAddress`, `day`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='IP Limit Manager - Logger, 계정 및 IP 의 일별 로그인 횟수'
+PARTITION BY RANGE COLUMNS (`day`) (
+  PARTITION `p_future` VALUES LESS THAN (MAXVALUE)
+);
+
 --
 -- Table structure for table `ip_login_history`
 -- 설명: 주기적으로 저장하기위한 테이블
 --
 CREATE TABLE IF NOT EXISTS `ip_login_history` (
-  `ip` varchar(15) NOT NULL COMMENT '접속한 계정의 Ip',
+  `ip` varchar(45) NOT NULL COMMENT '접속한 계정의 Ip (IPv4/IPv6)',
   `account_id` int unsigned NOT NULL COMMENT '계정 ID (from acore_auth.account.id)',
   `login_time` int unsigned NOT NULL COMMENT '로그인 시간',
   PRIMARY KEY (`ip`, `account_id`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='IP Limit Manager - 계정 및 IP 를 주기적으로 저장합니다.';
+
+--
+-- Table structure for table `ip_temp_ban`
+-- 설명: 로그인 시도 폭주로 인한 IP 임시 차단. 모듈이 변경을 모아서 기록하고, 서버 시작 시 복구합니다.
+--
+CREATE TABLE IF NOT EXISTS `ip_temp_ban` (
+  `ip` varchar(45) NOT NULL COMMENT '차단된 IP (IPv4/IPv6)',
+  `ban_until` int unsigned NOT NULL COMMENT '차단 종료 시각',
+  `last_ban` int unsigned NOT NULL COMMENT '마지막으로 차단된 시각',
+  `level` tinyint unsigned NOT NULL DEFAULT 0 COMMENT '마지막 차단 단계 (0부터)',
+  PRIMARY KEY (`ip`),
+  KEY `idx_last_ban` (`last_ban`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='IP Limit Manager - 로그인 시도 폭주 임시 차단';
+
+-- 기존 설치본 갱신: IPv6 주소 저장을 위해 컬럼 길이 확장
+ALTER TABLE `ip_login_history` MODIFY `ip` varchar(45) NOT NULL COMMENT '접속한 계정의 Ip (IPv4/IPv6)';
+ALTER TABLE `custom_allowed_ips` MODIFY `ip` varchar(45) NOT NULL DEFAULT '127.0.0.1' COMMENT 'IPv4/IPv6 주소 또는 CIDR 대역 (예: 203.0.113.0/24)';
@@ -0,0 +1,6 @@
+-- 기존 설치본 갱신: `.account ip` / `.ip accounts` 페이지 조회용 인덱스
+-- (mod-iplimit-manager-integrated.sql 은 account_formation 을 다시 만들어 기록이 지워지므로, 기존 설치본에는 이 파일을 적용합니다.)
+ALTER TABLE `account_formation`
+  DROP KEY `idx_ipAddress`,
+  ADD KEY `idx_account_lastSeen` (`accountId`, `lastSeen`),
+  ADD KEY `idx_ip_lastSeen` (`ipAddress`, `lastSeen`);
@@ -0,0 +1,3 @@
+-- 기존 설치본 갱신: IPv6 주소/CIDR 대역 저장을 위해 IP 컬럼 길이 확장
+ALTER TABLE `ip_login_history` MODIFY `ip` varchar(45) NOT NULL COMMENT '접속한 계정의 Ip (IPv4/IPv6)';
+ALTER TABLE `custom_allowed_ips` MODIFY `ip` varchar(45) NOT NULL DEFAULT '127.0.0.1' COMMENT 'IPv4/IPv6 주소 또는 CIDR 대역 (예: 203.0.113.0/24)';
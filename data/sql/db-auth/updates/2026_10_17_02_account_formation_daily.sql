@@ -0,0 +1,14 @@
+-- 기존 설치본 갱신: (계정, IP, 날짜) 별 로그인 횟수 테이블 (날짜 파티션은 서버 시작 시 모듈이 만듭니다)
+CREATE TABLE IF NOT EXISTS `account_formation_daily` (
+  `day` DATE NOT NULL COMMENT '로그인 날짜 (서버 시간)',
+  `accountId` INT UNSIGNED NOT NULL COMMENT '계정 ID (from acore_auth.account.id)',
+  `ipAddress` VARCHAR(45) NOT NULL COMMENT '로그인 IP 주소 (IPv4/IPv6 compatible)',
+  `loginCount` INT UNSIGNED NOT NULL DEFAULT 0 COMMENT '이 날 이 IP에서 로그인한 수',
+  PRIMARY KEY (`day`, `accountId`, `ipAddress`),
+  -- `.account ip` / `.ip accounts` 기간 조회용
+  KEY `idx_account_day` (`accountId`, `day`),
+  KEY `idx_ip_day` (`ipAddress`, `day`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='IP Limit Manager - Logger, 계정 및 IP 의 일별 로그인 횟수'
+PARTITION BY RANGE COLUMNS (`day`) (
+  PARTITION `p_future` VALUES LESS THAN (MAXVALUE)
+);
@@ -0,0 +1,9 @@
+-- 기존 설치본 갱신: 로그인 시도 폭주 임시 차단 테이블
+CREATE TABLE IF NOT EXISTS `ip_temp_ban` (
+  `ip` varchar(45) NOT NULL COMMENT '차단된 IP (IPv4/IPv6)',
+  `ban_until` int unsigned NOT NULL COMMENT '차단 종료 시각',
+  `last_ban` int unsigned NOT NULL COMMENT '마지막으로 차단된 시각',
+  `level` tinyint unsigned NOT NULL DEFAULT 0 COMMENT '마지막 차단 단계 (0부터)',
+  PRIMARY KEY (`ip`),
+  KEY `idx_last_ban` (`last_ban`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci COMMENT='IP Limit Manager - 로그인 시도 폭주 임시 차단';
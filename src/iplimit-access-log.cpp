@@ -0,0 +1,436 @@
+// Filename iplimit-access-log.cpp
+#include "iplimit-access-log.h"
+#include "iplimit-account-name-cache.h"
+#include "iplimit-metrics.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace
+{
+    std::string const LOG_DIRECTORY = "logs/iplimit";
+    std::string const LOG_PREFIX = "access_log_";
+
+    // std::localtime 은 내부 정적 버퍼를 공유하므로 스레드 안전한 버전을 사용합니다.
+    std::tm LocalTime(std::time_t time)
+    {
+        std::tm result{};
+#ifdef _WIN32
+        localtime_s(&result, &time);
+#else
+        localtime_r(&time, &result);
+#endif
+        return result;
+    }
+
+    char const* ActionName(AccessAction action)
+    {
+        return action == AccessAction::LOGIN ? "login" : "logout";
+    }
+}
+
+AccessLog* AccessLog::instance()
+{
+    static AccessLog instance;
+    return &instance;
+}
+
+AccessLog::~AccessLog()
+{
+    Stop();
+}
+
+void AccessLog::Start(std::string const& startTimeTag, std::size_t queueSize, uint32 flushIntervalMs, uint32 flushLines)
+{
+    if (_running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    // 이전 Stop 이후에도 늦게 도착한 생산자가 있을 수 있으므로 큐는 처음 한 번만 만듭니다.
+    if (!_queue)
+    {
+        _queue = std::make_unique<BoundedMpscQueue<Record>>(queueSize);
+    }
+
+    _startTimeTag = startTimeTag;
+    SetFlushPolicy(flushIntervalMs, flushLines);
+    _archiver.Start(LOG_DIRECTORY, LOG_PREFIX);
+
+    _running.store(true, std::memory_order_release);
+    _thread = std::thread(&AccessLog::Run, this);
+}
+
+void AccessLog::Stop()
+{
+    if (!_running.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    _wake.notify_one();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    _archiver.Stop();
+}
+
+void AccessLog::SetFlushPolicy(uint32 flushIntervalMs, uint32 flushLines)
+{
+    _flushIntervalMs.store(flushIntervalMs, std::memory_order_relaxed);
+    _flushLines.store(std::max<uint32>(1, flushLines), std::memory_order_relaxed);
+}
+
+void AccessLog::SetRotationPolicy(uint64 maxFileBytes, bool compress, uint64 maxTotalBytes)
+{
+    _maxFileBytes.store(maxFileBytes, std::memory_order_relaxed);
+    _archiver.SetPolicy(compress, maxTotalBytes);
+}
+
+void AccessLog::SetBinaryEnabled(bool enabled)
+{
+    _binaryEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AccessLog::Log(uint32 accountId, IpAddress const& ip, std::string_view username, AccessAction action)
+{
+    if (!_running.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    Record record;
+    record.time = static_cast<int64>(std::time(nullptr));
+    record.ip = ip;
+    record.accountId = accountId;
+    record.action = action;
+
+    std::size_t length = std::min(username.size(), USERNAME_LENGTH - 1);
+    std::memcpy(record.username, username.data(), length);
+    record.username[length] = '\0';
+
+    if (!_queue->TryPush(record))
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32 flushIntervalMs = _flushIntervalMs.load(std::memory_order_relaxed);
+    if (flushIntervalMs == 0 || _queue->ApproxSize() >= _flushLines.load(std::memory_order_relaxed))
+    {
+        if (!_wakeRequested.exchange(true, std::memory_order_relaxed))
+        {
+            _wake.notify_one();
+        }
+    }
+
+    return true;
+}
+
+void AccessLog::Run()
+{
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        // 종료 요청을 먼저 읽은 뒤 큐를 비워, Stop 이전에 들어온 레코드는 모두 기록합니다.
+        bool running = _running.load(std::memory_order_acquire);
+        uint32 flushIntervalMs = _flushIntervalMs.load(std::memory_order_relaxed);
+        uint32 flushLines = _flushLines.load(std::memory_order_relaxed);
+
+        Record record;
+        while (_queue->TryPop(record))
+        {
+            Append(record);
+            if (_pendingLines >= flushLines)
+            {
+                WriteOut();
+                lastFlush = std::chrono::steady_clock::now();
+            }
+        }
+
+        _queue->PublishProgress();
+
+        auto now = std::chrono::steady_clock::now();
+        if (_pendingLines && (!running || now - lastFlush >= std::chrono::milliseconds(flushIntervalMs)))
+        {
+            WriteOut();
+            lastFlush = now;
+        }
+
+        if (!running)
+        {
+            break;
+        }
+
+        // FlushInterval 이 0이면 생산자가 매번 깨우므로 대기는 안전장치 역할만 합니다.
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wake.wait_for(lock, std::chrono::milliseconds(flushIntervalMs ? flushIntervalMs : 100), [this]
+        {
+            return _wakeRequested.load(std::memory_order_relaxed) || !_running.load(std::memory_order_relaxed);
+        });
+        _wakeRequested.store(false, std::memory_order_relaxed);
+    }
+
+    if (_file.is_open())
+    {
+        _file.close();
+    }
+
+    _binary.Close();
+    _binaryAttempted = false;
+
+    // 다시 시작하면 첫 기록에서 파일을 새로 엽니다.
+    _dayStart = _dayEnd = 0;
+}
+
+void AccessLog::UpdateClock(int64 time)
+{
+    if (time == _cachedSecond)
+    {
+        return;
+    }
+
+    std::tm local = LocalTime(static_cast<std::time_t>(time));
+    std::snprintf(_cachedDateTime, sizeof(_cachedDateTime), "%04d-%02d-%02d %02d:%02d:%02d",
+        local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+    _cachedSecond = time;
+}
+
+void AccessLog::UpdateDay(int64 time)
+{
+    std::tm local = LocalTime(static_cast<std::time_t>(time));
+
+    char date[11];
+    std::snprintf(date, sizeof(date), "%04d-%02d-%02d", local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+    _currentDate = date;
+
+    // 자정과 다음 자정 (일광 절약 시간으로 하루가 24시간이 아닐 수 있으므로 mktime 으로 계산)
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    _dayStart = static_cast<int64>(std::mktime(&local));
+
+    local.tm_mday += 1;
+    local.tm_isdst = -1;
+    _dayEnd = static_cast<int64>(std::mktime(&local));
+}
+
+void AccessLog::Append(Record const& record)
+{
+    UpdateClock(record.time);
+
+    // 날짜가 바뀌면 모아 둔 줄을 이전 파일에 쓰고 새 파일로 교체합니다.
+    // 날짜 경계는 교체할 때 한 번만 계산하므로 줄마다 정수 비교만 합니다.
+    if (record.time < _dayStart || record.time >= _dayEnd)
+    {
+        WriteOut();
+
+        std::string closed = _file.is_open() ? CloseFile() : std::string();
+        _binary.Close();
+        _binaryAttempted = false;
+
+        UpdateDay(record.time);
+        bool opened = OpenFile(_currentDate);
+        if (!closed.empty())
+        {
+            _archiver.Submit(closed);
+        }
+
+        if (!opened)
+        {
+            return;
+        }
+    }
+
+    bool binary = _binaryEnabled.load(std::memory_order_relaxed);
+    if (binary != _binaryAttempted)
+    {
+        UpdateBinaryFile(binary);
+    }
+
+    if (_binary.IsOpen())
+    {
+        BinaryAccessLog::Record entry;
+        entry.time = record.time;
+        entry.ip = record.ip;
+        entry.accountId = record.accountId;
+        entry.action = static_cast<uint8>(record.action);
+        _binary.Append(entry);
+    }
+
+    // 사용자명이 없는 종료 기록은 계정 이름 캐시에서 채웁니다. (DB 조회 없음)
+    std::string_view username = record.username;
+    if (username.empty() && sAccountNameCache->Get(record.accountId, _username))
+    {
+        username = _username;
+    }
+
+    char ip[IpAddress::INET6_STRING_LENGTH];
+    std::size_t ipLength = record.ip.Format(ip);
+
+    _buffer.append(_cachedDateTime, 19);
+    _buffer.push_back(',');
+    _buffer.append(ip, ipLength);
+    _buffer.push_back(',');
+    _buffer.append(std::to_string(record.accountId));
+    _buffer.push_back(',');
+    _buffer.append(username.empty() ? std::string_view("unknown") : username);
+    _buffer.push_back(',');
+    _buffer.append(ActionName(record.action));
+    _buffer.push_back('\n');
+    ++_pendingLines;
+}
+
+void AccessLog::WriteOut()
+{
+    if (_buffer.empty())
+    {
+        return;
+    }
+
+    if (_file.is_open())
+    {
+        IpLimitScopedTimer timer(IpLimitTimer::ACCESS_LOG_WRITE);
+        _file.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        _file.flush();
+        _fileBytes += _buffer.size();
+        sIpLimitMetrics->Increment(IpLimitCounter::ACCESS_LOG_LINES, _pendingLines);
+
+        std::string error;
+        if (!_binary.Flush(error))
+        {
+            LOG_ERROR("module.iplimit", "Failed to write binary access log {}: {}", _binaryPath, error);
+        }
+    }
+
+    _buffer.clear();
+    _pendingLines = 0;
+
+    uint64 maxFileBytes = _maxFileBytes.load(std::memory_order_relaxed);
+    if (maxFileBytes && _fileBytes >= maxFileBytes && _file.is_open())
+    {
+        RotateFile();
+    }
+}
+
+std::string AccessLog::CloseFile()
+{
+    _file.close();
+
+    // 닫은 파일에는 같은 날짜/시작 시각 안에서 비어 있는 다음 순번을 붙입니다.
+    std::string base = LOG_DIRECTORY + "/" + LOG_PREFIX + _currentDate + "_" + _startTimeTag + ".";
+    std::error_code ec;
+    for (uint32 sequence = 1; ; ++sequence)
+    {
+        std::string target = base + std::to_string(sequence) + ".csv";
+        if (std::filesystem::exists(target, ec) || std::filesystem::exists(target + ".gz", ec))
+        {
+            continue;
+        }
+
+        std::filesystem::rename(_currentPath, target, ec);
+        if (ec)
+        {
+            LOG_ERROR("module.iplimit", "Failed to rotate access log file {}: {}", _currentPath, ec.message());
+            return {};
+        }
+
+        return target;
+    }
+}
+
+void AccessLog::RotateFile()
+{
+    std::string closed = CloseFile();
+    OpenFile(_currentDate);
+    if (!closed.empty())
+    {
+        _archiver.Submit(closed);
+    }
+}
+
+void AccessLog::UpdateBinaryFile(bool enabled)
+{
+    _binary.Close();
+    _binaryPath.clear();
+    _binaryAttempted = enabled;
+
+    // 바이너리 로그는 블록 색인으로 큰 파일도 바로 조회할 수 있으므로 날짜로만 교체하고 압축하지 않습니다.
+    if (enabled)
+    {
+        std::string error;
+        std::string path = LOG_DIRECTORY + "/" + LOG_PREFIX + _currentDate + "_" + _startTimeTag + ".bin";
+        if (_binary.Open(path, error))
+        {
+            _binaryPath = path;
+        }
+        else
+        {
+            LOG_ERROR("module.iplimit", "Failed to open binary access log: {}", error);
+        }
+    }
+
+    _archiver.SetActiveFiles({ _currentPath, _binaryPath });
+}
+
+bool AccessLog::OpenFile(std::string const& date)
+{
+    if (_file.is_open())
+    {
+        _file.close();
+    }
+
+    try
+    {
+        // logs 폴더가 없으면 생성하기, 그외 각종 시스템 로그도 여기에 저장됨
+        if (!std::filesystem::exists(LOG_DIRECTORY))
+        {
+            std::filesystem::create_directories(LOG_DIRECTORY);
+            LOG_INFO("module.iplimit", "Created IPLimit log directory: {}", LOG_DIRECTORY);
+        }
+
+        // 파일명에 서버 시작 시간 추가
+        std::string filename = LOG_DIRECTORY + "/" + LOG_PREFIX + date + "_" + _startTimeTag + ".csv";
+        bool fileExists = std::filesystem::exists(filename);
+        _currentPath = filename;
+        _fileBytes = fileExists ? std::filesystem::file_size(filename) : 0;
+        _archiver.SetActiveFiles({ _currentPath, _binaryPath });
+
+        // 이전 실행에서 압축하지 못하고 남은 파일을 처리하고 보존 용량을 맞춥니다.
+        if (!_leftoversSubmitted)
+        {
+            _leftoversSubmitted = true;
+            _archiver.SubmitLeftovers(".csv");
+            _archiver.Submit({});
+        }
+
+        _file.open(filename, std::ios::app | std::ios::binary);
+        if (!_file.is_open())
+        {
+            LOG_ERROR("module.iplimit", "Failed to open access log file: {}", filename);
+            return false;
+        }
+
+        if (!fileExists)
+        {
+            std::string_view const header = "datetime,ip_address,account_id,account_username,action\n";
+            _file.write(header.data(), static_cast<std::streamsize>(header.size()));
+            _fileBytes += header.size();
+        }
+    }
+    catch (std::exception const& e)
+    {
+        LOG_ERROR("module.iplimit", "Failed to open access log file: {}", e.what());
+        return false;
+    }
+
+    return true;
+}
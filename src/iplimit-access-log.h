@@ -0,0 +1,116 @@
+// Filename iplimit-access-log.h
+#ifndef IPLIMIT_ACCESS_LOG_H
+#define IPLIMIT_ACCESS_LOG_H
+
+#include "Define.h"
+#include "iplimit-binary-log.h"
+#include "iplimit-ip-address.h"
+#include "iplimit-log-archiver.h"
+#include "iplimit-mpsc-queue.h"
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+enum class AccessAction : uint8
+{
+    LOGIN,
+    CHARACTER_LOGOUT,   // 캐릭터가 월드에서 나감
+    ACCOUNT_LOGOUT      // 계정 세션 종료 (형식상 예약, 세션 종료 훅이 없어 모듈은 기록하지 않음)
+};
+
+// 접속/종료 기록을 logs/iplimit/access_log_<날짜>_<서버 시작 시각>.csv 에 남기는 비동기 로거
+// 훅에서는 작은 POD 레코드를 잠금 없는 큐에 넣기만 하고, 시각 포맷/파일 교체/쓰기/flush 는 전용 스레드가 처리합니다.
+// flush 는 FlushInterval(ms) 또는 FlushLines(줄) 중 먼저 도달한 조건에서 한 번에 수행합니다.
+// 큐가 가득 차면 훅을 막지 않고 레코드를 버리며, 버린 건수는 GetDroppedCount() 로 확인할 수 있습니다.
+// 날짜가 바뀌거나 파일이 MaxFileSize 에 도달하면 access_log_<날짜>_<서버 시작 시각>.<순번>.csv 로 닫고,
+// 닫힌 파일은 LogArchiver 가 백그라운드에서 gzip 으로 압축하고 보존 용량을 관리합니다.
+// 바이너리 형식을 켜면 같은 기록을 access_log_<날짜>_<서버 시작 시각>.bin 에도 남깁니다. (iplimit-logquery 로 조회)
+class AccessLog
+{
+public:
+    static constexpr std::size_t USERNAME_LENGTH = 32;
+
+    struct Record
+    {
+        int64 time;
+        IpAddress ip;
+        uint32 accountId;
+        AccessAction action;
+        char username[USERNAME_LENGTH];   // 비어 있으면 계정 이름 캐시에서 채웁니다.
+    };
+
+    static AccessLog* instance();
+
+    ~AccessLog();
+
+    // 전용 스레드를 시작합니다. startTimeTag 는 파일명에 붙는 서버 시작 시각(HHMMSS)입니다.
+    void Start(std::string const& startTimeTag, std::size_t queueSize, uint32 flushIntervalMs, uint32 flushLines);
+    // 남은 레코드를 모두 쓰고 스레드를 종료합니다.
+    void Stop();
+    // 설정 재적용 (.reload config)
+    void SetFlushPolicy(uint32 flushIntervalMs, uint32 flushLines);
+    // maxFileBytes 가 0 이면 날짜로만 교체하고, maxTotalBytes 가 0 이면 오래된 파일을 지우지 않습니다.
+    void SetRotationPolicy(uint64 maxFileBytes, bool compress, uint64 maxTotalBytes);
+    // 다음 기록부터 바이너리 로그 기록을 켜거나 끕니다.
+    void SetBinaryEnabled(bool enabled);
+
+    // 큐에 넣지 못했으면 false
+    bool Log(uint32 accountId, IpAddress const& ip, std::string_view username, AccessAction action);
+
+    uint64 GetDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+    void Append(Record const& record);
+    void WriteOut();
+    bool OpenFile(std::string const& date);
+    std::string CloseFile();    // 닫은 파일의 새 경로 (실패하면 빈 문자열)
+    void RotateFile();
+    void UpdateBinaryFile(bool enabled);
+    void UpdateDay(int64 time);
+    void UpdateClock(int64 time);
+
+    std::unique_ptr<BoundedMpscQueue<Record>> _queue;
+    std::thread _thread;
+    std::atomic<bool> _running{false};
+    std::atomic<uint32> _flushIntervalMs{1000};
+    std::atomic<uint32> _flushLines{128};
+    std::atomic<uint64> _dropped{0};
+    std::atomic<uint64> _maxFileBytes{0};
+    std::atomic<bool> _binaryEnabled{false};
+
+    LogArchiver _archiver;
+
+    // 생산자가 FlushLines 이상 쌓였을 때 전용 스레드를 깨웁니다. (놓친 깨우기는 FlushInterval 후 처리)
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    std::atomic<bool> _wakeRequested{false};
+
+    // 아래는 전용 스레드에서만 사용합니다.
+    std::string _startTimeTag;
+    std::ofstream _file;
+    std::string _buffer;
+    uint32 _pendingLines = 0;
+    std::string _currentDate;
+    std::string _currentPath;
+    uint64 _fileBytes = 0;
+    bool _leftoversSubmitted = false;
+    BinaryAccessLogWriter _binary;
+    std::string _binaryPath;
+    bool _binaryAttempted = false;    // 현재 날짜의 바이너리 파일을 열려고 했는지
+    int64 _dayStart = 0;            // 현재 파일 날짜의 [자정, 다음 자정) 범위 (초)
+    int64 _dayEnd = 0;
+    int64 _cachedSecond = -1;
+    char _cachedDateTime[20] = {};   // "YYYY-MM-DD HH:MM:SS"
+    std::string _username;
+};
+
+#define sAccessLog AccessLog::instance()
+
+#endif
@@ -0,0 +1,205 @@
+// Filename iplimit-account-graph.cpp
+#include "iplimit-account-graph.h"
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+AccountIpGraph* AccountIpGraph::instance()
+{
+    static AccountIpGraph instance;
+    return &instance;
+}
+
+uint32_t AccountIpGraph::AddNode(bool isAccount, uint32_t accountId, IpAddress const& ip)
+{
+    uint32_t index = static_cast<uint32_t>(_nodes.size());
+
+    Node node;
+    node.parent = index;
+    node.next = index;
+    node.isAccount = isAccount;
+    node.accountId = accountId;
+    node.ip = ip;
+    node.accounts = isAccount ? 1 : 0;
+    node.ips = isAccount ? 0 : 1;
+    _nodes.push_back(node);
+
+    ++_components;
+    return index;
+}
+
+uint32_t AccountIpGraph::FindRoot(uint32_t node)
+{
+    while (_nodes[node].parent != node)
+    {
+        _nodes[node].parent = _nodes[_nodes[node].parent].parent;
+        node = _nodes[node].parent;
+    }
+
+    return node;
+}
+
+uint32_t AccountIpGraph::FindRootConst(uint32_t node) const
+{
+    while (_nodes[node].parent != node)
+    {
+        node = _nodes[node].parent;
+    }
+
+    return node;
+}
+
+void AccountIpGraph::Union(uint32_t left, uint32_t right)
+{
+    // 구성원이 적은 쪽을 많은 쪽 아래에 붙여 트리 높이를 O(log n) 으로 유지합니다.
+    Node* large = &_nodes[left];
+    Node* small = &_nodes[right];
+    if (large->accounts + large->ips < small->accounts + small->ips)
+    {
+        std::swap(large, small);
+    }
+
+    small->parent = large->parent;
+    large->accounts += small->accounts;
+    large->ips += small->ips;
+    large->links += small->links;
+
+    // 두 원형 리스트의 next 를 맞바꾸면 하나의 원으로 합쳐집니다.
+    std::swap(large->next, small->next);
+    --_components;
+}
+
+void AccountIpGraph::AddLogin(uint32_t accountId, IpAddress const& ip, uint32_t loginTime, uint32_t logins)
+{
+    std::unique_lock<std::shared_mutex> lock(_lock);
+
+    auto account = _accountNodes.try_emplace(accountId);
+    if (account.second)
+    {
+        account.first->second = AddNode(true, accountId, IpAddress());
+    }
+
+    uint32_t accountNode = account.first->second;
+
+    auto address = _ipNodes.try_emplace(ip);
+    if (address.second)
+    {
+        address.first->second = AddNode(false, 0, ip);
+    }
+
+    uint32_t ipNode = address.first->second;
+
+    for (uint32_t index : { accountNode, ipNode })
+    {
+        Node& node = _nodes[index];
+        node.logins += logins;
+        node.lastSeen = std::max(node.lastSeen, loginTime);
+    }
+
+    bool newLink = _links.try_emplace((uint64_t(accountNode) << 32) | ipNode).second;
+    if (!newLink)
+    {
+        return;
+    }
+
+    ++_nodes[accountNode].degree;
+    ++_nodes[ipNode].degree;
+
+    uint32_t accountRoot = FindRoot(accountNode);
+    uint32_t ipRoot = FindRoot(ipNode);
+    if (accountRoot != ipRoot)
+    {
+        Union(accountRoot, ipRoot);
+    }
+
+    ++_nodes[FindRoot(accountNode)].links;
+}
+
+void AccountIpGraph::Clear()
+{
+    std::unique_lock<std::shared_mutex> lock(_lock);
+    _nodes.clear();
+    _nodes.shrink_to_fit();
+    _accountNodes.clear();
+    _ipNodes.clear();
+    _links.clear();
+    _components = 0;
+}
+
+void AccountIpGraph::Collect(uint32_t start, Cluster& out) const
+{
+    Node const& root = _nodes[FindRootConst(start)];
+    out.accounts = root.accounts;
+    out.ips = root.ips;
+    out.links = root.links;
+    out.members.clear();
+    out.members.reserve(root.accounts + root.ips);
+
+    uint32_t index = start;
+    do
+    {
+        Node const& node = _nodes[index];
+
+        Member member;
+        member.isAccount = node.isAccount;
+        member.accountId = node.accountId;
+        member.ip = node.ip;
+        member.logins = node.logins;
+        member.degree = node.degree;
+        member.lastSeen = node.lastSeen;
+        out.members.push_back(member);
+
+        index = node.next;
+    } while (index != start);
+
+    std::sort(out.members.begin(), out.members.end(), [](Member const& left, Member const& right)
+    {
+        if (left.logins != right.logins)
+        {
+            return left.logins > right.logins;
+        }
+
+        return left.lastSeen > right.lastSeen;
+    });
+}
+
+bool AccountIpGraph::FindByAccount(uint32_t accountId, Cluster& out) const
+{
+    std::shared_lock<std::shared_mutex> lock(_lock);
+
+    auto it = _accountNodes.find(accountId);
+    if (it == _accountNodes.end())
+    {
+        return false;
+    }
+
+    Collect(it->second, out);
+    return true;
+}
+
+bool AccountIpGraph::FindByIp(IpAddress const& ip, Cluster& out) const
+{
+    std::shared_lock<std::shared_mutex> lock(_lock);
+
+    auto it = _ipNodes.find(ip);
+    if (it == _ipNodes.end())
+    {
+        return false;
+    }
+
+    Collect(it->second, out);
+    return true;
+}
+
+AccountIpGraph::Stats AccountIpGraph::GetStats() const
+{
+    std::shared_lock<std::shared_mutex> lock(_lock);
+
+    Stats stats;
+    stats.accounts = _accountNodes.size();
+    stats.ips = _ipNodes.size();
+    stats.links = _links.size();
+    stats.components = _components;
+    stats.memory = _nodes.capacity() * sizeof(Node) + _accountNodes.memory_usage() + _ipNodes.memory_usage() + _links.memory_usage();
+    return stats;
+}
@@ -0,0 +1,98 @@
+// Filename iplimit-account-graph.h
+#ifndef IPLIMIT_ACCOUNT_GRAPH_H
+#define IPLIMIT_ACCOUNT_GRAPH_H
+
+#include "iplimit-flat-map.h"
+#include "iplimit-ip-address.h"
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+// 계정-IP 이분 그래프와 연결 요소 (메모리)
+// account_formation 의 (계정, IP) 연결을 시작 시 읽고 로그인마다 추가하며,
+// 유니온-파인드로 서로 이어진 계정/IP 묶음(클러스터)을 유지합니다. 연결은 추가만 되고 삭제되지 않습니다.
+// 각 묶음의 구성원은 원형 연결 리스트로 이어 두어, 묶음 전체를 SQL 없이 구성원 수에 비례하는 시간에 나열합니다.
+// 엔진/도구에서도 쓰이므로 AzerothCore 헤더에 의존하지 않습니다.
+class AccountIpGraph
+{
+public:
+    struct Member
+    {
+        bool isAccount = false;
+        uint32_t accountId = 0;
+        IpAddress ip;
+        uint32_t logins = 0;
+        uint32_t degree = 0;        // 연결된 IP 수(계정) 또는 계정 수(IP)
+        uint32_t lastSeen = 0;
+    };
+
+    struct Cluster
+    {
+        uint32_t accounts = 0;
+        uint32_t ips = 0;
+        uint64_t links = 0;
+        std::vector<Member> members;    // 로그인 횟수, 최근 시각 내림차순
+    };
+
+    struct Stats
+    {
+        std::size_t accounts = 0;
+        std::size_t ips = 0;
+        std::size_t links = 0;
+        std::size_t components = 0;
+        std::size_t memory = 0;
+    };
+
+    static AccountIpGraph* instance();
+
+    // 연결을 추가하고 두 묶음을 합칩니다. logins 는 이 연결로 더할 로그인 횟수입니다.
+    void AddLogin(uint32_t accountId, IpAddress const& ip, uint32_t loginTime, uint32_t logins = 1);
+    void Clear();
+
+    // 해당 계정/IP 가 속한 묶음. 그래프에 없으면 false
+    bool FindByAccount(uint32_t accountId, Cluster& out) const;
+    bool FindByIp(IpAddress const& ip, Cluster& out) const;
+
+    Stats GetStats() const;
+
+private:
+    struct Node
+    {
+        uint32_t parent;
+        uint32_t next;          // 같은 묶음의 다음 구성원 (원형)
+        uint32_t logins = 0;
+        uint32_t degree = 0;
+        uint32_t lastSeen = 0;
+        uint32_t accountId = 0;
+        IpAddress ip;
+        bool isAccount = false;
+
+        // 대표 노드에서만 유효
+        uint32_t accounts = 0;
+        uint32_t ips = 0;
+        uint64_t links = 0;
+    };
+
+    struct LinkHash
+    {
+        std::size_t operator()(uint64_t key) const { return static_cast<std::size_t>(IpAddressHash::Mix(key)); }
+    };
+
+    uint32_t AddNode(bool isAccount, uint32_t accountId, IpAddress const& ip);
+    uint32_t FindRoot(uint32_t node);           // 경로 절반 압축 (쓰기 잠금에서만)
+    uint32_t FindRootConst(uint32_t node) const;
+    void Union(uint32_t left, uint32_t right);
+    void Collect(uint32_t node, Cluster& out) const;
+
+    mutable std::shared_mutex _lock;
+    std::vector<Node> _nodes;
+    FlatHashMap<uint32_t, uint32_t, LinkHash> _accountNodes;
+    FlatHashMap<IpAddress, uint32_t, IpAddressHash> _ipNodes;
+    FlatHashMap<uint64_t, bool, LinkHash> _links;       // (계정 노드 << 32) | IP 노드
+    std::size_t _components = 0;
+};
+
+#define sAccountIpGraph AccountIpGraph::instance()
+
+#endif
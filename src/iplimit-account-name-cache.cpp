@@ -0,0 +1,246 @@
+// Filename iplimit-account-name-cache.cpp
+#include "iplimit-account-name-cache.h"
+#include "iplimit-ip-address.h"
+#include "DatabaseEnv.h"
+#include <ctime>
+
+namespace
+{
+    // 한 번의 IN 쿼리에 넣는 최대 계정 수
+    constexpr std::size_t RESOLVE_BATCH_SIZE = 500;
+}
+
+std::size_t AccountNameCache::AccountIdHash::operator()(uint32 accountId) const
+{
+    return static_cast<std::size_t>(IpAddressHash::Mix(accountId));
+}
+
+AccountNameCache* AccountNameCache::instance()
+{
+    static AccountNameCache instance;
+    return &instance;
+}
+
+void AccountNameCache::Configure(std::size_t capacity, uint32 ttlSeconds)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _capacity = capacity ? capacity : 1;
+    _ttlSeconds = ttlSeconds;
+
+    while (_index.size() > _capacity)
+    {
+        EraseLocked(_tail);
+    }
+}
+
+void AccountNameCache::Put(uint32 accountId, std::string const& username)
+{
+    if (username.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    PutLocked(accountId, username, static_cast<int64>(std::time(nullptr)));
+}
+
+bool AccountNameCache::Get(uint32 accountId, std::string& username)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _index.find(accountId);
+    if (it == _index.end())
+    {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32 index = it->second;
+    if (_nodes[index].expireTime <= static_cast<int64>(std::time(nullptr)))
+    {
+        EraseLocked(index);
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (index != _head)
+    {
+        Unlink(index);
+        PushFront(index);
+    }
+
+    username = _nodes[index].username;
+    _hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void AccountNameCache::Invalidate(uint32 accountId)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _index.find(accountId);
+    if (it != _index.end())
+    {
+        EraseLocked(it->second);
+    }
+}
+
+void AccountNameCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _nodes.clear();
+    _free.clear();
+    _index.clear();
+    _head = NONE;
+    _tail = NONE;
+}
+
+void AccountNameCache::Resolve(std::vector<uint32> const& accountIds, std::unordered_map<uint32, std::string>& names)
+{
+    std::vector<uint32> missing;
+    for (uint32 accountId : accountIds)
+    {
+        if (names.count(accountId))
+        {
+            continue;
+        }
+
+        std::string username;
+        if (Get(accountId, username))
+        {
+            names.emplace(accountId, std::move(username));
+        }
+        else
+        {
+            missing.push_back(accountId);
+        }
+    }
+
+    // 캐시에 없는 계정은 계정마다 조회하지 않고 묶어서 조회합니다.
+    for (std::size_t offset = 0; offset < missing.size(); offset += RESOLVE_BATCH_SIZE)
+    {
+        std::string idList;
+        for (std::size_t i = offset; i < missing.size() && i < offset + RESOLVE_BATCH_SIZE; ++i)
+        {
+            if (!idList.empty())
+            {
+                idList += ',';
+            }
+
+            idList += std::to_string(missing[i]);
+        }
+
+        QueryResult result = LoginDatabase.Query("SELECT id, username FROM account WHERE id IN ({})", idList);
+        if (!result)
+        {
+            continue;
+        }
+
+        do
+        {
+            Field* fields = result->Fetch();
+            uint32 accountId = fields[0].Get<uint32>();
+            std::string username = fields[1].Get<std::string>();
+
+            Put(accountId, username);
+            names[accountId] = std::move(username);
+        } while (result->NextRow());
+    }
+}
+
+AccountNameCache::Stats AccountNameCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return { _hits.load(std::memory_order_relaxed), _misses.load(std::memory_order_relaxed), _index.size(), _capacity };
+}
+
+void AccountNameCache::Unlink(uint32 index)
+{
+    Node& node = _nodes[index];
+    if (node.prev != NONE)
+    {
+        _nodes[node.prev].next = node.next;
+    }
+    else
+    {
+        _head = node.next;
+    }
+
+    if (node.next != NONE)
+    {
+        _nodes[node.next].prev = node.prev;
+    }
+    else
+    {
+        _tail = node.prev;
+    }
+
+    node.prev = NONE;
+    node.next = NONE;
+}
+
+void AccountNameCache::PushFront(uint32 index)
+{
+    Node& node = _nodes[index];
+    node.prev = NONE;
+    node.next = _head;
+
+    if (_head != NONE)
+    {
+        _nodes[_head].prev = index;
+    }
+
+    _head = index;
+    if (_tail == NONE)
+    {
+        _tail = index;
+    }
+}
+
+void AccountNameCache::EraseLocked(uint32 index)
+{
+    Unlink(index);
+    _index.erase(_nodes[index].accountId);
+    _nodes[index].username.clear();
+    _free.push_back(index);
+}
+
+void AccountNameCache::PutLocked(uint32 accountId, std::string const& username, int64 now)
+{
+    auto result = _index.try_emplace(accountId);
+    uint32 index;
+
+    if (!result.second)
+    {
+        index = result.first->second;
+        Unlink(index);
+    }
+    else
+    {
+        // 가득 차면 가장 오래 사용하지 않은 항목의 자리를 재사용합니다.
+        if (_index.size() > _capacity && _tail != NONE)
+        {
+            EraseLocked(_tail);
+        }
+
+        if (!_free.empty())
+        {
+            index = _free.back();
+            _free.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32>(_nodes.size());
+            _nodes.emplace_back();
+        }
+
+        // EraseLocked 가 테이블을 재배치했을 수 있으므로 다시 찾아 기록합니다.
+        _index[accountId] = index;
+    }
+
+    Node& node = _nodes[index];
+    node.accountId = accountId;
+    node.username = username;
+    node.expireTime = now + _ttlSeconds;
+    PushFront(index);
+}
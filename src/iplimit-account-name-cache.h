@@ -0,0 +1,80 @@
+// Filename iplimit-account-name-cache.h
+#ifndef IPLIMIT_ACCOUNT_NAME_CACHE_H
+#define IPLIMIT_ACCOUNT_NAME_CACHE_H
+
+#include "Define.h"
+#include "iplimit-flat-map.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 계정 ID -> 사용자명 캐시 (크기 제한 LRU)
+// 로그인 승인 쿼리에서 함께 읽은 이름으로 채우고, 접속 로그와 관리 명령이 DB 조회 대신 사용합니다.
+// 코어에는 계정 이름 변경/삭제 훅이 없으므로 항목은 TTL 이 지나면 만료되며, 로그인할 때마다 새 이름으로 갱신됩니다.
+class AccountNameCache
+{
+public:
+    struct Stats
+    {
+        uint64 hits;
+        uint64 misses;
+        std::size_t size;
+        std::size_t capacity;
+    };
+
+    static AccountNameCache* instance();
+
+    // 용량/TTL 변경 (용량을 줄이면 오래된 항목부터 제거)
+    void Configure(std::size_t capacity, uint32 ttlSeconds);
+
+    void Put(uint32 accountId, std::string const& username);
+    bool Get(uint32 accountId, std::string& username);
+    void Invalidate(uint32 accountId);
+    void Clear();
+
+    // 여러 계정의 이름을 한 번에 구합니다. 캐시에 없는 계정만 한 번의 IN 쿼리로 조회하여 캐시에 넣습니다.
+    // 찾지 못한 계정은 결과에 포함되지 않습니다.
+    void Resolve(std::vector<uint32> const& accountIds, std::unordered_map<uint32, std::string>& names);
+
+    Stats GetStats() const;
+
+private:
+    static constexpr uint32 NONE = 0xFFFFFFFF;
+
+    struct Node
+    {
+        uint32 accountId = 0;
+        uint32 prev = NONE;
+        uint32 next = NONE;
+        int64 expireTime = 0;
+        std::string username;
+    };
+
+    struct AccountIdHash
+    {
+        std::size_t operator()(uint32 accountId) const;
+    };
+
+    void Unlink(uint32 index);
+    void PushFront(uint32 index);
+    void EraseLocked(uint32 index);
+    void PutLocked(uint32 accountId, std::string const& username, int64 now);
+
+    mutable std::mutex _lock;
+    std::vector<Node> _nodes;
+    std::vector<uint32> _free;
+    FlatHashMap<uint32, uint32, AccountIdHash> _index;
+    uint32 _head = NONE;   // 가장 최근 사용
+    uint32 _tail = NONE;   // 가장 오래 사용하지 않음
+    std::size_t _capacity = 65536;
+    uint32 _ttlSeconds = 3600;
+
+    std::atomic<uint64> _hits{0};
+    std::atomic<uint64> _misses{0};
+};
+
+#define sAccountNameCache AccountNameCache::instance()
+
+#endif
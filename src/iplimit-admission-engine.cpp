@@ -0,0 +1,309 @@
+// Filename iplimit-admission-engine.cpp
+#include "iplimit-admission-engine.h"
+#include <memory>
+#include <utility>
+
+void MemoryAdmissionStorage::EnableSketches(uint8_t precision, uint32_t buckets, uint32_t exactThreshold)
+{
+    _sketchPrecision = precision;
+    _sketchBuckets = buckets;
+    _exactThreshold = exactThreshold;
+}
+
+uint32_t MemoryAdmissionStorage::InspectLogins(IpAddress const& ip, uint32_t accountId, uint32_t now, uint32_t timeWindow, bool& known)
+{
+    return _history.With(ip, [&](auto& historyMap) -> uint32_t
+    {
+        known = false;
+
+        auto history = historyMap.find(ip);
+        if (history != historyMap.end())
+        {
+            history->second.Expire(now, timeWindow);
+            if (!_exactThreshold || history->second.Size() <= _exactThreshold)
+            {
+                known = history->second.Contains(accountId);
+                return history->second.Size();
+            }
+
+            // 한도가 큰 IP가 기준을 넘으면 지금까지의 기록을 스케치로 옮깁니다.
+            uint32_t estimate = _sketches.With(ip, [&](auto& sketchMap)
+            {
+                auto inserted = sketchMap.try_emplace(ip);
+                UniqueAccountSketch& sketch = inserted.first->second;
+                if (inserted.second)
+                {
+                    _sketchCount.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                sketch.Init(_sketchPrecision, _sketchBuckets, timeWindow);
+                for (LoginWindow::Record const& record : history->second)
+                {
+                    sketch.Add(record.accountId, record.loginTime);
+                }
+
+                return sketch.Estimate(accountId, now, known);
+            });
+
+            historyMap.erase(ip);
+            return estimate;
+        }
+
+        if (!SketchIpCount())
+        {
+            return 0;
+        }
+
+        return _sketches.With(ip, [&](auto& sketchMap) -> uint32_t
+        {
+            auto sketch = sketchMap.find(ip);
+            if (sketch == sketchMap.end())
+            {
+                return 0;
+            }
+
+            // 설정을 다시 읽어 시간 창이 바뀌었으면 새 창으로 처음부터 셉니다.
+            if (sketch->second.Window() != timeWindow)
+            {
+                sketch->second.Init(_sketchPrecision, _sketchBuckets, timeWindow);
+            }
+
+            return sketch->second.Estimate(accountId, now, known);
+        });
+    });
+}
+
+void MemoryAdmissionStorage::RecordLogin(IpAddress const& ip, uint32_t accountId, uint32_t now)
+{
+    _history.With(ip, [&](auto& historyMap)
+    {
+        if (SketchIpCount())
+        {
+            bool sketched = _sketches.With(ip, [&](auto& sketchMap)
+            {
+                auto sketch = sketchMap.find(ip);
+                if (sketch == sketchMap.end())
+                {
+                    return false;
+                }
+
+                sketch->second.Add(accountId, now);
+                return true;
+            });
+
+            if (sketched)
+            {
+                return;
+            }
+        }
+
+        historyMap[ip].Add(accountId, now);
+    });
+}
+
+void MemoryAdmissionStorage::SweepSketches(uint32_t now)
+{
+    if (!SketchIpCount())
+    {
+        return;
+    }
+
+    // 스케치를 쓰는 IP는 한도가 큰 소수뿐이므로 매번 전체를 훑습니다.
+    _sketches.ForEachShard([&](std::size_t, auto& sketchMap)
+    {
+        std::size_t cursor = 0;
+        std::size_t erased = sketchMap.size();
+        sketchMap.sweep(cursor, sketchMap.capacity(), [now](IpAddress const&, UniqueAccountSketch& sketch)
+        {
+            return sketch.Expire(now);
+        });
+
+        erased -= sketchMap.size();
+        if (erased)
+        {
+            _sketchCount.fetch_sub(erased, std::memory_order_relaxed);
+        }
+    });
+}
+
+uint32_t MemoryAdmissionStorage::GetOnlinePlayerCount(IpAddress const& ip, uint32_t excludeAccountId) const
+{
+    return _sessions.GetOnlinePlayerCount(ip, excludeAccountId);
+}
+
+uint32_t MemoryAdmissionStorage::GetSessionCount(IpAddress const& ip, uint32_t excludeAccountId) const
+{
+    return _sessions.GetSessionCount(ip, excludeAccountId);
+}
+
+std::size_t MemoryAdmissionStorage::MemoryUsage() const
+{
+    // 슬롯 배열 외에 인라인 용량을 넘어 힙으로 옮겨간 시간 창도 포함합니다.
+    std::size_t bytes = _history.MemoryUsage() + _sessions.MemoryUsage();
+    _history.ForEachShard([&bytes](std::size_t, auto const& historyMap)
+    {
+        for (auto const& [ip, window] : historyMap)
+        {
+            bytes += window.HeapUsage();
+        }
+    });
+
+    bytes += _sketches.MemoryUsage();
+    _sketches.ForEachShard([&bytes](std::size_t, auto const& sketchMap)
+    {
+        for (auto const& [ip, sketch] : sketchMap)
+        {
+            bytes += sketch.MemoryUsage();
+        }
+    });
+
+    return bytes;
+}
+
+AdmissionEngine::AdmissionEngine(AdmissionClock const& clock, AdmissionStorage& storage, KickScheduler* kicks, BurstLimiter* burst)
+    : _clock(clock), _storage(storage), _kicks(kicks), _burst(burst), _allowList(std::make_shared<AllowList const>())
+{
+}
+
+void AdmissionEngine::ReplaceAllowList(AllowList&& allowList)
+{
+    auto next = std::make_shared<AllowList const>(std::move(allowList));
+
+    std::lock_guard<std::mutex> lock(_allowListWriteLock);
+    _allowList.Store(std::move(next));
+    ++_allowListVersion;
+}
+
+bool AdmissionEngine::ReplaceAllowList(AllowList&& allowList, uint64_t expectedVersion)
+{
+    auto next = std::make_shared<AllowList const>(std::move(allowList));
+
+    std::lock_guard<std::mutex> lock(_allowListWriteLock);
+    if (_allowListVersion != expectedVersion)
+    {
+        return false;
+    }
+
+    _allowList.Store(std::move(next));
+    ++_allowListVersion;
+    return true;
+}
+
+void AdmissionEngine::AllowListInsert(IpPrefix const& prefix, IpLimitSettings const& settings)
+{
+    std::lock_guard<std::mutex> lock(_allowListWriteLock);
+
+    // 판정 중인 스레드가 들고 있는 이전 목록은 마지막 참조가 사라질 때 해제됩니다.
+    auto next = std::make_shared<AllowList>(*_allowList.Load());
+    next->Insert(prefix, settings);
+    _allowList.Store(std::move(next));
+    ++_allowListVersion;
+}
+
+bool AdmissionEngine::AllowListErase(IpPrefix const& prefix)
+{
+    std::lock_guard<std::mutex> lock(_allowListWriteLock);
+
+    auto next = std::make_shared<AllowList>(*_allowList.Load());
+    if (!next->Erase(prefix))
+    {
+        return false;
+    }
+
+    _allowList.Store(std::move(next));
+    ++_allowListVersion;
+    return true;
+}
+
+bool AdmissionEngine::FindAllowed(IpAddress const& address, IpLimitSettings& settings, IpPrefix* matched) const
+{
+    AllowListPointer allowList = _allowList.Load();
+    IpLimitSettings const* found = allowList->Find(address, matched);
+    if (!found)
+    {
+        return false;
+    }
+
+    settings = *found;
+    return true;
+}
+
+uint64_t AdmissionEngine::AllowListVersion() const
+{
+    std::lock_guard<std::mutex> lock(_allowListWriteLock);
+    return _allowListVersion;
+}
+
+AdmissionDecision AdmissionEngine::Evaluate(AdmissionPolicy const& policy, uint32_t accountId, IpAddress const& ip, AdmissionStage stage)
+{
+    AdmissionDecision decision;
+    decision.time = _clock.Now();
+
+    IpLimitSettings settings;
+    decision.allowListed = FindAllowed(ip, settings);
+
+    // 0. 로그인 시도 폭주 제한 (거부된 시도도 토큰을 쓰며, 막히면 나머지 검사와 기록을 건너뜁니다)
+    if (_burst && policy.burstEnable && !decision.allowListed)
+    {
+        BurstResult burst = _burst->Check(policy.burst, ip, decision.time, decision.banUntil);
+        if (burst != BurstResult::ALLOWED)
+        {
+            decision.admitted = false;
+            decision.reason = burst == BurstResult::BANNED ? KickReason::TEMP_BAN : KickReason::BURST_LIMIT;
+            decision.limit = policy.burst.capacity;
+            return decision;
+        }
+    }
+
+    // 1. 고유 계정 로그인 빈도 제한
+    if (policy.rateLimitEnable)
+    {
+        bool known = false;
+        uint32_t uniqueAccounts = _storage.InspectLogins(ip, accountId, decision.time, policy.rateLimitTimeWindow, known);
+        uint32_t maxUniqueAccounts = decision.allowListed ? settings.maxUniqueAccounts : policy.rateLimitMaxUniqueAccounts;
+
+        if (!known && uniqueAccounts >= maxUniqueAccounts)
+        {
+            decision.admitted = false;
+            decision.reason = KickReason::RATE_LIMIT;
+            decision.limit = maxUniqueAccounts;
+        }
+    }
+
+    // 2. 동시 접속 제한 (빈도 제한에 걸리지 않은 경우에만)
+    if (decision.admitted && policy.maxAccountEnable)
+    {
+        uint32_t maxConnections = decision.allowListed ? settings.maxConnections : policy.maxAccount;
+        uint32_t connections = stage == AdmissionStage::SESSION ? _storage.GetSessionCount(ip, accountId) : _storage.GetOnlinePlayerCount(ip, accountId);
+        if (connections >= maxConnections)
+        {
+            decision.admitted = false;
+            decision.reason = KickReason::CONCURRENT_LIMIT;
+            decision.limit = maxConnections;
+        }
+    }
+
+    // 모든 제한을 통과한 경우에만 로그인 기록 추가
+    if (decision.admitted && policy.rateLimitEnable)
+    {
+        _storage.RecordLogin(ip, accountId, decision.time);
+    }
+
+    return decision;
+}
+
+AdmissionDecision AdmissionEngine::Admit(AdmissionPolicy const& policy, uint32_t accountId, IpAddress const& ip, uint64_t guid)
+{
+    AdmissionDecision decision = Evaluate(policy, accountId, ip, AdmissionStage::WORLD);
+    if (!decision.admitted && _kicks)
+    {
+        _kicks->Schedule(guid, { accountId, decision.time + policy.kickDelay, decision.reason });
+    }
+
+    return decision;
+}
+
+AdmissionDecision AdmissionEngine::AdmitSession(AdmissionPolicy const& policy, uint32_t accountId, IpAddress const& ip)
+{
+    return Evaluate(policy, accountId, ip, AdmissionStage::SESSION);
+}
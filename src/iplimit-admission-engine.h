@@ -0,0 +1,182 @@
+// Filename iplimit-admission-engine.h
+#ifndef IPLIMIT_ADMISSION_ENGINE_H
+#define IPLIMIT_ADMISSION_ENGINE_H
+
+#include "iplimit-burst-limiter.h"
+#include "iplimit-cidr-trie.h"
+#include "iplimit-ip-address.h"
+#include "iplimit-kick-scheduler.h"
+#include "iplimit-login-window.h"
+#include "iplimit-session-registry.h"
+#include "iplimit-sharded-map.h"
+#include "iplimit-snapshot.h"
+#include "iplimit-unique-sketch.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// IP별 제한 설정 (화이트리스트 규칙)
+struct IpLimitSettings
+{
+    uint32_t maxConnections;
+    uint32_t maxUniqueAccounts;
+};
+
+// 판정에 사용하는 설정 값 (서버에서는 IpLimitConfig 에서 복사합니다)
+struct AdmissionPolicy
+{
+    bool maxAccountEnable = true;
+    uint32_t maxAccount = 1;
+    bool rateLimitEnable = true;
+    uint32_t rateLimitTimeWindow = 3600;
+    uint32_t rateLimitMaxUniqueAccounts = 1;
+    uint32_t kickDelay = 10;                // 거부된 캐릭터의 강제 퇴장까지 남은 시간 (초)
+    bool burstEnable = false;               // 로그인 시도 폭주 제한 (화이트리스트 IP는 제외)
+    BurstPolicy burst;
+};
+
+// 판정 시점
+enum class AdmissionStage : uint8_t
+{
+    SESSION,    // 계정 인증 직후, 캐릭터 목록 요청 전 (동시 접속은 다른 계정의 세션 수)
+    WORLD       // 캐릭터 월드 입장 (동시 접속은 월드에 입장한 다른 계정의 캐릭터 수)
+};
+
+// 판정 결과
+struct AdmissionDecision
+{
+    bool admitted = true;
+    KickReason reason = KickReason::CONCURRENT_LIMIT;   // 거부 사유 (admitted 가 거짓일 때)
+    bool allowListed = false;                           // 화이트리스트 규칙이 적용되었는지
+    uint32_t limit = 0;                                 // 거부 시 적용된 한도
+    uint32_t time = 0;                                  // 판정 시각
+    uint32_t banUntil = 0;                              // 임시 차단 종료 시각 (TEMP_BAN 일 때)
+};
+
+// 판정 시각의 원천. 서버는 GameTime, 벤치마크/시뮬레이터는 가상 시계를 넣습니다.
+class AdmissionClock
+{
+public:
+    virtual ~AdmissionClock() = default;
+    virtual uint32_t Now() const = 0;
+};
+
+// IP별 판정 상태 저장소
+class AdmissionStorage
+{
+public:
+    virtual ~AdmissionStorage() = default;
+
+    // 시간 창이 지난 기록을 정리한 뒤 고유 계정 수를 반환하고, accountId 가 이미 있는지를 known 에 담습니다.
+    // 기록이 없는 IP는 추가하지 않습니다.
+    virtual uint32_t InspectLogins(IpAddress const& ip, uint32_t accountId, uint32_t now, uint32_t timeWindow, bool& known) = 0;
+    // 통과한 로그인을 기록합니다. 같은 계정의 이전 기록은 새 시각으로 교체됩니다.
+    virtual void RecordLogin(IpAddress const& ip, uint32_t accountId, uint32_t now) = 0;
+    // 해당 IP에서 월드에 입장해 있는 다른 계정의 캐릭터 수
+    virtual uint32_t GetOnlinePlayerCount(IpAddress const& ip, uint32_t excludeAccountId) const = 0;
+    // 해당 IP에서 접속 중인 다른 계정의 세션 수 (캐릭터 선택 화면 포함)
+    virtual uint32_t GetSessionCount(IpAddress const& ip, uint32_t excludeAccountId) const = 0;
+
+    // 추적 중인 IP 수와 대략적인 사용 메모리 (바이트)
+    virtual std::size_t TrackedIpCount() const = 0;
+    virtual std::size_t MemoryUsage() const = 0;
+};
+
+// 기본 저장소: 샤드 맵의 IP별 로그인 시간 창 + 세션 레지스트리의 접속 카운터
+// 근사 모드를 켜면 고유 계정이 exactThreshold 를 넘은 IP의 시간 창을 HyperLogLog 스케치로 옮겨,
+// 한도가 큰 IP도 로그인 수와 무관한 고정 메모리로 추적합니다. 그 이하의 IP는 정확한 시간 창을 그대로 씁니다.
+// 스케치에서는 "이미 기록된 계정" 판정도 근사이므로, 한도에 이른 IP에서 새 계정이 레지스터 점유율만큼 드물게 통과할 수 있습니다.
+// 스케치로 옮긴 IP는 메모리에만 있으며 백업/로컬 저장소에는 남지 않습니다.
+class MemoryAdmissionStorage : public AdmissionStorage
+{
+public:
+    typedef ShardedMap<IpAddress, LoginWindow, IpAddressHash> HistoryMap;
+    typedef ShardedMap<IpAddress, UniqueAccountSketch, IpAddressHash> SketchMap;
+
+    MemoryAdmissionStorage(HistoryMap& history, IpSessionRegistry& sessions) : _history(history), _sessions(sessions) { }
+
+    // 근사 모드 설정. 판정이 시작되기 전에 한 번 호출합니다. exactThreshold 가 0 이면 끕니다.
+    void EnableSketches(uint8_t precision, uint32_t buckets, uint32_t exactThreshold);
+    bool SketchesEnabled() const { return _exactThreshold != 0; }
+    // 창이 지난 스케치 구간을 비우고, 빈 스케치는 정확한 시간 창으로 돌아가도록 지웁니다.
+    void SweepSketches(uint32_t now);
+    std::size_t SketchIpCount() const { return _sketchCount.load(std::memory_order_relaxed); }
+
+    uint32_t InspectLogins(IpAddress const& ip, uint32_t accountId, uint32_t now, uint32_t timeWindow, bool& known) override;
+    void RecordLogin(IpAddress const& ip, uint32_t accountId, uint32_t now) override;
+    uint32_t GetOnlinePlayerCount(IpAddress const& ip, uint32_t excludeAccountId) const override;
+    uint32_t GetSessionCount(IpAddress const& ip, uint32_t excludeAccountId) const override;
+
+    std::size_t TrackedIpCount() const override { return _history.Size() + SketchIpCount(); }
+    std::size_t MemoryUsage() const override;
+
+private:
+    HistoryMap& _history;
+    IpSessionRegistry& _sessions;
+
+    // 잠금 순서: _history 샤드 -> _sketches 샤드
+    SketchMap _sketches;
+    std::atomic<std::size_t> _sketchCount = 0;
+    uint32_t _exactThreshold = 0;
+    uint32_t _sketchBuckets = 0;
+    uint8_t _sketchPrecision = 0;
+};
+
+// 접속 허용 판정 엔진
+// 화이트리스트 조회, 로그인 빈도(고유 계정 수) 검사, 동시 접속 검사, 강제 퇴장 예약을 한곳에 모읍니다.
+// 시계와 저장소를 주입받으므로 AzerothCore 없이 벤치마크/시뮬레이터에서 그대로 실행할 수 있습니다.
+class AdmissionEngine
+{
+public:
+    typedef CidrTrie<IpLimitSettings> AllowList;
+    typedef AtomicSnapshot<AllowList>::Pointer AllowListPointer;
+
+    // kicks 가 없으면 거부 판정만 반환하고 강제 퇴장은 예약하지 않습니다.
+    // burst 가 없으면 로그인 시도 폭주 제한을 건너뜁니다.
+    AdmissionEngine(AdmissionClock const& clock, AdmissionStorage& storage, KickScheduler* kicks = nullptr, BurstLimiter* burst = nullptr);
+
+    AdmissionEngine(AdmissionEngine const&) = delete;
+    AdmissionEngine& operator=(AdmissionEngine const&) = delete;
+
+    // 화이트리스트 (단일 IP 또는 CIDR 대역, 최장 접두사 일치)
+    // 판정마다 읽고 관리 명령으로만 바뀌므로 불변 스냅샷으로 둡니다. 읽는 쪽은 원자적 로드 한 번으로 끝나고,
+    // 쓰는 쪽은 현재 목록을 복사해 고친 뒤 통째로 교체합니다. (쓰기끼리는 잠금으로 순서를 맞춤)
+    AllowListPointer GetAllowList() const { return _allowList.Load(); }
+    void ReplaceAllowList(AllowList&& allowList);
+    // expectedVersion 이후 다른 변경이 없을 때만 교체합니다. (백그라운드 다시 읽기용)
+    bool ReplaceAllowList(AllowList&& allowList, uint64_t expectedVersion);
+    void AllowListInsert(IpPrefix const& prefix, IpLimitSettings const& settings);
+    bool AllowListErase(IpPrefix const& prefix);
+    bool FindAllowed(IpAddress const& address, IpLimitSettings& settings, IpPrefix* matched = nullptr) const;
+    std::size_t AllowListSize() const { return _allowList.Load()->Size(); }
+    // 목록이 바뀔 때마다 1씩 증가
+    uint64_t AllowListVersion() const;
+
+    // 캐릭터 월드 입장을 판정합니다.
+    // 통과하면 빈도 제한용 로그인 기록을 남기고, 거부하면 guid 의 강제 퇴장을 kickDelay 초 뒤로 예약합니다.
+    AdmissionDecision Admit(AdmissionPolicy const& policy, uint32_t accountId, IpAddress const& ip, uint64_t guid);
+    // 인증된 세션을 캐릭터 목록 요청 전에 판정합니다. 강제 퇴장은 예약하지 않으며 거부된 세션은 호출자가 끊습니다.
+    // 통과하면 Admit 과 같이 로그인 기록을 남깁니다.
+    AdmissionDecision AdmitSession(AdmissionPolicy const& policy, uint32_t accountId, IpAddress const& ip);
+
+    AdmissionClock const& GetClock() const { return _clock; }
+    AdmissionStorage& GetStorage() { return _storage; }
+    AdmissionStorage const& GetStorage() const { return _storage; }
+    BurstLimiter* GetBurstLimiter() const { return _burst; }
+
+private:
+    // 시도 폭주 제한 -> 빈도 제한 -> 동시 접속 제한 순서로 검사하고, 통과하면 로그인 기록을 남깁니다.
+    AdmissionDecision Evaluate(AdmissionPolicy const& policy, uint32_t accountId, IpAddress const& ip, AdmissionStage stage);
+
+    AdmissionClock const& _clock;
+    AdmissionStorage& _storage;
+    KickScheduler* _kicks;
+    BurstLimiter* _burst;
+
+    AtomicSnapshot<AllowList> _allowList;
+    mutable std::mutex _allowListWriteLock;
+    uint64_t _allowListVersion = 0;
+};
+
+#endif
@@ -0,0 +1,327 @@
+// Filename iplimit-binary-log.cpp
+#include "iplimit-binary-log.h"
+#include "iplimit-checksum.h"
+#include "iplimit-mapped-file.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace
+{
+    using namespace BinaryAccessLog;
+
+    char const FILE_MAGIC[8] = { 'I', 'P', 'L', 'A', 'C', 'L', 'O', 'G' };
+
+    void Put32(char* out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out[i] = static_cast<char>(value >> (8 * i));
+        }
+    }
+
+    void Put64(char* out, uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            out[i] = static_cast<char>(value >> (8 * i));
+        }
+    }
+
+    uint32_t Get32(char const* in)
+    {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i)
+        {
+            value = (value << 8) | static_cast<unsigned char>(in[i]);
+        }
+
+        return value;
+    }
+
+    uint64_t Get64(char const* in)
+    {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+        {
+            value = (value << 8) | static_cast<unsigned char>(in[i]);
+        }
+
+        return value;
+    }
+
+    void EncodeFileHeader(char* out)
+    {
+        std::memset(out, 0, FILE_HEADER_SIZE);
+        std::memcpy(out, FILE_MAGIC, sizeof(FILE_MAGIC));
+        Put32(out + 8, VERSION);
+        Put32(out + 12, RECORD_SIZE);
+        Put32(out + 16, BLOCK_RECORDS);
+        Put32(out + 20, BLOOM_BYTES);
+        Put32(out + 28, Crc32::Compute(out, 28));
+    }
+
+    // 두 해시의 선형 조합으로 BLOOM_HASHES 개의 비트 위치를 만듭니다. (Kirsch-Mitzenmacher)
+    template<typename Visitor>
+    void ForEachBloomBit(IpAddress const& ip, Visitor&& visit)
+    {
+        // 파일 형식의 일부이므로 바꾸면 VERSION 을 올려야 합니다.
+        uint64_t hash = IpAddressHash::Mix(ip.hi ^ IpAddressHash::Mix(ip.lo));
+
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        for (uint32_t i = 0; i < BLOOM_HASHES; ++i)
+        {
+            visit((h1 + i * h2) % (BLOOM_BYTES * 8));
+        }
+    }
+
+    bool Seek(std::FILE* file, uint64_t offset)
+    {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+}
+
+void BinaryAccessLog::EncodeRecord(char* out, Record const& record)
+{
+    std::memset(out, 0, RECORD_SIZE);
+    Put64(out, static_cast<uint64_t>(record.time));
+    Put64(out + 8, record.ip.hi);
+    Put64(out + 16, record.ip.lo);
+    Put32(out + 24, record.accountId);
+    out[28] = static_cast<char>(record.action);
+}
+
+BinaryAccessLog::Record BinaryAccessLog::DecodeRecord(char const* in)
+{
+    Record record;
+    record.time = static_cast<int64_t>(Get64(in));
+    record.ip.hi = Get64(in + 8);
+    record.ip.lo = Get64(in + 16);
+    record.accountId = Get32(in + 24);
+    record.action = static_cast<uint8_t>(in[28]);
+    return record;
+}
+
+void BinaryAccessLog::BloomAdd(unsigned char* bloom, IpAddress const& ip)
+{
+    ForEachBloomBit(ip, [bloom](uint32_t bit) { bloom[bit >> 3] |= static_cast<unsigned char>(1u << (bit & 7)); });
+}
+
+bool BinaryAccessLog::BloomMayContain(unsigned char const* bloom, IpAddress const& ip)
+{
+    bool found = true;
+    ForEachBloomBit(ip, [bloom, &found](uint32_t bit) { found = found && (bloom[bit >> 3] & (1u << (bit & 7))); });
+    return found;
+}
+
+bool BinaryAccessLog::IsValidFile(char const* data, std::size_t size)
+{
+    return size >= FILE_HEADER_SIZE
+        && std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0
+        && Get32(data + 8) == VERSION
+        && Get32(data + 12) == RECORD_SIZE
+        && Get32(data + 16) == BLOCK_RECORDS
+        && Get32(data + 20) == BLOOM_BYTES
+        && Get32(data + 28) == Crc32::Compute(data, 28);
+}
+
+std::size_t BinaryAccessLog::BlockCount(std::size_t size)
+{
+    return size <= FILE_HEADER_SIZE ? 0 : (size - FILE_HEADER_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE;
+}
+
+bool BinaryAccessLog::ReadBlock(char const* data, std::size_t size, std::size_t index, BlockInfo& block)
+{
+    std::size_t offset = FILE_HEADER_SIZE + index * BLOCK_SIZE;
+    if (offset + BLOCK_HEADER_SIZE > size)
+    {
+        return false;
+    }
+
+    char const* header = data + offset;
+    block.recordCount = Get32(header);
+    if (block.recordCount > BLOCK_RECORDS
+        || Get32(header + 4) != Crc32::Compute(header + 8, BLOCK_HEADER_SIZE - 8, Crc32::Compute(header, 4))
+        || offset + BLOCK_HEADER_SIZE + std::size_t(block.recordCount) * RECORD_SIZE > size)
+    {
+        return false;
+    }
+
+    block.minTime = static_cast<int64_t>(Get64(header + 8));
+    block.maxTime = static_cast<int64_t>(Get64(header + 16));
+    block.bloom = reinterpret_cast<unsigned char const*>(header + 24);
+    block.records = header + BLOCK_HEADER_SIZE;
+    return true;
+}
+
+BinaryAccessLogWriter::~BinaryAccessLogWriter()
+{
+    Close();
+}
+
+bool BinaryAccessLogWriter::Open(std::string const& path, std::string& error)
+{
+    Close();
+    ResetBlock();
+
+    std::error_code ec;
+    uint64_t size = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    _blockOffset = FILE_HEADER_SIZE;
+
+    if (size)
+    {
+        // 기존 파일: 마지막 블록의 헤더/블룸 필터를 읽어 이어서 채웁니다.
+        MappedFile mapped;
+        if (!mapped.Open(path) || !IsValidFile(mapped.Data(), mapped.Size()))
+        {
+            error = "not a binary access log (version " + std::to_string(VERSION) + "): " + path;
+            return false;
+        }
+
+        std::size_t blocks = BlockCount(mapped.Size());
+        if (blocks)
+        {
+            std::size_t last = blocks - 1;
+            _blockOffset = FILE_HEADER_SIZE + last * BLOCK_SIZE;
+
+            // 헤더가 깨진 마지막 블록은 빈 블록으로 보고 덮어씁니다.
+            BlockInfo block;
+            if (ReadBlock(mapped.Data(), mapped.Size(), last, block))
+            {
+                if (block.recordCount == BLOCK_RECORDS)
+                {
+                    _blockOffset += BLOCK_SIZE;
+                }
+                else
+                {
+                    _count = _written = block.recordCount;
+                    _minTime = block.minTime;
+                    _maxTime = block.maxTime;
+                    std::memcpy(_bloom.data(), block.bloom, BLOOM_BYTES);
+                }
+            }
+        }
+    }
+
+    _file = std::fopen(path.c_str(), size ? "r+b" : "w+b");
+    if (!_file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    if (!size)
+    {
+        char header[FILE_HEADER_SIZE];
+        EncodeFileHeader(header);
+        if (std::fwrite(header, 1, sizeof(header), _file) != sizeof(header) || std::fflush(_file) != 0)
+        {
+            error = "cannot write header to " + path;
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BinaryAccessLogWriter::Close()
+{
+    if (_file)
+    {
+        std::string error;
+        Flush(error);
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
+
+void BinaryAccessLogWriter::ResetBlock()
+{
+    _written = 0;
+    _count = 0;
+    _minTime = 0;
+    _maxTime = 0;
+    _bloom.assign(BLOOM_BYTES, 0);
+    _pending.clear();
+}
+
+void BinaryAccessLogWriter::Append(BinaryAccessLog::Record const& record)
+{
+    if (!_file)
+    {
+        return;
+    }
+
+    if (_count == BLOCK_RECORDS)
+    {
+        std::string error;
+        Flush(error);
+    }
+
+    if (!_count)
+    {
+        _minTime = _maxTime = record.time;
+    }
+    else
+    {
+        _minTime = std::min(_minTime, record.time);
+        _maxTime = std::max(_maxTime, record.time);
+    }
+
+    std::size_t offset = _pending.size();
+    _pending.resize(offset + RECORD_SIZE);
+    EncodeRecord(_pending.data() + offset, record);
+    BloomAdd(_bloom.data(), record.ip);
+    ++_count;
+}
+
+void BinaryAccessLogWriter::EncodeBlockHeader(char* out) const
+{
+    Put32(out, _count);
+    Put64(out + 8, static_cast<uint64_t>(_minTime));
+    Put64(out + 16, static_cast<uint64_t>(_maxTime));
+    std::memcpy(out + 24, _bloom.data(), BLOOM_BYTES);
+    Put32(out + 4, Crc32::Compute(out + 8, BLOCK_HEADER_SIZE - 8, Crc32::Compute(out, 4)));
+}
+
+bool BinaryAccessLogWriter::Flush(std::string& error)
+{
+    if (!_file || _pending.empty())
+    {
+        return true;
+    }
+
+    // 레코드를 먼저 쓰고 건수가 담긴 헤더를 나중에 덮어씁니다.
+    char header[BLOCK_HEADER_SIZE];
+    EncodeBlockHeader(header);
+
+    bool ok = Seek(_file, _blockOffset + BLOCK_HEADER_SIZE + uint64_t(_written) * RECORD_SIZE)
+        && std::fwrite(_pending.data(), 1, _pending.size(), _file) == _pending.size()
+        && std::fflush(_file) == 0
+        && Seek(_file, _blockOffset)
+        && std::fwrite(header, 1, sizeof(header), _file) == sizeof(header)
+        && std::fflush(_file) == 0;
+
+    if (!ok)
+    {
+        error = "write failed";
+        return false;
+    }
+
+    _pending.clear();
+    _written = _count;
+    if (_count == BLOCK_RECORDS)
+    {
+        _blockOffset += BLOCK_SIZE;
+        ResetBlock();
+    }
+
+    return true;
+}
@@ -0,0 +1,96 @@
+// Filename iplimit-binary-log.h
+#ifndef IPLIMIT_BINARY_LOG_H
+#define IPLIMIT_BINARY_LOG_H
+
+#include "iplimit-ip-address.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 고정 폭 바이너리 접속 로그 (CSV 와 함께 선택적으로 기록)
+// 파일은 헤더 뒤에 같은 크기의 블록이 이어지며, 블록마다 최소/최대 시각과 IP 블룸 필터를 두어
+// 조회 도구가 대부분의 블록을 레코드를 읽지 않고 건너뛸 수 있게 합니다.
+// 엔진/도구에서도 쓰이므로 AzerothCore 헤더에 의존하지 않습니다. 정수는 little-endian 으로 저장합니다.
+//
+// 파일 헤더 (32바이트)
+//   magic[8] "IPLACLOG", version, recordSize, blockRecords, bloomBytes, reserved, crc32(앞 28바이트)
+// 블록 (BLOCK_SIZE 바이트, 마지막 블록은 기록된 레코드까지만 존재)
+//   recordCount, crc32(헤더 나머지), minTime, maxTime, bloom[BLOOM_BYTES], record[BLOCK_RECORDS]
+// 레코드 (32바이트)
+//   time(int64), ipHi, ipLo, accountId, action, 예약 3바이트
+//
+// 쓰는 쪽은 블록의 레코드를 먼저 쓰고 헤더를 나중에 덮어쓰므로, 중간에 종료되어도 헤더의 건수까지는 항상 유효합니다.
+namespace BinaryAccessLog
+{
+    constexpr uint32_t VERSION = 1;
+    constexpr std::size_t FILE_HEADER_SIZE = 32;
+    constexpr std::size_t RECORD_SIZE = 32;
+    constexpr uint32_t BLOCK_RECORDS = 1024;
+    constexpr std::size_t BLOOM_BYTES = 1024;   // 블록당 서로 다른 IP 1024개에서 오탐률 약 3%
+    constexpr uint32_t BLOOM_HASHES = 3;
+    constexpr std::size_t BLOCK_HEADER_SIZE = 24 + BLOOM_BYTES;
+    constexpr std::size_t BLOCK_SIZE = BLOCK_HEADER_SIZE + BLOCK_RECORDS * RECORD_SIZE;
+
+    struct Record
+    {
+        int64_t time = 0;
+        IpAddress ip;
+        uint32_t accountId = 0;
+        uint8_t action = 0;     // AccessAction 값
+    };
+
+    struct BlockInfo
+    {
+        uint32_t recordCount = 0;
+        int64_t minTime = 0;
+        int64_t maxTime = 0;
+        unsigned char const* bloom = nullptr;
+        char const* records = nullptr;
+    };
+
+    void EncodeRecord(char* out, Record const& record);
+    Record DecodeRecord(char const* in);
+
+    void BloomAdd(unsigned char* bloom, IpAddress const& ip);
+    bool BloomMayContain(unsigned char const* bloom, IpAddress const& ip);
+
+    // 메모리에 올린 파일(data, size)을 검사합니다. 헤더가 맞지 않으면 false
+    bool IsValidFile(char const* data, std::size_t size);
+    // 파일 안에 자리가 있는 블록 수 (마지막 블록은 일부만 있을 수 있음)
+    std::size_t BlockCount(std::size_t size);
+    // 헤더 체크섬이 맞지 않거나 레코드가 파일 끝을 넘으면 false (쓰기 도중 종료된 블록)
+    bool ReadBlock(char const* data, std::size_t size, std::size_t index, BlockInfo& block);
+}
+
+// 바이너리 접속 로그 파일 쓰기 (한 스레드에서만 사용)
+// Append 는 현재 블록 버퍼에만 추가하고, Flush 에서 새 레코드와 블록 헤더를 파일에 씁니다.
+class BinaryAccessLogWriter
+{
+public:
+    ~BinaryAccessLogWriter();
+
+    // 기존 파일이면 마지막 블록부터 이어서 씁니다. 형식이 다른 파일은 덮어쓰지 않고 실패합니다.
+    bool Open(std::string const& path, std::string& error);
+    void Close();
+    bool IsOpen() const { return _file != nullptr; }
+
+    void Append(BinaryAccessLog::Record const& record);
+    bool Flush(std::string& error);
+
+private:
+    void ResetBlock();
+    void EncodeBlockHeader(char* out) const;
+
+    std::FILE* _file = nullptr;
+    uint64_t _blockOffset = 0;
+    uint32_t _written = 0;          // 현재 블록에서 파일에 쓴 레코드 수
+    uint32_t _count = 0;            // 현재 블록의 전체 레코드 수
+    int64_t _minTime = 0;
+    int64_t _maxTime = 0;
+    std::vector<unsigned char> _bloom;
+    std::vector<char> _pending;     // 아직 쓰지 않은 레코드
+};
+
+#endif
@@ -0,0 +1,233 @@
+// Filename iplimit-burst-limiter.cpp
+#include "iplimit-burst-limiter.h"
+#include <algorithm>
+
+BurstLimiter* BurstLimiter::instance()
+{
+    static BurstLimiter instance;
+    return &instance;
+}
+
+void BurstLimiter::Refill(BurstPolicy const& policy, State& state, uint32_t now)
+{
+    if (state.tokens >= policy.capacity)
+    {
+        // 설정을 다시 읽어 버킷이 작아졌을 수 있습니다.
+        state.tokens = policy.capacity;
+        state.refillTime = now;
+        return;
+    }
+
+    if (now <= state.refillTime)
+    {
+        return;
+    }
+
+    uint32_t added = (now - state.refillTime) / std::max<uint32_t>(policy.refillSeconds, 1);
+    if (!added)
+    {
+        return;
+    }
+
+    state.tokens = std::min(policy.capacity, state.tokens + added);
+    state.refillTime = state.tokens == policy.capacity ? now : state.refillTime + added * std::max<uint32_t>(policy.refillSeconds, 1);
+}
+
+void BurstLimiter::QueueBan(IpAddress const& ip, State const& state)
+{
+    std::lock_guard<std::mutex> lock(_pendingLock);
+    _pending[ip] = { ip, state.banUntil, state.lastBan, state.level };
+}
+
+BurstResult BurstLimiter::Check(BurstPolicy const& policy, IpAddress const& ip, uint32_t now, uint32_t& banUntil)
+{
+    return _states.With(ip, [&](auto& stateMap)
+    {
+        auto inserted = stateMap.try_emplace(ip);
+        State& state = inserted.first->second;
+        if (inserted.second)
+        {
+            state.tokens = policy.capacity;
+            state.refillTime = now;
+        }
+
+        if (state.banUntil > now)
+        {
+            banUntil = state.banUntil;
+            return BurstResult::BANNED;
+        }
+
+        Refill(policy, state, now);
+        if (state.tokens)
+        {
+            --state.tokens;
+            return BurstResult::ALLOWED;
+        }
+
+        if (now - state.lastViolation > policy.violationWindow)
+        {
+            state.violations = 0;
+        }
+
+        state.lastViolation = now;
+        if (++state.violations < policy.banThreshold)
+        {
+            return BurstResult::THROTTLED;
+        }
+
+        // 최근에 차단된 적이 있으면 다음 단계로, 아니면 첫 단계부터
+        uint8_t levels = std::clamp<uint8_t>(policy.banLevels, 1, BurstPolicy::MAX_BAN_LEVELS);
+        if (state.banned && now - state.lastBan < policy.banResetSeconds)
+        {
+            state.level = std::min<uint8_t>(state.level + 1, levels - 1);
+        }
+        else
+        {
+            state.level = 0;
+        }
+
+        state.banned = true;
+        state.lastBan = now;
+        state.banUntil = now + policy.banDurations[std::min<uint8_t>(state.level, levels - 1)];
+        state.violations = 0;
+
+        // 차단이 끝나면 가득 찬 버킷으로 다시 시작합니다.
+        state.tokens = policy.capacity;
+        state.refillTime = state.banUntil;
+
+        QueueBan(ip, state);
+        _issuedBans.fetch_add(1, std::memory_order_relaxed);
+
+        banUntil = state.banUntil;
+        return BurstResult::BANNED;
+    });
+}
+
+void BurstLimiter::Restore(TempBan const& ban)
+{
+    _states.With(ban.ip, [&](auto& stateMap)
+    {
+        State& state = stateMap[ban.ip];
+        state.banUntil = ban.banUntil;
+        state.lastBan = ban.lastBan;
+        state.level = ban.level;
+        state.banned = true;
+
+        // 버킷 크기는 설정에 따르므로 가득 찬 것으로 두고 첫 Refill 에서 capacity 로 맞춥니다.
+        state.tokens = UINT32_MAX;
+        state.refillTime = ban.banUntil;
+    });
+}
+
+bool BurstLimiter::Unban(IpAddress const& ip, uint32_t now)
+{
+    bool banned = _states.With(ip, [&](auto& stateMap)
+    {
+        auto state = stateMap.find(ip);
+        if (state == stateMap.end())
+        {
+            return false;
+        }
+
+        bool active = state->second.banUntil > now;
+        stateMap.erase(ip);
+        return active;
+    });
+
+    // 차단 중이 아니었어도 단계 기록이 DB에 남아 있을 수 있으므로 행을 지웁니다.
+    std::lock_guard<std::mutex> lock(_pendingLock);
+    _pending[ip] = { ip, 0, 0, 0 };
+    return banned;
+}
+
+bool BurstLimiter::IsBanned(IpAddress const& ip, uint32_t now, uint32_t& banUntil) const
+{
+    return _states.With(ip, [&](auto const& stateMap)
+    {
+        auto state = stateMap.find(ip);
+        if (state == stateMap.end() || state->second.banUntil <= now)
+        {
+            return false;
+        }
+
+        banUntil = state->second.banUntil;
+        return true;
+    });
+}
+
+void BurstLimiter::Sweep(BurstPolicy const& policy, uint32_t now, uint32_t budget)
+{
+    bool completed = _states.WithShard(_sweepShard, [&](auto& stateMap)
+    {
+        bool passed = stateMap.sweep(_sweepCursor, budget, [&policy, now](IpAddress const&, State& state)
+        {
+            if (state.banUntil > now)
+            {
+                return false;
+            }
+
+            if (state.banned && now - state.lastBan < policy.banResetSeconds)
+            {
+                return false;
+            }
+
+            if (state.violations && now - state.lastViolation <= policy.violationWindow)
+            {
+                return false;
+            }
+
+            Refill(policy, state, now);
+            return state.tokens >= policy.capacity;
+        });
+
+        if (passed)
+        {
+            stateMap.shrink_to_fit();
+        }
+
+        return passed;
+    });
+
+    if (completed)
+    {
+        _sweepShard = (_sweepShard + 1) % _states.SHARD_COUNT;
+    }
+}
+
+void BurstLimiter::TakePendingBans(std::vector<TempBan>& out)
+{
+    std::lock_guard<std::mutex> lock(_pendingLock);
+    out.reserve(out.size() + _pending.size());
+    for (auto const& [ip, ban] : _pending)
+    {
+        out.push_back(ban);
+    }
+
+    _pending.clear();
+}
+
+std::size_t BurstLimiter::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(_pendingLock);
+    return _pending.size();
+}
+
+std::size_t BurstLimiter::BanCount(uint32_t now) const
+{
+    std::size_t count = 0;
+    _states.ForEachShard([&](std::size_t, auto const& stateMap)
+    {
+        for (auto const& [ip, state] : stateMap)
+        {
+            count += state.banUntil > now;
+        }
+    });
+
+    return count;
+}
+
+std::size_t BurstLimiter::MemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(_pendingLock);
+    return _states.MemoryUsage() + _pending.memory_usage();
+}
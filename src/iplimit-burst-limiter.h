@@ -0,0 +1,107 @@
+// Filename iplimit-burst-limiter.h
+#ifndef IPLIMIT_BURST_LIMITER_H
+#define IPLIMIT_BURST_LIMITER_H
+
+#include "iplimit-flat-map.h"
+#include "iplimit-ip-address.h"
+#include "iplimit-sharded-map.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 로그인 시도 폭주 제한 설정
+struct BurstPolicy
+{
+    static constexpr std::size_t MAX_BAN_LEVELS = 8;
+
+    uint32_t capacity = 5;              // 연속으로 허용하는 시도 수 (버킷 크기)
+    uint32_t refillSeconds = 12;        // 토큰 하나가 다시 차는 시간 (초)
+    uint32_t banThreshold = 3;          // violationWindow 안에 이만큼 막히면 임시 차단
+    uint32_t violationWindow = 600;
+    uint32_t banResetSeconds = 86400;   // 마지막 차단 후 이 시간이 지나면 차단 단계를 처음으로 되돌립니다.
+    std::array<uint32_t, MAX_BAN_LEVELS> banDurations = { 60, 600, 3600 };
+    uint8_t banLevels = 3;
+};
+
+enum class BurstResult : uint8_t
+{
+    ALLOWED,
+    THROTTLED,  // 토큰 부족
+    BANNED      // 임시 차단 중 (이번 시도로 차단된 경우 포함)
+};
+
+// 임시 차단 (DB 저장/복구 단위)
+struct TempBan
+{
+    IpAddress ip;
+    uint32_t banUntil = 0;      // 0 이면 차단 해제 (DB 행 삭제)
+    uint32_t lastBan = 0;
+    uint8_t level = 0;          // 마지막 차단의 단계 (0부터)
+};
+
+// IP별 로그인 시도 토큰 버킷과 단계별 임시 차단 (메모리)
+// 시도마다 토큰 하나를 쓰고 refillSeconds 마다 하나씩 다시 채웁니다. 토큰이 없어 막힌 횟수가
+// violationWindow 안에 banThreshold 에 이르면 banDurations 순서로 점점 길게 차단합니다.
+// 판정은 샤드 하나의 잠금 안에서 상수 시간에 끝나며, 차단 변경은 모아 두었다가 TakePendingBans 로 한꺼번에 꺼내 DB에 씁니다.
+// 엔진/도구에서도 쓰이므로 AzerothCore 헤더에 의존하지 않습니다.
+class BurstLimiter
+{
+public:
+    static BurstLimiter* instance();
+
+    // 시도 하나를 판정합니다. 차단 중이면 banUntil 에 종료 시각을 담습니다.
+    BurstResult Check(BurstPolicy const& policy, IpAddress const& ip, uint32_t now, uint32_t& banUntil);
+
+    // DB에서 읽은 차단을 복구합니다. (시작 시, DB에 다시 쓰지 않음)
+    void Restore(TempBan const& ban);
+    // 차단과 단계를 초기화합니다. 차단 중이었으면 true
+    bool Unban(IpAddress const& ip, uint32_t now);
+    bool IsBanned(IpAddress const& ip, uint32_t now, uint32_t& banUntil) const;
+
+    // 버킷이 가득 차고 차단/위반 기록이 모두 지난 IP를 budget 슬롯씩 나눠 제거합니다.
+    void Sweep(BurstPolicy const& policy, uint32_t now, uint32_t budget);
+
+    // 마지막 호출 이후 바뀐 차단을 out 에 옮겨 담습니다. (IP별 최신 상태 하나)
+    void TakePendingBans(std::vector<TempBan>& out);
+    std::size_t GetPendingCount() const;
+
+    std::size_t TrackedIpCount() const { return _states.Size(); }
+    std::size_t BanCount(uint32_t now) const;
+    uint64_t IssuedBanCount() const { return _issuedBans.load(std::memory_order_relaxed); }
+    std::size_t MemoryUsage() const;
+
+private:
+    struct State
+    {
+        uint32_t tokens = 0;
+        uint32_t refillTime = 0;        // 마지막으로 토큰을 채운 시각
+        uint32_t violations = 0;
+        uint32_t lastViolation = 0;
+        uint32_t banUntil = 0;
+        uint32_t lastBan = 0;
+        uint8_t level = 0;
+        bool banned = false;            // 차단된 적이 있는지 (level 이 유효한지)
+    };
+
+    static void Refill(BurstPolicy const& policy, State& state, uint32_t now);
+    void QueueBan(IpAddress const& ip, State const& state);
+
+    ShardedMap<IpAddress, State, IpAddressHash> _states;
+
+    // 잠금 순서: _states 샤드 -> _pendingLock
+    mutable std::mutex _pendingLock;
+    FlatHashMap<IpAddress, TempBan, IpAddressHash> _pending;
+
+    std::atomic<uint64_t> _issuedBans = 0;
+
+    // Sweep 은 월드 스레드에서만 호출합니다.
+    std::size_t _sweepShard = 0;
+    std::size_t _sweepCursor = 0;
+};
+
+#define sBurstLimiter BurstLimiter::instance()
+
+#endif
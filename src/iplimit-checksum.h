@@ -0,0 +1,46 @@
+// Filename iplimit-checksum.h
+#ifndef IPLIMIT_CHECKSUM_H
+#define IPLIMIT_CHECKSUM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE 802.3, zlib crc32 과 같은 값)
+// 로컬 저장 파일의 손상 검사용입니다. 외부 라이브러리 없이 도구에서도 사용할 수 있도록 헤더에 둡니다.
+namespace Crc32
+{
+    constexpr std::array<uint32_t, 256> MakeTable()
+    {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+            }
+
+            table[i] = value;
+        }
+
+        return table;
+    }
+
+    inline constexpr std::array<uint32_t, 256> TABLE = MakeTable();
+
+    // crc 에 이전 결과를 넘기면 이어서 계산합니다.
+    inline uint32_t Compute(void const* data, std::size_t length, uint32_t crc = 0)
+    {
+        unsigned char const* bytes = static_cast<unsigned char const*>(data);
+        crc = ~crc;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            crc = TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+        }
+
+        return ~crc;
+    }
+}
+
+#endif
@@ -0,0 +1,285 @@
+// Filename iplimit-cidr-trie.h
+#ifndef IPLIMIT_CIDR_TRIE_H
+#define IPLIMIT_CIDR_TRIE_H
+
+#include "iplimit-flat-map.h"
+#include "iplimit-ip-address.h"
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// 최장 접두사 일치(longest-prefix-match) 조회를 위한 압축 이진 radix(Patricia) 트라이
+// 조회 비용은 주소 길이(최대 128비트 / 노드 129개)에만 비례하고 규칙 수와는 무관합니다.
+// 노드는 벡터에 인덱스로 연결하여 할당 횟수와 포인터 추적 비용을 줄입니다.
+// 단일 주소(/32, /128) 규칙은 항상 가장 긴 접두사이므로 별도 해시 테이블에 두고 먼저 한 번만 조회합니다.
+// 대부분의 규칙이 단일 주소인 목록에서도 트라이는 범위 규칙만큼만 커져 조회 시 캐시 미스가 늘지 않습니다.
+template<typename Value>
+class CidrTrie
+{
+public:
+    CidrTrie() { Clear(); }
+
+    void Clear()
+    {
+        _nodes.clear();
+        _nodes.push_back(Node());
+        _hosts.clear();
+        _size = 0;
+    }
+
+    std::size_t Size() const { return _size; }
+    bool Empty() const { return _size == 0; }
+
+    // 규칙을 추가하거나 같은 접두사의 값을 교체합니다.
+    void Insert(IpPrefix const& prefix, Value const& value)
+    {
+        if (prefix.IsHost())
+        {
+            auto result = _hosts.try_emplace(prefix.address);
+            result.first->second = value;
+            if (result.second)
+            {
+                ++_size;
+            }
+
+            return;
+        }
+
+        IpAddress key = IpPrefix::Mask(prefix.address, prefix.length);
+        uint8_t length = prefix.length;
+        uint32_t current = 0;
+
+        while (true)
+        {
+            if (_nodes[current].length == length)
+            {
+                SetValue(current, value);
+                return;
+            }
+
+            uint32_t bit = Bit(key, _nodes[current].length);
+            int32_t childIndex = _nodes[current].child[bit];
+            if (childIndex < 0)
+            {
+                uint32_t leaf = NewNode(key, length);
+                SetValue(leaf, value);
+                _nodes[current].child[bit] = static_cast<int32_t>(leaf);
+                return;
+            }
+
+            uint32_t child = static_cast<uint32_t>(childIndex);
+            uint8_t limit = _nodes[child].length < length ? _nodes[child].length : length;
+            uint8_t common = CommonPrefixLength(_nodes[child].prefix, key, limit);
+
+            if (common == _nodes[child].length)
+            {
+                current = child;
+                continue;
+            }
+
+            // 자식과 일부만 겹침: 공통 접두사 위치에 분기 노드를 만듭니다.
+            uint32_t split = NewNode(IpPrefix::Mask(key, common), common);
+            _nodes[split].child[Bit(_nodes[child].prefix, common)] = static_cast<int32_t>(child);
+            _nodes[current].child[bit] = static_cast<int32_t>(split);
+
+            if (common == length)
+            {
+                SetValue(split, value);
+            }
+            else
+            {
+                uint32_t leaf = NewNode(key, length);
+                SetValue(leaf, value);
+                _nodes[split].child[Bit(key, common)] = static_cast<int32_t>(leaf);
+            }
+
+            return;
+        }
+    }
+
+    // 규칙을 제거합니다. 분기 노드는 남겨 두며, 다음 재구성(Clear 후 재삽입) 때 정리됩니다.
+    bool Erase(IpPrefix const& prefix)
+    {
+        if (prefix.IsHost())
+        {
+            if (!_hosts.erase(prefix.address))
+            {
+                return false;
+            }
+
+            --_size;
+            return true;
+        }
+
+        int32_t index = FindNode(prefix);
+        if (index < 0 || !_nodes[index].hasValue)
+        {
+            return false;
+        }
+
+        _nodes[index].hasValue = false;
+        _nodes[index].value = Value();
+        --_size;
+        return true;
+    }
+
+    // 정확히 같은 접두사의 규칙
+    Value const* Get(IpPrefix const& prefix) const
+    {
+        if (prefix.IsHost())
+        {
+            auto it = _hosts.find(prefix.address);
+            return it != _hosts.end() ? &it->second : nullptr;
+        }
+
+        int32_t index = FindNode(prefix);
+        return index >= 0 && _nodes[index].hasValue ? &_nodes[index].value : nullptr;
+    }
+
+    // 주소를 포함하는 규칙 중 가장 긴 접두사의 값 (없으면 nullptr)
+    Value const* Find(IpAddress const& address, IpPrefix* matched = nullptr) const
+    {
+        auto host = _hosts.find(address);
+        if (host != _hosts.end())
+        {
+            if (matched)
+            {
+                matched->address = address;
+                matched->length = 128;
+            }
+
+            return &host->second;
+        }
+
+        Node const* best = nullptr;
+        uint32_t current = 0;
+
+        while (true)
+        {
+            Node const& node = _nodes[current];
+            if (node.hasValue)
+            {
+                best = &node;
+            }
+
+            if (node.length == 128)
+            {
+                break;
+            }
+
+            int32_t child = node.child[Bit(address, node.length)];
+            if (child < 0)
+            {
+                break;
+            }
+
+            Node const& next = _nodes[child];
+            if (IpPrefix::Mask(address, next.length) != next.prefix)
+            {
+                break;
+            }
+
+            current = static_cast<uint32_t>(child);
+        }
+
+        if (!best)
+        {
+            return nullptr;
+        }
+
+        if (matched)
+        {
+            matched->address = best->prefix;
+            matched->length = best->length;
+        }
+
+        return &best->value;
+    }
+
+    std::size_t MemoryUsage() const { return _nodes.capacity() * sizeof(Node) + _hosts.memory_usage(); }
+
+private:
+    struct Node
+    {
+        IpAddress prefix;
+        uint8_t length = 0;
+        bool hasValue = false;
+        int32_t child[2] = { -1, -1 };
+        Value value = Value();
+    };
+
+    static uint32_t Bit(IpAddress const& address, uint8_t position)
+    {
+        return position < 64 ? static_cast<uint32_t>((address.hi >> (63 - position)) & 1) : static_cast<uint32_t>((address.lo >> (127 - position)) & 1);
+    }
+
+    static uint8_t CommonPrefixLength(IpAddress const& left, IpAddress const& right, uint8_t limit)
+    {
+        uint32_t common;
+        if (uint64_t diff = left.hi ^ right.hi)
+        {
+            common = static_cast<uint32_t>(std::countl_zero(diff));
+        }
+        else if (uint64_t diffLo = left.lo ^ right.lo)
+        {
+            common = 64 + static_cast<uint32_t>(std::countl_zero(diffLo));
+        }
+        else
+        {
+            common = 128;
+        }
+
+        return static_cast<uint8_t>(common < limit ? common : limit);
+    }
+
+    uint32_t NewNode(IpAddress const& prefix, uint8_t length)
+    {
+        Node node;
+        node.prefix = prefix;
+        node.length = length;
+        _nodes.push_back(node);
+        return static_cast<uint32_t>(_nodes.size() - 1);
+    }
+
+    void SetValue(uint32_t index, Value const& value)
+    {
+        if (!_nodes[index].hasValue)
+        {
+            _nodes[index].hasValue = true;
+            ++_size;
+        }
+
+        _nodes[index].value = value;
+    }
+
+    int32_t FindNode(IpPrefix const& prefix) const
+    {
+        IpAddress key = IpPrefix::Mask(prefix.address, prefix.length);
+        uint32_t current = 0;
+
+        while (_nodes[current].length < prefix.length)
+        {
+            int32_t child = _nodes[current].child[Bit(key, _nodes[current].length)];
+            if (child < 0)
+            {
+                return -1;
+            }
+
+            Node const& next = _nodes[child];
+            if (next.length > prefix.length || IpPrefix::Mask(key, next.length) != next.prefix)
+            {
+                return -1;
+            }
+
+            current = static_cast<uint32_t>(child);
+        }
+
+        return _nodes[current].length == prefix.length ? static_cast<int32_t>(current) : -1;
+    }
+
+    std::vector<Node> _nodes;
+    FlatHashMap<IpAddress, Value, IpAddressHash> _hosts;
+    std::size_t _size = 0;
+};
+
+#endif
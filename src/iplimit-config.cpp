@@ -0,0 +1,101 @@
+// Filename iplimit-config.cpp
+#include "iplimit-config.h"
+#include "iplimit-snapshot.h"
+#include "Config.h"
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+    AtomicSnapshot<IpLimitConfig>& ConfigSnapshot()
+    {
+        static AtomicSnapshot<IpLimitConfig> snapshot(std::make_shared<IpLimitConfig const>());
+        return snapshot;
+    }
+}
+
+void IpLimitConfig::Load()
+{
+    auto config = std::make_shared<IpLimitConfig>();
+
+    config->enabled = sConfigMgr->GetOption<bool>("EnableIpLimitManager", true);
+    config->announce = sConfigMgr->GetOption<bool>("IpLimitManager.Announce.Enable", true);
+    config->friendlyKickEnable = sConfigMgr->GetOption<bool>("IpLimitManager.FriendlyKick.Enable", false);
+
+    config->maxAccountEnable = sConfigMgr->GetOption<bool>("IpLimitManager.Max.Account.Enable", true);
+    config->maxAccount = sConfigMgr->GetOption<uint32>("IpLimitManager.Max.Account", 1);
+    config->registryReconcileInterval = sConfigMgr->GetOption<uint32>("IpLimitManager.Registry.ReconcileInterval", 60);
+
+    config->rateLimitEnable = sConfigMgr->GetOption<bool>("IpLimitManager.RateLimit.Enable", true);
+    config->rateLimitTimeWindow = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.TimeWindowSeconds", 3600);
+    config->rateLimitMaxUniqueAccounts = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.MaxUniqueAccounts", 1);
+    config->rateLimitSweepInterval = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.SweepInterval", 1000);
+    config->rateLimitSweepBudget = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.SweepBudget", 4096));
+    config->rateLimitApproximateEnable = sConfigMgr->GetOption<bool>("IpLimitManager.RateLimit.Approximate.Enable", false);
+    config->rateLimitApproximateErrorPercent = std::clamp(sConfigMgr->GetOption<float>("IpLimitManager.RateLimit.Approximate.ErrorPercent", 2.0f), 0.1f, 30.0f);
+    config->rateLimitApproximateExactThreshold = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.Approximate.ExactThreshold", 64));
+    config->rateLimitApproximateBuckets = std::clamp<uint32>(sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.Approximate.Buckets", 24), 1, 1024);
+
+    config->burstEnable = sConfigMgr->GetOption<bool>("IpLimitManager.Burst.Enable", false);
+    config->burstCapacity = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.Burst.Capacity", 5));
+    config->burstRefillSeconds = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.Burst.RefillSeconds", 12));
+    config->burstBanThreshold = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.Burst.BanThreshold", 3));
+    config->burstViolationWindow = sConfigMgr->GetOption<uint32>("IpLimitManager.Burst.ViolationWindow", 600);
+    config->burstBanResetSeconds = sConfigMgr->GetOption<uint32>("IpLimitManager.Burst.BanResetSeconds", 86400);
+
+    // "60, 600, 3600" 처럼 쉼표/공백으로 구분된 단계별 차단 시간 (초)
+    std::string banDurations = sConfigMgr->GetOption<std::string>("IpLimitManager.Burst.BanDurations", "60, 600, 3600");
+    std::replace(banDurations.begin(), banDurations.end(), ',', ' ');
+    std::istringstream durations(banDurations);
+    config->burstBanDurations.clear();
+    for (uint32 duration; durations >> duration && config->burstBanDurations.size() < 8;)
+    {
+        config->burstBanDurations.push_back(std::max<uint32>(1, duration));
+    }
+
+    if (config->burstBanDurations.empty())
+    {
+        config->burstBanDurations = { 60, 600, 3600 };
+    }
+
+    config->accountIpLoggerEnable = sConfigMgr->GetOption<bool>("AccountIpLogger.Enable", true);
+    config->accountIpLoggerLogGM = sConfigMgr->GetOption<bool>("AccountIpLogger.Log.GM.Enable", false);
+    config->accountIpLoggerFlushInterval = sConfigMgr->GetOption<uint32>("AccountIpLogger.Flush.Interval", 5000);
+    config->accountIpLoggerFlushBatchSize = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("AccountIpLogger.Flush.BatchSize", 500));
+    config->accountIpLoggerPageSize = std::clamp<uint32>(sConfigMgr->GetOption<uint32>("AccountIpLogger.Command.PageSize", 20), 1, 100);
+    config->accountIpLoggerGraphEnable = sConfigMgr->GetOption<bool>("AccountIpLogger.Graph.Enable", true);
+    config->accountIpLoggerDailyEnable = sConfigMgr->GetOption<bool>("AccountIpLogger.Daily.Enable", true);
+    config->accountIpLoggerDailyRetentionDays = sConfigMgr->GetOption<uint32>("AccountIpLogger.Daily.RetentionDays", 180);
+
+    config->bypassGMEnable = sConfigMgr->GetOption<bool>("IpLimitManager.Bypass.GM.Enable", true);
+    config->bypassGMLevel = sConfigMgr->GetOption<uint32>("IpLimitManager.Bypass.GM.Level", 3);
+
+    config->backupEnable = sConfigMgr->GetOption<bool>("IpLimitManager.Backup.Enable", true);
+    config->backupInterval = sConfigMgr->GetOption<uint32>("IpLimitManager.Backup.Interval", 300);
+    config->backupBatchSize = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.Backup.BatchSize", 500));
+
+    config->localStoreEnable = sConfigMgr->GetOption<bool>("IpLimitManager.LocalStore.Enable", false);
+    config->localStoreDirectory = sConfigMgr->GetOption<std::string>("IpLimitManager.LocalStore.Directory", "iplimit-state");
+    config->localStoreSnapshotInterval = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.LocalStore.SnapshotInterval", 300));
+
+    config->accessLogFlushInterval = sConfigMgr->GetOption<uint32>("IpLimitManager.AccessLog.FlushInterval", 1000);
+    config->accessLogFlushLines = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.AccessLog.FlushLines", 128));
+    config->accessLogQueueSize = std::max<uint32>(2, sConfigMgr->GetOption<uint32>("IpLimitManager.AccessLog.QueueSize", 16384));
+    config->accessLogMaxFileBytes = uint64(sConfigMgr->GetOption<uint32>("IpLimitManager.AccessLog.MaxFileSize", 256)) << 20;
+    config->accessLogCompress = sConfigMgr->GetOption<bool>("IpLimitManager.AccessLog.Compress", true);
+    config->accessLogMaxTotalBytes = uint64(sConfigMgr->GetOption<uint32>("IpLimitManager.AccessLog.MaxTotalSize", 0)) << 20;
+    config->accessLogBinary = sConfigMgr->GetOption<bool>("IpLimitManager.AccessLog.Binary", false);
+
+    config->accountNameCacheSize = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("IpLimitManager.AccountNameCache.Size", 65536));
+    config->accountNameCacheTtl = sConfigMgr->GetOption<uint32>("IpLimitManager.AccountNameCache.TTL", 3600);
+
+    config->statsEnable = sConfigMgr->GetOption<bool>("IpLimitManager.Stats.Enable", true);
+    config->statsLogInterval = sConfigMgr->GetOption<uint32>("IpLimitManager.Stats.LogInterval", 600);
+
+    ConfigSnapshot().Store(std::move(config));
+}
+
+std::shared_ptr<IpLimitConfig const> IpLimitConfig::Get()
+{
+    return ConfigSnapshot().Load();
+}
@@ -0,0 +1,92 @@
+// Filename iplimit-config.h
+#ifndef IPLIMIT_CONFIG_H
+#define IPLIMIT_CONFIG_H
+
+#include "Define.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// IpLimitManager.* / AccountIpLogger.* 설정값을 한 번에 파싱해 둔 불변 스냅샷
+// 훅에서는 sConfigMgr 문자열 조회 대신 IpLimitConfig::Get() 으로 얻은 구조체를 읽습니다.
+// OnAfterConfigLoad 에서 새로 만들어 원자적으로 교체되므로 .reload config 가 재시작 없이 반영됩니다.
+struct IpLimitConfig
+{
+    // 1. 일반 설정
+    bool enabled = true;
+    bool announce = true;
+    bool friendlyKickEnable = false;
+
+    // 2. 다중 접속 제한
+    bool maxAccountEnable = true;
+    uint32 maxAccount = 1;
+    uint32 registryReconcileInterval = 60;
+
+    // 3. 고유 계정 로그인 제한
+    bool rateLimitEnable = true;
+    uint32 rateLimitTimeWindow = 3600;
+    uint32 rateLimitMaxUniqueAccounts = 1;
+    uint32 rateLimitSweepInterval = 1000;
+    uint32 rateLimitSweepBudget = 4096;
+    bool rateLimitApproximateEnable = false;
+    float rateLimitApproximateErrorPercent = 2.0f;
+    uint32 rateLimitApproximateExactThreshold = 64;
+    uint32 rateLimitApproximateBuckets = 24;
+
+    // 3-1. 로그인 시도 폭주 제한
+    bool burstEnable = false;
+    uint32 burstCapacity = 5;
+    uint32 burstRefillSeconds = 12;
+    uint32 burstBanThreshold = 3;
+    uint32 burstViolationWindow = 600;
+    std::vector<uint32> burstBanDurations = { 60, 600, 3600 };
+    uint32 burstBanResetSeconds = 86400;
+
+    // 4. 계정 접속 IP 로깅
+    bool accountIpLoggerEnable = true;
+    bool accountIpLoggerLogGM = false;
+    uint32 accountIpLoggerFlushInterval = 5000;
+    uint32 accountIpLoggerFlushBatchSize = 500;
+    uint32 accountIpLoggerPageSize = 20;
+    bool accountIpLoggerGraphEnable = true;
+    bool accountIpLoggerDailyEnable = true;
+    uint32 accountIpLoggerDailyRetentionDays = 180;
+
+    // 5. GM 계정 우회
+    bool bypassGMEnable = true;
+    uint32 bypassGMLevel = 3;
+
+    // 6. 백업
+    bool backupEnable = true;
+    uint32 backupInterval = 300;
+    uint32 backupBatchSize = 500;
+
+    // 6-1. 로컬 저장소 (스냅샷 + WAL)
+    bool localStoreEnable = false;
+    std::string localStoreDirectory = "iplimit-state";
+    uint32 localStoreSnapshotInterval = 300;
+
+    // 7. 접속 로그 파일 (CSV)
+    uint32 accessLogFlushInterval = 1000;
+    uint32 accessLogFlushLines = 128;
+    uint32 accessLogQueueSize = 16384;
+    uint64 accessLogMaxFileBytes = 256ull << 20;
+    bool accessLogCompress = true;
+    uint64 accessLogMaxTotalBytes = 0;
+    bool accessLogBinary = false;
+
+    // 8. 계정 이름 캐시
+    uint32 accountNameCacheSize = 65536;
+    uint32 accountNameCacheTtl = 3600;
+
+    // 9. 통계
+    bool statsEnable = true;
+    uint32 statsLogInterval = 600;
+
+    // 설정 파일에서 다시 읽어 새 스냅샷을 게시합니다.
+    static void Load();
+    // 현재 스냅샷 (항상 유효한 포인터)
+    static std::shared_ptr<IpLimitConfig const> Get();
+};
+
+#endif
@@ -0,0 +1,289 @@
+// Filename iplimit-flat-map.h
+#ifndef IPLIMIT_FLAT_MAP_H
+#define IPLIMIT_FLAT_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// 오픈 어드레싱(선형 탐사) 해시 맵
+// 노드 할당 없이 연속된 배열에 저장하며, 삭제는 tombstone 대신 backward-shift 로 처리합니다.
+// 용량은 2의 거듭제곱이며 적재율이 7/8 을 넘으면 두 배로 늘어납니다.
+// 반복 순서는 정의되지 않으며, 삽입/삭제 시 반복자와 포인터는 무효화됩니다.
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap
+{
+public:
+    struct Slot
+    {
+        Key first;
+        Value second;
+    };
+
+    template<typename SlotType, typename MapType>
+    class Iterator
+    {
+    public:
+        Iterator(MapType* map, std::size_t index) : _map(map), _index(index) { Skip(); }
+
+        SlotType& operator*() const { return _map->_slots[_index]; }
+        SlotType* operator->() const { return &_map->_slots[_index]; }
+        Iterator& operator++() { ++_index; Skip(); return *this; }
+        bool operator==(Iterator const& right) const { return _index == right._index; }
+        bool operator!=(Iterator const& right) const { return _index != right._index; }
+
+    private:
+        friend class FlatHashMap;
+
+        void Skip()
+        {
+            while (_index < _map->_used.size() && !_map->_used[_index])
+            {
+                ++_index;
+            }
+        }
+
+        MapType* _map;
+        std::size_t _index;
+    };
+
+    typedef Iterator<Slot, FlatHashMap> iterator;
+    typedef Iterator<Slot const, FlatHashMap const> const_iterator;
+
+    FlatHashMap() = default;
+
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    std::size_t capacity() const { return _slots.size(); }
+
+    // 테이블 자체가 차지하는 바이트 수 (값 내부의 동적 할당은 제외)
+    std::size_t memory_usage() const { return _slots.capacity() * sizeof(Slot) + _used.capacity() * sizeof(uint8_t); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, _slots.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, _slots.size()); }
+
+    void swap(FlatHashMap& other)
+    {
+        _slots.swap(other._slots);
+        _used.swap(other._used);
+        std::swap(_size, other._size);
+    }
+
+    void clear()
+    {
+        _slots.clear();
+        _used.clear();
+        _size = 0;
+    }
+
+    void reserve(std::size_t count)
+    {
+        std::size_t capacity = MIN_CAPACITY;
+        while (capacity - capacity / 8 < count)
+        {
+            capacity <<= 1;
+        }
+
+        if (capacity > _slots.size())
+        {
+            Rehash(capacity);
+        }
+    }
+
+    // 원소 수에 비해 테이블이 너무 크면 줄입니다. (대량 삭제 후 메모리 반환용)
+    void shrink_to_fit()
+    {
+        std::size_t capacity = MIN_CAPACITY;
+        while (capacity - capacity / 8 < _size)
+        {
+            capacity <<= 1;
+        }
+
+        if (capacity < _slots.size())
+        {
+            Rehash(capacity);
+        }
+    }
+
+    // 슬롯 [cursor, cursor + budget) 범위에서 pred(key, value) 가 참인 원소를 삭제합니다.
+    // 한 번에 테이블 일부만 검사하여 큰 테이블도 여러 틱에 나눠 정리할 수 있습니다.
+    // 테이블 끝에 도달하면 cursor 를 0으로 되돌리고 true (한 바퀴 완료) 를 반환합니다.
+    template<typename Predicate>
+    bool sweep(std::size_t& cursor, std::size_t budget, Predicate pred)
+    {
+        std::size_t last = cursor + budget < _slots.size() ? cursor + budget : _slots.size();
+        while (cursor < last)
+        {
+            if (_used[cursor] && pred(_slots[cursor].first, _slots[cursor].second))
+            {
+                // backward-shift 로 당겨진 원소가 있을 수 있으므로 같은 슬롯을 다시 검사
+                EraseIndex(cursor);
+                continue;
+            }
+
+            ++cursor;
+        }
+
+        if (cursor >= _slots.size())
+        {
+            cursor = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    iterator find(Key const& key)
+    {
+        std::size_t index;
+        return FindIndex(key, index) ? iterator(this, index) : end();
+    }
+
+    const_iterator find(Key const& key) const
+    {
+        std::size_t index;
+        return FindIndex(key, index) ? const_iterator(this, index) : end();
+    }
+
+    bool contains(Key const& key) const
+    {
+        std::size_t index;
+        return FindIndex(key, index);
+    }
+
+    // 키가 없으면 기본값으로 삽입합니다. (std::unordered_map::operator[] 와 동일)
+    Value& operator[](Key const& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    std::pair<iterator, bool> try_emplace(Key const& key)
+    {
+        std::size_t index;
+        if (FindIndex(key, index))
+        {
+            return { iterator(this, index), false };
+        }
+
+        if ((_size + 1) > _slots.size() - _slots.size() / 8)
+        {
+            Rehash(_slots.empty() ? MIN_CAPACITY : _slots.size() * 2);
+        }
+
+        index = Probe(key);
+        _slots[index].first = key;
+        _slots[index].second = Value();
+        _used[index] = 1;
+        ++_size;
+        return { iterator(this, index), true };
+    }
+
+    std::size_t erase(Key const& key)
+    {
+        std::size_t index;
+        if (!FindIndex(key, index))
+        {
+            return 0;
+        }
+
+        EraseIndex(index);
+        return 1;
+    }
+
+    // 삭제 후 다음 원소를 가리키는 반복자를 반환합니다.
+    // backward-shift 로 뒤쪽 원소가 현재 위치로 당겨질 수 있으므로 같은 위치부터 다시 검사합니다.
+    // (배열 끝에서 감싸 돌아온 원소는 한 번 더 방문될 수 있으므로 조건부 삭제 용도로만 사용합니다.)
+    iterator erase(iterator it)
+    {
+        std::size_t index = it._index;
+        EraseIndex(index);
+        return iterator(this, index);
+    }
+
+private:
+    static constexpr std::size_t MIN_CAPACITY = 16;
+
+    std::size_t Mask() const { return _slots.size() - 1; }
+    std::size_t HomeOf(Key const& key) const { return Hash()(key) & Mask(); }
+
+    bool FindIndex(Key const& key, std::size_t& index) const
+    {
+        if (_size == 0)
+        {
+            return false;
+        }
+
+        for (index = HomeOf(key); _used[index]; index = (index + 1) & Mask())
+        {
+            if (KeyEqual()(_slots[index].first, key))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::size_t Probe(Key const& key) const
+    {
+        std::size_t index = HomeOf(key);
+        while (_used[index])
+        {
+            index = (index + 1) & Mask();
+        }
+
+        return index;
+    }
+
+    void EraseIndex(std::size_t index)
+    {
+        // backward-shift: 빈 칸 뒤의 원소 중 원래 자리(home)로 더 가까워질 수 있는 원소를 당겨옵니다.
+        std::size_t hole = index;
+        std::size_t next = (hole + 1) & Mask();
+        while (_used[next])
+        {
+            std::size_t home = HomeOf(_slots[next].first);
+            if (((next - home) & Mask()) >= ((next - hole) & Mask()))
+            {
+                _slots[hole] = std::move(_slots[next]);
+                hole = next;
+            }
+
+            next = (next + 1) & Mask();
+        }
+
+        _slots[hole] = Slot();
+        _used[hole] = 0;
+        --_size;
+    }
+
+    void Rehash(std::size_t capacity)
+    {
+        std::vector<Slot> oldSlots(capacity);
+        std::vector<uint8_t> oldUsed(capacity, 0);
+        oldSlots.swap(_slots);
+        oldUsed.swap(_used);
+
+        for (std::size_t i = 0; i < oldSlots.size(); ++i)
+        {
+            if (!oldUsed[i])
+            {
+                continue;
+            }
+
+            std::size_t index = Probe(oldSlots[i].first);
+            _slots[index] = std::move(oldSlots[i]);
+            _used[index] = 1;
+        }
+    }
+
+    std::vector<Slot> _slots;
+    std::vector<uint8_t> _used;
+    std::size_t _size = 0;
+};
+
+#endif
@@ -0,0 +1,197 @@
+// Filename iplimit-formation-buffer.cpp
+#include "iplimit-formation-buffer.h"
+#include "DatabaseEnv.h"
+#include "Log.h"
+#include <ctime>
+
+AccountFormationBuffer* AccountFormationBuffer::instance()
+{
+    static AccountFormationBuffer instance;
+    return &instance;
+}
+
+void AccountFormationBuffer::SetDailyEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _dailyEnabled = enabled;
+}
+
+uint32 AccountFormationBuffer::GetDayLocked(uint32 loginTime)
+{
+    if (loginTime >= _dayStart && loginTime < _dayEnd)
+    {
+        return _day;
+    }
+
+    std::time_t value = static_cast<std::time_t>(loginTime);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &value);
+#else
+    localtime_r(&value, &local);
+#endif
+
+    _day = uint32(local.tm_year + 1900) * 10000 + uint32(local.tm_mon + 1) * 100 + uint32(local.tm_mday);
+
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    _dayStart = static_cast<uint32>(std::mktime(&local));
+    local.tm_mday += 1;
+    local.tm_isdst = -1;
+    _dayEnd = static_cast<uint32>(std::mktime(&local));
+    return _day;
+}
+
+void AccountFormationBuffer::Record(uint32 accountId, IpAddress const& ip, uint32 loginTime)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    if (_dailyEnabled)
+    {
+        ++_pendingDaily[{ accountId, ip, GetDayLocked(loginTime) }];
+    }
+
+    auto result = _pending.try_emplace({ accountId, ip });
+    Aggregate& aggregate = result.first->second;
+    if (result.second || loginTime < aggregate.firstSeen)
+    {
+        aggregate.firstSeen = loginTime;
+    }
+
+    if (loginTime > aggregate.lastSeen)
+    {
+        aggregate.lastSeen = loginTime;
+    }
+
+    ++aggregate.count;
+}
+
+uint32 AccountFormationBuffer::Flush(uint32 batchSize, bool synchronous)
+{
+    // 잠금은 맵을 교체하는 동안만 잡고, SQL 생성은 잠금 밖에서 합니다.
+    AggregateMap pending;
+    DailyMap pendingDaily;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_pending.empty())
+        {
+            return 0;
+        }
+
+        pending.swap(_pending);
+        pendingDaily.swap(_pendingDaily);
+    }
+
+    if (!batchSize)
+    {
+        batchSize = 1;
+    }
+
+    uint32 dailyWritten = pendingDaily.empty() ? 0 : FlushDaily(pendingDaily, batchSize, synchronous);
+
+    // firstSeen 은 새 행일 때만, lastSeen 은 더 최근일 때만 반영합니다.
+    // (MariaDB 호환을 위해 VALUES() 구문을 사용합니다.)
+    static char const* const INSERT_PREFIX = "INSERT INTO account_formation (accountId, ipAddress, firstSeen, lastSeen, loginCount) VALUES ";
+    static char const* const UPSERT_SUFFIX = " ON DUPLICATE KEY UPDATE lastSeen = GREATEST(lastSeen, VALUES(lastSeen)), loginCount = loginCount + VALUES(loginCount)";
+
+    std::string sql;
+    uint32 rows = 0;
+    uint32 written = 0;
+
+    auto execute = [&]()
+    {
+        sql += UPSERT_SUFFIX;
+        if (synchronous)
+        {
+            LoginDatabase.DirectExecute(sql);
+        }
+        else
+        {
+            LoginDatabase.Execute(sql);
+        }
+
+        sql.clear();
+        rows = 0;
+    };
+
+    for (auto const& [key, aggregate] : pending)
+    {
+        sql += rows ? "," : INSERT_PREFIX;
+
+        char ip[IpAddress::INET6_STRING_LENGTH];
+        std::size_t ipLength = key.ip.Format(ip);
+        sql += Acore::StringFormat("({}, '{}', FROM_UNIXTIME({}), FROM_UNIXTIME({}), {})",
+            key.accountId, std::string_view(ip, ipLength), aggregate.firstSeen, aggregate.lastSeen, aggregate.count);
+
+        ++written;
+        if (++rows >= batchSize)
+        {
+            execute();
+        }
+    }
+
+    if (rows)
+    {
+        execute();
+    }
+
+    LOG_DEBUG("module.iplimit", "IPLimit: account_formation {}개 행, account_formation_daily {}개 행을 기록했습니다.", written, dailyWritten);
+    return written;
+}
+
+uint32 AccountFormationBuffer::FlushDaily(DailyMap const& pending, uint32 batchSize, bool synchronous)
+{
+    static char const* const INSERT_PREFIX = "INSERT INTO account_formation_daily (day, accountId, ipAddress, loginCount) VALUES ";
+    static char const* const UPSERT_SUFFIX = " ON DUPLICATE KEY UPDATE loginCount = loginCount + VALUES(loginCount)";
+
+    std::string sql;
+    uint32 rows = 0;
+    uint32 written = 0;
+
+    auto execute = [&]()
+    {
+        sql += UPSERT_SUFFIX;
+        if (synchronous)
+        {
+            LoginDatabase.DirectExecute(sql);
+        }
+        else
+        {
+            LoginDatabase.Execute(sql);
+        }
+
+        sql.clear();
+        rows = 0;
+    };
+
+    for (auto const& [key, count] : pending)
+    {
+        sql += rows ? "," : INSERT_PREFIX;
+
+        char ip[IpAddress::INET6_STRING_LENGTH];
+        std::size_t ipLength = key.ip.Format(ip);
+        sql += Acore::StringFormat("('{:04}-{:02}-{:02}', {}, '{}', {})",
+            key.day / 10000, key.day / 100 % 100, key.day % 100, key.accountId, std::string_view(ip, ipLength), count);
+
+        ++written;
+        if (++rows >= batchSize)
+        {
+            execute();
+        }
+    }
+
+    if (rows)
+    {
+        execute();
+    }
+
+    return written;
+}
+
+std::size_t AccountFormationBuffer::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _pending.size();
+}
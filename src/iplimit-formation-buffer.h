@@ -0,0 +1,89 @@
+// Filename iplimit-formation-buffer.h
+#ifndef IPLIMIT_FORMATION_BUFFER_H
+#define IPLIMIT_FORMATION_BUFFER_H
+
+#include "Define.h"
+#include "iplimit-flat-map.h"
+#include "iplimit-ip-address.h"
+#include <mutex>
+
+// account_formation 기록 버퍼
+// 로그인마다 한 줄씩 upsert 하는 대신 (계정, IP) 별로 로그인 횟수와 최초/최근 시각을 메모리에 모아 두고,
+// 월드 업데이트에서 주기적으로 여러 행을 한 번에 upsert 합니다. 서버 종료 시 남은 기록을 동기적으로 씁니다.
+// 일별 기록이 켜져 있으면 (계정, IP, 날짜) 별 로그인 횟수도 함께 모아 account_formation_daily 에 씁니다.
+class AccountFormationBuffer
+{
+public:
+    static AccountFormationBuffer* instance();
+
+    void SetDailyEnabled(bool enabled);
+
+    void Record(uint32 accountId, IpAddress const& ip, uint32 loginTime);
+
+    // 모아 둔 기록을 batchSize 행 단위의 INSERT ... ON DUPLICATE KEY UPDATE 로 씁니다.
+    // synchronous 가 참이면 DirectExecute 로 완료될 때까지 기다립니다. (종료 시)
+    // 쓴 (계정, IP) 행 수를 반환합니다.
+    uint32 Flush(uint32 batchSize, bool synchronous = false);
+
+    std::size_t GetPendingCount() const;
+
+private:
+    struct Key
+    {
+        uint32 accountId = 0;
+        IpAddress ip;
+
+        bool operator==(Key const& right) const { return accountId == right.accountId && ip == right.ip; }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(Key const& key) const
+        {
+            return IpAddressHash()(key.ip) ^ static_cast<std::size_t>(IpAddressHash::Mix(key.accountId));
+        }
+    };
+
+    struct Aggregate
+    {
+        uint32 count = 0;
+        uint32 firstSeen = 0;
+        uint32 lastSeen = 0;
+    };
+
+    struct DailyKey
+    {
+        uint32 accountId = 0;
+        IpAddress ip;
+        uint32 day = 0;         // 서버 시간 기준 YYYYMMDD
+
+        bool operator==(DailyKey const& right) const { return accountId == right.accountId && ip == right.ip && day == right.day; }
+    };
+
+    struct DailyKeyHash
+    {
+        std::size_t operator()(DailyKey const& key) const
+        {
+            return IpAddressHash()(key.ip) ^ static_cast<std::size_t>(IpAddressHash::Mix((uint64(key.day) << 32) | key.accountId));
+        }
+    };
+
+    typedef FlatHashMap<Key, Aggregate, KeyHash> AggregateMap;
+    typedef FlatHashMap<DailyKey, uint32, DailyKeyHash> DailyMap;
+
+    // loginTime 이 속한 날짜 (잠금 안에서 호출, 하루 범위를 캐시하여 localtime 호출을 줄임)
+    uint32 GetDayLocked(uint32 loginTime);
+    uint32 FlushDaily(DailyMap const& pending, uint32 batchSize, bool synchronous);
+
+    mutable std::mutex _lock;
+    AggregateMap _pending;
+    DailyMap _pendingDaily;
+    bool _dailyEnabled = false;
+    uint32 _dayStart = 0;
+    uint32 _dayEnd = 0;
+    uint32 _day = 0;
+};
+
+#define sAccountFormation AccountFormationBuffer::instance()
+
+#endif
@@ -0,0 +1,429 @@
+// Filename iplimit-history-store.cpp
+#include "iplimit-history-store.h"
+#include "iplimit-checksum.h"
+#include "iplimit-mapped-file.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+namespace
+{
+    char const SNAPSHOT_MAGIC[8] = { 'I', 'P', 'L', 'H', 'S', 'N', 'A', 'P' };
+    char const WAL_MAGIC[8] = { 'I', 'P', 'L', 'H', 'W', 'A', 'L', '\0' };
+
+    constexpr std::size_t RECORD_SIZE = 24;
+    constexpr std::size_t SNAPSHOT_HEADER_SIZE = 48;
+    constexpr std::size_t WAL_HEADER_SIZE = 24;
+    constexpr std::size_t WAL_ENTRY_SIZE = RECORD_SIZE + 4;
+
+    char const* SNAPSHOT_FILE = "login_history.snap";
+    char const* SNAPSHOT_TEMP_FILE = "login_history.snap.tmp";
+    char const* WAL_FILE = "login_history.wal";
+    char const* WAL_OLD_FILE = "login_history.wal.old";
+
+    void Put32(char* out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            out[i] = static_cast<char>(value >> (8 * i));
+        }
+    }
+
+    void Put64(char* out, uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            out[i] = static_cast<char>(value >> (8 * i));
+        }
+    }
+
+    uint32_t Get32(char const* in)
+    {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i)
+        {
+            value = (value << 8) | static_cast<unsigned char>(in[i]);
+        }
+
+        return value;
+    }
+
+    uint64_t Get64(char const* in)
+    {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+        {
+            value = (value << 8) | static_cast<unsigned char>(in[i]);
+        }
+
+        return value;
+    }
+
+    void EncodeRecord(char* out, LoginHistoryStore::Record const& record)
+    {
+        Put64(out, record.ipHi);
+        Put64(out + 8, record.ipLo);
+        Put32(out + 16, record.accountId);
+        Put32(out + 20, record.loginTime);
+    }
+
+    LoginHistoryStore::Record DecodeRecord(char const* in)
+    {
+        return { Get64(in), Get64(in + 8), Get32(in + 16), Get32(in + 20) };
+    }
+
+    void EncodeWalHeader(char* out)
+    {
+        std::memset(out, 0, WAL_HEADER_SIZE);
+        std::memcpy(out, WAL_MAGIC, sizeof(WAL_MAGIC));
+        Put32(out + 8, LoginHistoryStore::VERSION);
+        Put32(out + 12, RECORD_SIZE);
+        Put32(out + 20, Crc32::Compute(out, 20));
+    }
+
+    bool IsValidWalHeader(char const* data, std::size_t size)
+    {
+        return size >= WAL_HEADER_SIZE
+            && std::memcmp(data, WAL_MAGIC, sizeof(WAL_MAGIC)) == 0
+            && Get32(data + 8) == LoginHistoryStore::VERSION
+            && Get32(data + 12) == RECORD_SIZE
+            && Get32(data + 20) == Crc32::Compute(data, 20);
+    }
+
+    // 헤더 이후 체크섬이 맞는 항목이 끝나는 위치 (잘리거나 손상된 꼬리는 제외)
+    std::size_t ValidWalLength(char const* data, std::size_t size)
+    {
+        std::size_t offset = WAL_HEADER_SIZE;
+        while (offset + WAL_ENTRY_SIZE <= size && Get32(data + offset + RECORD_SIZE) == Crc32::Compute(data + offset, RECORD_SIZE))
+        {
+            offset += WAL_ENTRY_SIZE;
+        }
+
+        return offset;
+    }
+
+    bool SyncFile(std::FILE* file)
+    {
+        if (std::fflush(file) != 0)
+        {
+            return false;
+        }
+
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return ::fsync(fileno(file)) == 0;
+#endif
+    }
+}
+
+LoginHistoryStore::LoginHistoryStore(std::string directory) : _directory(std::move(directory))
+{
+}
+
+LoginHistoryStore::~LoginHistoryStore()
+{
+    std::lock_guard<std::mutex> lock(_fileLock);
+    if (_wal)
+    {
+        std::fclose(_wal);
+    }
+}
+
+std::string LoginHistoryStore::Path(char const* name) const
+{
+    return (std::filesystem::path(_directory) / name).string();
+}
+
+bool LoginHistoryStore::Load(RecordHandler const& handler, LoadStats& stats) const
+{
+    bool found = false;
+
+    MappedFile snapshot;
+    if (snapshot.Open(Path(SNAPSHOT_FILE)))
+    {
+        found = true;
+        char const* data = snapshot.Data();
+        std::size_t size = snapshot.Size();
+
+        if (size < SNAPSHOT_HEADER_SIZE || std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0
+            || Get32(data + 40) != Crc32::Compute(data, 40))
+        {
+            stats.warnings.push_back("스냅샷 헤더가 손상되어 건너뜁니다.");
+        }
+        else if (Get32(data + 8) != VERSION || Get32(data + 12) != RECORD_SIZE)
+        {
+            stats.warnings.push_back("스냅샷 형식 버전(" + std::to_string(Get32(data + 8)) + ")이 달라 건너뜁니다.");
+        }
+        else
+        {
+            uint64_t count = Get64(data + 16);
+            char const* payload = data + SNAPSHOT_HEADER_SIZE;
+
+            if (size - SNAPSHOT_HEADER_SIZE != count * RECORD_SIZE || Get32(data + 32) != Crc32::Compute(payload, count * RECORD_SIZE))
+            {
+                stats.warnings.push_back("스냅샷 체크섬이 맞지 않아 건너뜁니다.");
+            }
+            else
+            {
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    handler(DecodeRecord(payload + i * RECORD_SIZE));
+                }
+
+                stats.snapshotLoaded = true;
+                stats.snapshotRecords = count;
+            }
+        }
+    }
+
+    found |= ReplayWal(Path(WAL_OLD_FILE), handler, stats);
+    found |= ReplayWal(Path(WAL_FILE), handler, stats);
+    return found;
+}
+
+bool LoginHistoryStore::ReplayWal(std::string const& path, RecordHandler const& handler, LoadStats& stats) const
+{
+    MappedFile wal;
+    if (!wal.Open(path))
+    {
+        return false;
+    }
+
+    char const* data = wal.Data();
+    std::size_t size = wal.Size();
+    std::string name = std::filesystem::path(path).filename().string();
+
+    if (!IsValidWalHeader(data, size))
+    {
+        stats.warnings.push_back(name + " 헤더가 손상되었거나 형식 버전이 달라 건너뜁니다.");
+        return true;
+    }
+
+    std::size_t valid = ValidWalLength(data, size);
+    for (std::size_t offset = WAL_HEADER_SIZE; offset < valid; offset += WAL_ENTRY_SIZE)
+    {
+        handler(DecodeRecord(data + offset));
+        ++stats.walRecords;
+    }
+
+    if (valid != size)
+    {
+        stats.warnings.push_back(name + " 끝의 " + std::to_string(size - valid) + "바이트가 잘렸거나 손상되어 무시합니다.");
+    }
+
+    return true;
+}
+
+bool LoginHistoryStore::OpenWal(std::string& error)
+{
+    std::lock_guard<std::mutex> lock(_fileLock);
+    return OpenWalLocked(error);
+}
+
+bool LoginHistoryStore::OpenWalLocked(std::string& error)
+{
+    if (_wal)
+    {
+        std::fclose(_wal);
+        _wal = nullptr;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(_directory, ec);
+
+    std::string path = Path(WAL_FILE);
+
+    // 손상된 꼬리는 잘라 내고, 헤더가 맞지 않으면 새로 만듭니다. (이어 쓴 항목의 정렬이 어긋나지 않도록)
+    bool recreate = true;
+    {
+        MappedFile existing;
+        if (existing.Open(path) && IsValidWalHeader(existing.Data(), existing.Size()))
+        {
+            std::size_t valid = ValidWalLength(existing.Data(), existing.Size());
+            std::size_t size = existing.Size();
+            existing.Close();
+
+            recreate = false;
+            if (valid != size)
+            {
+                std::filesystem::resize_file(path, valid, ec);
+                recreate = static_cast<bool>(ec);
+            }
+        }
+    }
+
+    _wal = std::fopen(path.c_str(), recreate ? "wb" : "ab");
+    if (!_wal)
+    {
+        error = "WAL 파일을 열 수 없습니다: " + path;
+        return false;
+    }
+
+    if (recreate)
+    {
+        char header[WAL_HEADER_SIZE];
+        EncodeWalHeader(header);
+        if (std::fwrite(header, 1, sizeof(header), _wal) != sizeof(header) || std::fflush(_wal) != 0)
+        {
+            error = "WAL 헤더를 쓸 수 없습니다: " + path;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void LoginHistoryStore::Append(Record const& record)
+{
+    std::lock_guard<std::mutex> lock(_bufferLock);
+    _buffer.push_back(record);
+}
+
+bool LoginHistoryStore::Flush(std::string& error)
+{
+    std::vector<Record> pending;
+    {
+        std::lock_guard<std::mutex> lock(_bufferLock);
+        if (_buffer.empty())
+        {
+            return true;
+        }
+
+        pending.swap(_buffer);
+    }
+
+    std::lock_guard<std::mutex> lock(_fileLock);
+    if (!_wal)
+    {
+        error = "WAL 파일이 열려 있지 않습니다.";
+        return false;
+    }
+
+    _writeBuffer.resize(pending.size() * WAL_ENTRY_SIZE);
+    char* out = _writeBuffer.data();
+    for (Record const& record : pending)
+    {
+        EncodeRecord(out, record);
+        Put32(out + RECORD_SIZE, Crc32::Compute(out, RECORD_SIZE));
+        out += WAL_ENTRY_SIZE;
+    }
+
+    // 프로세스가 비정상 종료되어도 운영체제 버퍼에 남도록 매번 fflush 합니다.
+    if (std::fwrite(_writeBuffer.data(), 1, _writeBuffer.size(), _wal) != _writeBuffer.size() || std::fflush(_wal) != 0)
+    {
+        error = "WAL 파일에 쓸 수 없습니다.";
+        return false;
+    }
+
+    return true;
+}
+
+bool LoginHistoryStore::RotateWal(std::string& error)
+{
+    if (!Flush(error))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_fileLock);
+    if (_wal)
+    {
+        std::fclose(_wal);
+        _wal = nullptr;
+    }
+
+    std::string current = Path(WAL_FILE);
+    std::string old = Path(WAL_OLD_FILE);
+    std::error_code ec;
+
+    if (!std::filesystem::exists(old, ec))
+    {
+        std::filesystem::rename(current, old, ec);
+    }
+    else
+    {
+        // 이전 스냅샷이 실패해 남아 있는 이전 WAL 에 현재 WAL 의 항목을 이어 붙입니다.
+        MappedFile source;
+        if (source.Open(current) && IsValidWalHeader(source.Data(), source.Size()))
+        {
+            std::size_t valid = ValidWalLength(source.Data(), source.Size());
+            if (std::FILE* target = std::fopen(old.c_str(), "ab"))
+            {
+                std::fwrite(source.Data() + WAL_HEADER_SIZE, 1, valid - WAL_HEADER_SIZE, target);
+                std::fclose(target);
+            }
+        }
+
+        source.Close();
+        std::filesystem::remove(current, ec);
+    }
+
+    return OpenWalLocked(error);
+}
+
+bool LoginHistoryStore::WriteSnapshot(std::vector<Record> const& records, uint64_t createdTime, std::string& error)
+{
+    std::string temp = Path(SNAPSHOT_TEMP_FILE);
+    std::FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file)
+    {
+        error = "스냅샷 파일을 만들 수 없습니다: " + temp;
+        return false;
+    }
+
+    // 헤더는 체크섬 계산 후 마지막에 채웁니다.
+    char header[SNAPSHOT_HEADER_SIZE] = {};
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    uint32_t payloadCrc = 0;
+    std::vector<char> chunk;
+    constexpr std::size_t CHUNK_RECORDS = 4096;
+    for (std::size_t offset = 0; ok && offset < records.size(); offset += CHUNK_RECORDS)
+    {
+        std::size_t count = std::min(CHUNK_RECORDS, records.size() - offset);
+        chunk.resize(count * RECORD_SIZE);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            EncodeRecord(chunk.data() + i * RECORD_SIZE, records[offset + i]);
+        }
+
+        payloadCrc = Crc32::Compute(chunk.data(), chunk.size(), payloadCrc);
+        ok = std::fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size();
+    }
+
+    std::memcpy(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    Put32(header + 8, VERSION);
+    Put32(header + 12, RECORD_SIZE);
+    Put64(header + 16, records.size());
+    Put64(header + 24, createdTime);
+    Put32(header + 32, payloadCrc);
+    Put32(header + 40, Crc32::Compute(header, 40));
+
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(header, 1, sizeof(header), file) == sizeof(header) && SyncFile(file);
+    ok = std::fclose(file) == 0 && ok;
+
+    std::error_code ec;
+    if (!ok)
+    {
+        std::filesystem::remove(temp, ec);
+        error = "스냅샷 파일을 쓸 수 없습니다: " + temp;
+        return false;
+    }
+
+    // rename 은 원자적이므로 이전 스냅샷 또는 새 스냅샷 중 하나만 보입니다.
+    std::filesystem::rename(temp, Path(SNAPSHOT_FILE), ec);
+    if (ec)
+    {
+        error = "스냅샷 파일을 교체할 수 없습니다: " + ec.message();
+        return false;
+    }
+
+    std::filesystem::remove(Path(WAL_OLD_FILE), ec);
+    return true;
+}
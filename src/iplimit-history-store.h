@@ -0,0 +1,85 @@
+// Filename iplimit-history-store.h
+#ifndef IPLIMIT_HISTORY_STORE_H
+#define IPLIMIT_HISTORY_STORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 로그인 빈도 제한 기록의 로컬 저장소 (스냅샷 + WAL)
+// 통과한 로그인은 WAL(append-only) 에 추가하고, 주기적으로 전체 상태를 압축된 바이너리 스냅샷으로 씁니다.
+// 시작 시 스냅샷을 메모리 매핑하여 DB 없이 상태를 복구한 뒤 WAL 을 이어서 재생합니다.
+// 모든 파일에는 버전/체크섬 헤더가 있어 손상되었거나 형식이 다른 파일은 건너뜁니다.
+//
+// 파일 (directory 아래)
+//   login_history.snap      스냅샷 (임시 파일에 쓴 뒤 rename 으로 교체)
+//   login_history.wal.old   스냅샷 작성 중인 이전 WAL (스냅샷이 완료되면 삭제)
+//   login_history.wal       현재 WAL
+// 복구 순서는 스냅샷 -> 이전 WAL -> 현재 WAL 이며, 같은 (IP, 계정) 은 더 최근 시각이 남도록 병합해야 합니다.
+// 엔진/도구에서도 쓰이므로 AzerothCore 헤더에 의존하지 않습니다. 정수는 little-endian 으로 저장합니다.
+class LoginHistoryStore
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    struct Record
+    {
+        uint64_t ipHi;
+        uint64_t ipLo;
+        uint32_t accountId;
+        uint32_t loginTime;
+    };
+
+    struct LoadStats
+    {
+        bool snapshotLoaded = false;
+        uint64_t snapshotRecords = 0;
+        uint64_t walRecords = 0;
+        std::vector<std::string> warnings;   // 건너뛴 파일 / 잘린 WAL 등
+    };
+
+    typedef std::function<void(Record const&)> RecordHandler;
+
+    explicit LoginHistoryStore(std::string directory);
+    ~LoginHistoryStore();
+
+    LoginHistoryStore(LoginHistoryStore const&) = delete;
+    LoginHistoryStore& operator=(LoginHistoryStore const&) = delete;
+
+    // 저장된 기록을 복구 순서대로 handler 에 넘깁니다. 읽을 파일이 하나도 없으면 false
+    bool Load(RecordHandler const& handler, LoadStats& stats) const;
+
+    // WAL 을 추가 모드로 엽니다. 헤더가 맞지 않는 기존 WAL 은 새로 만듭니다. (Load 이후에 호출)
+    bool OpenWal(std::string& error);
+
+    // 메모리 버퍼에 추가합니다. 여러 스레드에서 호출할 수 있습니다.
+    void Append(Record const& record);
+    // 버퍼의 기록을 WAL 파일에 씁니다.
+    bool Flush(std::string& error);
+
+    // 현재 WAL 을 이전 WAL 로 돌리고 새 WAL 을 엽니다. 이후의 상태 복사본으로 WriteSnapshot 을 호출합니다.
+    bool RotateWal(std::string& error);
+    // 스냅샷을 쓰고, 성공하면 이전 WAL 을 삭제합니다. 다른 스레드에서 호출해도 됩니다. (RotateWal 과 동시 호출은 불가)
+    bool WriteSnapshot(std::vector<Record> const& records, uint64_t createdTime, std::string& error);
+
+    std::string const& GetDirectory() const { return _directory; }
+
+private:
+    std::string Path(char const* name) const;
+    bool ReplayWal(std::string const& path, RecordHandler const& handler, LoadStats& stats) const;
+    bool OpenWalLocked(std::string& error);
+
+    std::string _directory;
+
+    std::mutex _bufferLock;
+    std::vector<Record> _buffer;
+
+    std::mutex _fileLock;
+    std::FILE* _wal = nullptr;
+    std::vector<char> _writeBuffer;
+};
+
+#endif
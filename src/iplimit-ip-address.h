@@ -0,0 +1,464 @@
+// Filename iplimit-ip-address.h
+#ifndef IPLIMIT_IP_ADDRESS_H
+#define IPLIMIT_IP_ADDRESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 128비트 IP 주소 (IPv4는 IPv4-mapped IPv6 ::ffff:a.b.c.d 로 저장)
+// 문자열 대신 이 타입을 맵의 키로 사용하여 조회마다 힙 문자열을 해시하지 않도록 합니다.
+// 엔진/도구에서도 쓰이므로 AzerothCore 헤더에 의존하지 않습니다.
+struct IpAddress
+{
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    static constexpr uint64_t V4_MAPPED_PREFIX = 0x0000FFFF00000000ULL;
+
+    static IpAddress FromV4(uint32_t v4)
+    {
+        IpAddress address;
+        address.lo = V4_MAPPED_PREFIX | v4;
+        return address;
+    }
+
+    bool IsV4() const { return hi == 0 && (lo & 0xFFFFFFFF00000000ULL) == V4_MAPPED_PREFIX; }
+    uint32_t GetV4() const { return static_cast<uint32_t>(lo); }
+    bool IsZero() const { return hi == 0 && lo == 0; }
+
+    // 문자열 -> 주소 변환 (메모리 할당 없음)
+    // IPv4: 4개의 10진수 옥텟, 앞자리 0 불허 (예: 192.168.1.1)
+    // IPv6: RFC 4291 표기 (:: 축약, 마지막 32비트의 IPv4 표기 허용). 영역 ID(%eth0)는 허용하지 않습니다.
+    static bool Parse(std::string_view text, IpAddress& out)
+    {
+        if (text.find(':') == std::string_view::npos)
+        {
+            uint32_t v4;
+            if (!ParseV4(text, v4))
+            {
+                return false;
+            }
+
+            out = FromV4(v4);
+            return true;
+        }
+
+        return ParseV6(text, out);
+    }
+
+    static bool IsValid(std::string_view text)
+    {
+        IpAddress address;
+        return Parse(text, address);
+    }
+
+    // IPv4는 점 표기, IPv6는 RFC 5952 축약 표기
+    std::string ToString() const
+    {
+        char buffer[INET6_STRING_LENGTH];
+        return std::string(buffer, Format(buffer));
+    }
+
+    // buffer 에 문자열을 쓰고 길이를 반환합니다. (INET6_STRING_LENGTH 이상 필요)
+    static constexpr std::size_t INET6_STRING_LENGTH = 46;
+    std::size_t Format(char* buffer) const
+    {
+        char* out = buffer;
+        if (IsV4())
+        {
+            out = WriteV4(out, GetV4());
+            return static_cast<std::size_t>(out - buffer);
+        }
+
+        uint16_t groups[8];
+        for (int i = 0; i < 4; ++i)
+        {
+            groups[i] = static_cast<uint16_t>(hi >> (48 - 16 * i));
+            groups[4 + i] = static_cast<uint16_t>(lo >> (48 - 16 * i));
+        }
+
+        // 가장 긴 0 그룹 구간 (2개 이상)을 :: 로 축약
+        int bestStart = -1, bestLength = 0;
+        for (int i = 0; i < 8;)
+        {
+            if (groups[i] != 0)
+            {
+                ++i;
+                continue;
+            }
+
+            int start = i;
+            while (i < 8 && groups[i] == 0)
+            {
+                ++i;
+            }
+
+            if (i - start > bestLength)
+            {
+                bestStart = start;
+                bestLength = i - start;
+            }
+        }
+
+        if (bestLength < 2)
+        {
+            bestStart = -1;
+        }
+
+        static char const hex[] = "0123456789abcdef";
+        for (int i = 0; i < 8; ++i)
+        {
+            if (i == bestStart)
+            {
+                *out++ = ':';
+                if (i == 0)
+                {
+                    *out++ = ':';
+                }
+
+                i += bestLength - 1;
+                continue;
+            }
+
+            bool leading = true;
+            for (int shift = 12; shift >= 0; shift -= 4)
+            {
+                uint32_t nibble = (groups[i] >> shift) & 0xF;
+                if (leading && nibble == 0 && shift != 0)
+                {
+                    continue;
+                }
+
+                leading = false;
+                *out++ = hex[nibble];
+            }
+
+            if (i != 7)
+            {
+                *out++ = ':';
+            }
+        }
+
+        return static_cast<std::size_t>(out - buffer);
+    }
+
+    bool operator==(IpAddress const& right) const { return hi == right.hi && lo == right.lo; }
+    bool operator!=(IpAddress const& right) const { return !(*this == right); }
+    bool operator<(IpAddress const& right) const { return hi != right.hi ? hi < right.hi : lo < right.lo; }
+
+private:
+    static bool ParseV4(std::string_view text, uint32_t& out)
+    {
+        uint32_t value = 0;
+        std::size_t pos = 0;
+        for (int octet = 0; octet < 4; ++octet)
+        {
+            if (octet != 0)
+            {
+                if (pos >= text.size() || text[pos] != '.')
+                {
+                    return false;
+                }
+
+                ++pos;
+            }
+
+            std::size_t start = pos;
+            uint32_t part = 0;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9' && pos - start < 3)
+            {
+                part = part * 10 + static_cast<uint32_t>(text[pos] - '0');
+                ++pos;
+            }
+
+            std::size_t digits = pos - start;
+            if (digits == 0 || part > 255 || (digits > 1 && text[start] == '0'))
+            {
+                return false;
+            }
+
+            value = (value << 8) | part;
+        }
+
+        if (pos != text.size())
+        {
+            return false;
+        }
+
+        out = value;
+        return true;
+    }
+
+    static int HexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    static bool ParseV6(std::string_view text, IpAddress& out)
+    {
+        uint16_t groups[8] = {};
+        int count = 0;
+        int compressAt = -1;
+        std::size_t pos = 0;
+
+        if (text.size() >= 2 && text[0] == ':' && text[1] == ':')
+        {
+            compressAt = 0;
+            pos = 2;
+        }
+        else if (!text.empty() && text[0] == ':')
+        {
+            return false;
+        }
+
+        while (pos < text.size())
+        {
+            if (count == 8)
+            {
+                return false;
+            }
+
+            // 마지막 32비트의 IPv4 표기 (예: ::ffff:1.2.3.4)
+            std::size_t groupEnd = text.find(':', pos);
+            std::string_view group = text.substr(pos, groupEnd == std::string_view::npos ? std::string_view::npos : groupEnd - pos);
+            if (groupEnd == std::string_view::npos && group.find('.') != std::string_view::npos)
+            {
+                uint32_t v4;
+                if (count > 6 || !ParseV4(group, v4))
+                {
+                    return false;
+                }
+
+                groups[count++] = static_cast<uint16_t>(v4 >> 16);
+                groups[count++] = static_cast<uint16_t>(v4);
+                pos = text.size();
+                break;
+            }
+
+            if (group.empty() || group.size() > 4)
+            {
+                return false;
+            }
+
+            uint32_t value = 0;
+            for (char c : group)
+            {
+                int nibble = HexValue(c);
+                if (nibble < 0)
+                {
+                    return false;
+                }
+
+                value = (value << 4) | static_cast<uint32_t>(nibble);
+            }
+
+            groups[count++] = static_cast<uint16_t>(value);
+            pos += group.size();
+
+            if (pos == text.size())
+            {
+                break;
+            }
+
+            // ':' 다음이 다시 ':' 이면 축약 구간
+            ++pos;
+            if (pos < text.size() && text[pos] == ':')
+            {
+                if (compressAt != -1)
+                {
+                    return false;
+                }
+
+                compressAt = count;
+                ++pos;
+            }
+            else if (pos == text.size())
+            {
+                return false;
+            }
+        }
+
+        if (compressAt == -1)
+        {
+            if (count != 8)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (count > 7)
+            {
+                return false;
+            }
+
+            // 축약 지점 이후의 그룹을 뒤쪽으로 이동
+            int tail = count - compressAt;
+            for (int i = 0; i < tail; ++i)
+            {
+                groups[7 - i] = groups[count - 1 - i];
+            }
+
+            for (int i = compressAt; i < 8 - tail; ++i)
+            {
+                groups[i] = 0;
+            }
+        }
+
+        out.hi = 0;
+        out.lo = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            out.hi = (out.hi << 16) | groups[i];
+            out.lo = (out.lo << 16) | groups[4 + i];
+        }
+
+        return true;
+    }
+
+    static char* WriteV4(char* out, uint32_t v4)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            uint32_t octet = (v4 >> shift) & 0xFF;
+            if (octet >= 100)
+            {
+                *out++ = static_cast<char>('0' + octet / 100);
+            }
+
+            if (octet >= 10)
+            {
+                *out++ = static_cast<char>('0' + (octet / 10) % 10);
+            }
+
+            *out++ = static_cast<char>('0' + octet % 10);
+            if (shift != 0)
+            {
+                *out++ = '.';
+            }
+        }
+
+        return out;
+    }
+};
+
+// CIDR 접두사 (예: 10.0.0.0/8, 2001:db8::/32)
+// length 는 128비트 기준이며, IPv4 접두사 /n 은 96 + n 으로 저장합니다.
+struct IpPrefix
+{
+    IpAddress address;
+    uint8_t length = 128;
+
+    static constexpr uint8_t V4_PREFIX_OFFSET = 96;
+
+    // 호스트 비트를 0으로 지운 접두사 주소
+    static IpAddress Mask(IpAddress const& address, uint8_t length)
+    {
+        IpAddress masked;
+        if (length == 0)
+        {
+            return masked;
+        }
+
+        if (length <= 64)
+        {
+            masked.hi = address.hi & (~0ULL << (64 - length));
+            return masked;
+        }
+
+        masked.hi = address.hi;
+        masked.lo = length == 128 ? address.lo : address.lo & (~0ULL << (128 - length));
+        return masked;
+    }
+
+    // "주소" 또는 "주소/길이" 형식. 길이가 없으면 단일 주소(/32, /128)로 취급합니다.
+    static bool Parse(std::string_view text, IpPrefix& out)
+    {
+        std::size_t slash = text.find('/');
+        if (!IpAddress::Parse(text.substr(0, slash), out.address))
+        {
+            return false;
+        }
+
+        bool v4 = text.substr(0, slash).find(':') == std::string_view::npos;
+        uint32_t maxLength = v4 ? 32 : 128;
+        uint32_t length = maxLength;
+
+        if (slash != std::string_view::npos)
+        {
+            std::string_view digits = text.substr(slash + 1);
+            if (digits.empty() || digits.size() > 3 || (digits.size() > 1 && digits[0] == '0'))
+            {
+                return false;
+            }
+
+            length = 0;
+            for (char c : digits)
+            {
+                if (c < '0' || c > '9')
+                {
+                    return false;
+                }
+
+                length = length * 10 + static_cast<uint32_t>(c - '0');
+            }
+
+            if (length > maxLength)
+            {
+                return false;
+            }
+        }
+
+        out.length = static_cast<uint8_t>(v4 ? V4_PREFIX_OFFSET + length : length);
+        out.address = Mask(out.address, out.length);
+        return true;
+    }
+
+    bool IsHost() const { return length == 128; }
+
+    bool Contains(IpAddress const& address) const { return Mask(address, length) == this->address; }
+
+    // 단일 주소는 길이 없이, 그 외에는 "주소/길이" (IPv4는 32비트 기준 길이)
+    std::string ToString() const
+    {
+        std::string text = address.ToString();
+        if (IsHost())
+        {
+            return text;
+        }
+
+        bool v4 = address.IsV4() && length >= V4_PREFIX_OFFSET;
+        return text + "/" + std::to_string(v4 ? length - V4_PREFIX_OFFSET : length);
+    }
+
+    bool operator==(IpPrefix const& right) const { return length == right.length && address == right.address; }
+};
+
+struct IpAddressHash
+{
+    // 64비트 믹서 (splitmix64 finalizer) - 오픈 어드레싱 테이블에서 하위 비트를 고르게 분산시킵니다.
+    static uint64_t Mix(uint64_t value)
+    {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ULL;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBULL;
+        value ^= value >> 31;
+        return value;
+    }
+
+    std::size_t operator()(IpAddress const& address) const
+    {
+        return static_cast<std::size_t>(Mix(address.hi ^ Mix(address.lo)));
+    }
+};
+
+#endif
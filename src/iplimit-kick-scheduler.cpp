@@ -0,0 +1,71 @@
+// Filename iplimit-kick-scheduler.cpp
+#include "iplimit-kick-scheduler.h"
+
+KickScheduler* KickScheduler::instance()
+{
+    static KickScheduler instance;
+    return &instance;
+}
+
+void KickScheduler::Schedule(uint64_t guid, KickInfo const& info)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    // 이전 예약의 이벤트는 세대(generation)가 달라져 꺼낼 때 무시됩니다.
+    uint32_t generation = ++_nextGeneration;
+    _entries[guid] = { info, generation };
+
+    uint32_t warningTime = info.kickTime > WARNING_LEAD_SECONDS ? info.kickTime - WARNING_LEAD_SECONDS : 0;
+    uint32_t kickTime = info.kickTime > KICK_LEAD_SECONDS ? info.kickTime - KICK_LEAD_SECONDS : 0;
+
+    _events.push({ warningTime, guid, generation, KickStage::WARNING });
+    _events.push({ kickTime, guid, generation, KickStage::KICK });
+}
+
+void KickScheduler::Cancel(uint64_t guid)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries.erase(guid);
+
+    if (_entries.empty())
+    {
+        // 남은 이벤트는 모두 취소된 예약이므로 한 번에 정리
+        _events = decltype(_events)();
+    }
+}
+
+bool KickScheduler::IsScheduled(uint64_t guid) const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.find(guid) != _entries.end();
+}
+
+std::size_t KickScheduler::GetScheduledCount() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.size();
+}
+
+void KickScheduler::CollectDue(uint32_t now, std::vector<DueKick>& due)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    while (!_events.empty() && _events.top().dueTime <= now)
+    {
+        Event event = _events.top();
+        _events.pop();
+
+        auto it = _entries.find(event.guid);
+        if (it == _entries.end() || it->second.generation != event.generation)
+        {
+            continue;
+        }
+
+        due.push_back({ event.guid, it->second.info, event.stage });
+
+        if (event.stage == KickStage::KICK)
+        {
+            _entries.erase(it);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+// Filename iplimit-kick-scheduler.h
+#ifndef IPLIMIT_KICK_SCHEDULER_H
+#define IPLIMIT_KICK_SCHEDULER_H
+
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+// 강제 퇴장 사유
+enum class KickReason
+{
+    CONCURRENT_LIMIT,
+    RATE_LIMIT,
+    BURST_LIMIT,        // 로그인 시도 폭주 (토큰 부족)
+    TEMP_BAN            // 반복된 폭주로 인한 임시 차단
+};
+
+struct KickInfo
+{
+    uint32_t accountId;
+    uint32_t kickTime;
+    KickReason reason;
+};
+
+// 예약된 강제 퇴장 단계
+enum class KickStage
+{
+    WARNING,    // 퇴장 5초 전 경고
+    KICK        // 퇴장 2초 전 최종 메시지 및 연결 종료
+};
+
+// 강제 퇴장 예약 스케줄러 (최소 힙)
+// 플레이어별 OnPlayerUpdate 대신 월드 업데이트에서 틱당 한 번만 만료된 항목을 꺼내 처리합니다.
+// 키는 ObjectGuid::GetRawValue() 값을 사용합니다.
+class KickScheduler
+{
+public:
+    static constexpr uint32_t WARNING_LEAD_SECONDS = 5;
+    static constexpr uint32_t KICK_LEAD_SECONDS = 2;
+
+    struct DueKick
+    {
+        uint64_t guid;
+        KickInfo info;
+        KickStage stage;
+    };
+
+    static KickScheduler* instance();
+
+    // 퇴장을 예약합니다. 같은 플레이어의 기존 예약은 대체됩니다.
+    void Schedule(uint64_t guid, KickInfo const& info);
+    // 예약을 취소합니다. (로그아웃 등)
+    void Cancel(uint64_t guid);
+    bool IsScheduled(uint64_t guid) const;
+    std::size_t GetScheduledCount() const;
+
+    // now(초) 기준으로 처리 시각이 지난 단계를 due 에 담습니다.
+    void CollectDue(uint32_t now, std::vector<DueKick>& due);
+
+private:
+    struct Event
+    {
+        uint32_t dueTime;
+        uint64_t guid;
+        uint32_t generation;
+        KickStage stage;
+
+        bool operator>(Event const& right) const { return dueTime > right.dueTime; }
+    };
+
+    struct Entry
+    {
+        KickInfo info;
+        uint32_t generation;
+    };
+
+    mutable std::mutex _lock;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> _events;
+    std::unordered_map<uint64_t, Entry> _entries;
+    uint32_t _nextGeneration = 0;
+};
+
+#define sKickScheduler KickScheduler::instance()
+
+#endif
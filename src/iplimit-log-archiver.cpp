@@ -0,0 +1,293 @@
+// Filename iplimit-log-archiver.cpp
+#include "iplimit-log-archiver.h"
+#include "iplimit-metrics.h"
+#include "Log.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // 로그 텍스트는 기본 수준에서도 충분히 줄어듭니다. (압축률보다 CPU 사용을 우선)
+    char const* const GZIP_MODE = "wb6";
+    std::size_t const CHUNK_SIZE = 256 * 1024;
+}
+
+LogArchiver::~LogArchiver()
+{
+    Stop();
+}
+
+void LogArchiver::Start(std::string const& directory, std::string const& prefix)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_running)
+    {
+        return;
+    }
+
+    _directory = directory;
+    _prefix = prefix;
+    _running = true;
+    _thread = std::thread(&LogArchiver::Run, this);
+}
+
+void LogArchiver::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_running)
+        {
+            return;
+        }
+
+        _running = false;
+        _jobs.clear();
+    }
+
+    _wake.notify_one();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+void LogArchiver::SetPolicy(bool compress, uint64 maxTotalBytes)
+{
+    _compress.store(compress, std::memory_order_relaxed);
+    _maxTotalBytes.store(maxTotalBytes, std::memory_order_relaxed);
+}
+
+void LogArchiver::SetActiveFiles(std::vector<std::string> paths)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _activeFiles = std::move(paths);
+}
+
+bool LogArchiver::IsActive(std::string const& path)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return std::find(_activeFiles.begin(), _activeFiles.end(), path) != _activeFiles.end();
+}
+
+void LogArchiver::Submit(std::string const& closedPath)
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_running)
+        {
+            return;
+        }
+
+        _jobs.push_back(closedPath);
+    }
+
+    _wake.notify_one();
+}
+
+void LogArchiver::SubmitLeftovers(std::string const& extension)
+{
+    std::error_code ec;
+    std::vector<std::string> leftovers;
+    for (fs::directory_iterator it(_directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        std::string name = it->path().filename().string();
+        if (!it->is_regular_file(ec) || !name.starts_with(_prefix))
+        {
+            continue;
+        }
+
+        // 압축 도중 종료되어 남은 임시 파일 (원본은 그대로 있음)
+        if (name.ends_with(".gz.tmp"))
+        {
+            std::error_code removeError;
+            fs::remove(it->path(), removeError);
+        }
+        else if (name.ends_with(extension) && !IsActive(it->path().string()))
+        {
+            leftovers.push_back(it->path().string());
+        }
+    }
+
+    std::sort(leftovers.begin(), leftovers.end());
+    for (std::string const& path : leftovers)
+    {
+        Submit(path);
+    }
+}
+
+void LogArchiver::Run()
+{
+    while (true)
+    {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _wake.wait(lock, [this] { return !_running || !_jobs.empty(); });
+            if (!_running)
+            {
+                return;
+            }
+
+            path = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        if (!path.empty() && _compress.load(std::memory_order_relaxed))
+        {
+            std::string error;
+            IpLimitScopedTimer timer(IpLimitTimer::ACCESS_LOG_COMPRESS);
+            if (!Compress(path, error) && !error.empty())
+            {
+                LOG_ERROR("module.iplimit", "IPLimit: 접속 로그 압축 실패 ({}) - {}", path, error);
+            }
+        }
+
+        ApplyRetention(_maxTotalBytes.load(std::memory_order_relaxed));
+    }
+}
+
+bool LogArchiver::Compress(std::string const& path, std::string& error)
+{
+    std::FILE* input = std::fopen(path.c_str(), "rb");
+    if (!input)
+    {
+        // 보존 용량 정리로 이미 지워진 경우
+        return false;
+    }
+
+    std::string target = path + ".gz";
+    std::string temporary = target + ".tmp";
+    gzFile output = gzopen(temporary.c_str(), GZIP_MODE);
+    if (!output)
+    {
+        std::fclose(input);
+        error = "cannot create " + temporary;
+        return false;
+    }
+
+    gzbuffer(output, 128 * 1024);
+
+    std::vector<char> buffer(CHUNK_SIZE);
+    bool ok = true;
+    while (true)
+    {
+        std::size_t read = std::fread(buffer.data(), 1, buffer.size(), input);
+        if (read && gzwrite(output, buffer.data(), static_cast<unsigned>(read)) != static_cast<int>(read))
+        {
+            int code = 0;
+            error = gzerror(output, &code);
+            ok = false;
+            break;
+        }
+
+        if (read < buffer.size())
+        {
+            if (std::ferror(input))
+            {
+                error = "read error";
+                ok = false;
+            }
+
+            break;
+        }
+
+        // 서버 종료 중이면 원본을 남겨 두고 중단합니다.
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_running)
+        {
+            ok = false;
+            break;
+        }
+    }
+
+    std::fclose(input);
+    if (gzclose(output) != Z_OK && ok)
+    {
+        error = "gzclose failed";
+        ok = false;
+    }
+
+    std::error_code ec;
+    if (!ok)
+    {
+        fs::remove(temporary, ec);
+        return false;
+    }
+
+    fs::rename(temporary, target, ec);
+    if (ec)
+    {
+        error = ec.message();
+        fs::remove(temporary, ec);
+        return false;
+    }
+
+    fs::remove(path, ec);
+    return true;
+}
+
+void LogArchiver::ApplyRetention(uint64 maxTotalBytes)
+{
+    if (!maxTotalBytes)
+    {
+        return;
+    }
+
+    struct Entry
+    {
+        fs::path path;
+        fs::file_time_type modified;
+        uint64 size;
+    };
+
+    std::error_code ec;
+    std::vector<Entry> entries;
+    uint64 total = 0;
+    for (fs::directory_iterator it(_directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        std::string name = it->path().filename().string();
+        if (!it->is_regular_file(ec) || !name.starts_with(_prefix) || name.ends_with(".tmp"))
+        {
+            continue;
+        }
+
+        uint64 size = it->file_size(ec);
+        total += size;
+
+        // 현재 쓰는 파일은 합계에만 포함합니다.
+        if (!IsActive(it->path().string()))
+        {
+            entries.push_back({ it->path(), it->last_write_time(ec), size });
+        }
+    }
+
+    if (total <= maxTotalBytes)
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](Entry const& left, Entry const& right)
+    {
+        return left.modified != right.modified ? left.modified < right.modified : left.path < right.path;
+    });
+
+    for (Entry const& entry : entries)
+    {
+        if (total <= maxTotalBytes)
+        {
+            break;
+        }
+
+        if (fs::remove(entry.path, ec))
+        {
+            total -= entry.size;
+            LOG_INFO("module.iplimit", "IPLimit: 보존 용량을 넘어 오래된 접속 로그를 삭제했습니다: {}", entry.path.filename().string());
+        }
+    }
+}
@@ -0,0 +1,59 @@
+// Filename iplimit-log-archiver.h
+#ifndef IPLIMIT_LOG_ARCHIVER_H
+#define IPLIMIT_LOG_ARCHIVER_H
+
+#include "Define.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 닫힌 로그 파일의 압축과 보존 용량 관리
+// 로그 스레드가 교체한 파일을 넘기면 전용 스레드에서 zlib(gzip) 으로 압축한 뒤 원본을 지우고,
+// 디렉토리 안의 로그 파일 합계가 최대 용량을 넘으면 오래된 파일부터 삭제합니다.
+// 압축은 <파일>.gz.tmp 에 쓴 뒤 이름을 바꾸므로, 중간에 종료되어도 원본은 그대로 남습니다.
+class LogArchiver
+{
+public:
+    ~LogArchiver();
+
+    // directory 안에서 prefix 로 시작하는 파일을 관리합니다.
+    void Start(std::string const& directory, std::string const& prefix);
+    // 진행 중인 압축은 중단합니다. (남은 원본은 다음 시작 시 SubmitLeftovers 로 처리)
+    void Stop();
+
+    // 설정 재적용 (.reload config). maxTotalBytes 가 0 이면 삭제하지 않습니다.
+    void SetPolicy(bool compress, uint64 maxTotalBytes);
+
+    // 현재 쓰는 파일들. 보존 용량 계산에는 포함하되 지우거나 압축하지 않습니다.
+    void SetActiveFiles(std::vector<std::string> paths);
+
+    // 닫힌 파일을 압축 대기열에 넣습니다. (비어 있으면 보존 용량만 정리)
+    void Submit(std::string const& closedPath);
+    // 이전 실행에서 압축하지 못한 파일(확장자 extension)을 모두 대기열에 넣습니다.
+    void SubmitLeftovers(std::string const& extension);
+
+private:
+    void Run();
+    bool Compress(std::string const& path, std::string& error);
+    void ApplyRetention(uint64 maxTotalBytes);
+    bool IsActive(std::string const& path);
+
+    std::string _directory;
+    std::string _prefix;
+
+    std::atomic<bool> _compress{ true };
+    std::atomic<uint64> _maxTotalBytes{ 0 };
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::deque<std::string> _jobs;
+    std::vector<std::string> _activeFiles;
+    bool _running = false;
+    std::thread _thread;
+};
+
+#endif
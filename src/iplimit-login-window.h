@@ -0,0 +1,176 @@
+// Filename iplimit-login-window.h
+#ifndef IPLIMIT_LOGIN_WINDOW_H
+#define IPLIMIT_LOGIN_WINDOW_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// IP 하나의 고유 계정 로그인 시간 창 (sliding window)
+// 계정마다 가장 최근 로그인 1건만 보관하므로 보관 건수가 곧 고유 계정 수입니다.
+// 제한을 넘은 로그인은 기록하지 않으므로 보관 건수는 해당 IP의 MaxUniqueAccounts 를 넘지 않습니다.
+// 기본 정책(최대 1~4 계정)에서는 객체 내부 버퍼만 사용하여 로그인 경로에서 메모리를 할당하지 않으며,
+// 화이트리스트로 한도가 큰 IP만 처음 한도를 넘길 때 한 번 힙 버퍼로 옮겨 갑니다.
+class LoginWindow
+{
+public:
+    struct Record
+    {
+        uint32_t accountId;
+        uint32_t loginTime;
+    };
+
+    static constexpr uint16_t INLINE_CAPACITY = 4;
+
+    LoginWindow() = default;
+    LoginWindow(LoginWindow&& other) noexcept { MoveFrom(other); }
+    LoginWindow& operator=(LoginWindow&& other) noexcept
+    {
+        if (this != &other)
+        {
+            MoveFrom(other);
+        }
+
+        return *this;
+    }
+
+    LoginWindow(LoginWindow const&) = delete;
+    LoginWindow& operator=(LoginWindow const&) = delete;
+
+    uint16_t Size() const { return _size; }
+    bool Empty() const { return _size == 0; }
+    Record const* begin() const { return Data(); }
+    Record const* end() const { return Data() + _size; }
+
+    // 가장 최근 로그인 시각 (비어 있으면 0)
+    uint32_t NewestTime() const { return _size ? Data()[_size - 1].loginTime : 0; }
+
+    // 마지막 백업 이후 Add 로 바뀐 기록이 있는지 (만료로 인한 제거는 백업에서 시각 기준으로 일괄 삭제)
+    bool IsDirty() const { return _dirty; }
+    void MarkClean() { _dirty = false; }
+
+    // now - window 보다 오래된 기록을 앞에서부터 제거합니다. 제거한 건수를 반환합니다.
+    uint16_t Expire(uint32_t now, uint32_t window)
+    {
+        Record* data = Data();
+        uint16_t expired = 0;
+        while (expired < _size && now > data[expired].loginTime && now - data[expired].loginTime > window)
+        {
+            ++expired;
+        }
+
+        if (expired)
+        {
+            std::memmove(data, data + expired, (_size - expired) * sizeof(Record));
+            _size -= expired;
+        }
+
+        return expired;
+    }
+
+    bool Contains(uint32_t accountId) const
+    {
+        Record const* data = Data();
+        for (uint16_t i = 0; i < _size; ++i)
+        {
+            if (data[i].accountId == accountId)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // 계정의 로그인 기록을 갱신합니다. 같은 계정의 이전 기록은 제거되고, 시간순 위치에 삽입됩니다.
+    void Add(uint32_t accountId, uint32_t loginTime)
+    {
+        Remove(accountId);
+
+        if (_size == Capacity())
+        {
+            Grow();
+        }
+
+        Record* data = Data();
+        uint16_t position = _size;
+        while (position > 0 && data[position - 1].loginTime > loginTime)
+        {
+            --position;
+        }
+
+        std::memmove(data + position + 1, data + position, (_size - position) * sizeof(Record));
+        data[position] = { accountId, loginTime };
+        ++_size;
+        _dirty = true;
+    }
+
+    // 같은 계정의 기록이 없거나 더 오래된 경우에만 추가합니다. (순서가 보장되지 않는 복구용)
+    bool Merge(uint32_t accountId, uint32_t loginTime)
+    {
+        Record const* data = Data();
+        for (uint16_t i = 0; i < _size; ++i)
+        {
+            if (data[i].accountId == accountId && data[i].loginTime >= loginTime)
+            {
+                return false;
+            }
+        }
+
+        Add(accountId, loginTime);
+        return true;
+    }
+
+    bool Remove(uint32_t accountId)
+    {
+        Record* data = Data();
+        for (uint16_t i = 0; i < _size; ++i)
+        {
+            if (data[i].accountId == accountId)
+            {
+                std::memmove(data + i, data + i + 1, (_size - i - 1) * sizeof(Record));
+                --_size;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // 보관 중인 기록 외에 차지하는 힙 메모리 (바이트)
+    std::size_t HeapUsage() const { return _heap ? _capacity * sizeof(Record) : 0; }
+
+private:
+    uint16_t Capacity() const { return _heap ? _capacity : INLINE_CAPACITY; }
+    Record* Data() { return _heap ? _heap.get() : _inline; }
+    Record const* Data() const { return _heap ? _heap.get() : _inline; }
+
+    void Grow()
+    {
+        uint16_t capacity = static_cast<uint16_t>(Capacity() * 2);
+        std::unique_ptr<Record[]> heap(new Record[capacity]);
+        std::memcpy(heap.get(), Data(), _size * sizeof(Record));
+        _heap = std::move(heap);
+        _capacity = capacity;
+    }
+
+    void MoveFrom(LoginWindow& other)
+    {
+        _heap = std::move(other._heap);
+        _capacity = other._capacity;
+        _size = other._size;
+        _dirty = other._dirty;
+        std::memcpy(_inline, other._inline, sizeof(_inline));
+        other._capacity = 0;
+        other._size = 0;
+        other._dirty = false;
+    }
+
+    Record _inline[INLINE_CAPACITY] = {};
+    std::unique_ptr<Record[]> _heap;
+    uint16_t _capacity = 0;
+    uint16_t _size = 0;
+    bool _dirty = false;
+};
+
+#endif
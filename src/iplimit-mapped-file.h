@@ -0,0 +1,153 @@
+// Filename iplimit-mapped-file.h
+#ifndef IPLIMIT_MAPPED_FILE_H
+#define IPLIMIT_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 읽기 전용 메모리 매핑 파일
+// 파일 전체를 복사하지 않고 페이지 캐시를 그대로 읽으므로 큰 스냅샷/로그 파일도 바로 접근할 수 있습니다.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    // 빈 파일은 매핑하지 않고 성공(Size() == 0)으로 처리합니다.
+    bool Open(std::string const& path)
+    {
+        Close();
+
+#ifdef _WIN32
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size))
+        {
+            Close();
+            return false;
+        }
+
+        _size = static_cast<std::size_t>(size.QuadPart);
+        if (_size == 0)
+        {
+            return true;
+        }
+
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!_mapping)
+        {
+            Close();
+            return false;
+        }
+
+        _data = static_cast<char const*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        _fd = ::open(path.c_str(), O_RDONLY);
+        if (_fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (::fstat(_fd, &info) != 0)
+        {
+            Close();
+            return false;
+        }
+
+        _size = static_cast<std::size_t>(info.st_size);
+        if (_size == 0)
+        {
+            return true;
+        }
+
+        void* data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        _data = data == MAP_FAILED ? nullptr : static_cast<char const*>(data);
+        if (_data)
+        {
+            // 처음부터 끝까지 한 번 읽는 용도
+            ::madvise(data, _size, MADV_SEQUENTIAL);
+        }
+#endif
+
+        if (!_data)
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (_data)
+        {
+            UnmapViewOfFile(_data);
+        }
+
+        if (_mapping)
+        {
+            CloseHandle(_mapping);
+        }
+
+        if (_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(_file);
+        }
+
+        _mapping = nullptr;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        if (_data)
+        {
+            ::munmap(const_cast<char*>(_data), _size);
+        }
+
+        if (_fd >= 0)
+        {
+            ::close(_fd);
+        }
+
+        _fd = -1;
+#endif
+        _data = nullptr;
+        _size = 0;
+    }
+
+    char const* Data() const { return _data; }
+    std::size_t Size() const { return _size; }
+
+private:
+    char const* _data = nullptr;
+    std::size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#else
+    int _fd = -1;
+#endif
+};
+
+#endif
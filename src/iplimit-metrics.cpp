@@ -0,0 +1,203 @@
+// Filename iplimit-metrics.cpp
+#include "iplimit-metrics.h"
+#include <bit>
+#include <cstdio>
+
+namespace
+{
+    int64_t SteadySeconds()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+uint32_t LogLinearHistogram::BucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return static_cast<uint32_t>(value);
+    }
+
+    uint32_t exponent = static_cast<uint32_t>(std::bit_width(value)) - 1;
+    if (exponent > MAX_EXPONENT)
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    // 최상위 비트 아래 SUB_BUCKET_BITS 비트가 구간 안의 위치입니다.
+    uint32_t shift = exponent - SUB_BUCKET_BITS;
+    uint32_t sub = static_cast<uint32_t>(value >> shift) - SUB_BUCKETS;
+    return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+}
+
+uint64_t LogLinearHistogram::BucketUpperBound(uint32_t index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    uint32_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LogLinearHistogram::Record(uint64_t value)
+{
+    _buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+LogLinearHistogram::Summary LogLinearHistogram::Summarize() const
+{
+    std::array<uint64_t, BUCKET_COUNT> buckets;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+    }
+
+    Summary summary;
+    summary.count = total;
+    summary.sum = _sum.load(std::memory_order_relaxed);
+    summary.max = _max.load(std::memory_order_relaxed);
+    if (!total)
+    {
+        return summary;
+    }
+
+    // 백분위 값은 해당 구간의 상한으로 보고하되, 관측된 최댓값을 넘지 않도록 합니다.
+    uint64_t* const targets[] = { &summary.p50, &summary.p90, &summary.p99 };
+    uint64_t const ranks[] = { (total * 50 + 99) / 100, (total * 90 + 99) / 100, (total * 99 + 99) / 100 };
+
+    std::size_t next = 0;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT && next < 3; ++i)
+    {
+        seen += buckets[i];
+        while (next < 3 && seen >= ranks[next])
+        {
+            uint64_t bound = BucketUpperBound(i);
+            *targets[next++] = summary.max && bound > summary.max ? summary.max : bound;
+        }
+    }
+
+    return summary;
+}
+
+void LogLinearHistogram::Reset()
+{
+    for (std::atomic<uint64_t>& bucket : _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+IpLimitMetrics::IpLimitMetrics() : _resetTime(SteadySeconds())
+{
+}
+
+IpLimitMetrics* IpLimitMetrics::instance()
+{
+    static IpLimitMetrics instance;
+    return &instance;
+}
+
+uint64_t IpLimitMetrics::Reset()
+{
+    for (LogLinearHistogram& timer : _timers)
+    {
+        timer.Reset();
+    }
+
+    for (std::atomic<uint64_t>& counter : _counters)
+    {
+        counter.store(0, std::memory_order_relaxed);
+    }
+
+    int64_t now = SteadySeconds();
+    int64_t previous = _resetTime.exchange(now, std::memory_order_relaxed);
+    return static_cast<uint64_t>(now - previous);
+}
+
+uint64_t IpLimitMetrics::GetSecondsSinceReset() const
+{
+    return static_cast<uint64_t>(SteadySeconds() - _resetTime.load(std::memory_order_relaxed));
+}
+
+char const* IpLimitMetrics::GetName(IpLimitTimer timer)
+{
+    switch (timer)
+    {
+        case IpLimitTimer::ACCOUNT_LOGIN:        return "account_login";
+        case IpLimitTimer::ACCOUNT_LOGIN_RESULT: return "account_login_result";
+        case IpLimitTimer::SESSION_ADMISSION:    return "session_admission";
+        case IpLimitTimer::PLAYER_LOGIN:         return "player_login";
+        case IpLimitTimer::PLAYER_LOGOUT:        return "player_logout";
+        case IpLimitTimer::DB_LOGIN_QUERY:       return "db_login_query";
+        case IpLimitTimer::DB_COMMAND_QUERY:     return "db_command_query";
+        case IpLimitTimer::DB_KICK_UPDATE:       return "db_kick_update";
+        case IpLimitTimer::DB_LOAD:              return "db_load";
+        case IpLimitTimer::FORMATION_FLUSH:      return "formation_flush";
+        case IpLimitTimer::FORMATION_PARTITION:  return "formation_partition";
+        case IpLimitTimer::TEMP_BAN_FLUSH:       return "temp_ban_flush";
+        case IpLimitTimer::ACCESS_LOG_WRITE:     return "access_log_write";
+        case IpLimitTimer::ACCESS_LOG_COMPRESS:  return "access_log_compress";
+        case IpLimitTimer::BACKUP:               return "backup";
+        case IpLimitTimer::LOCAL_SNAPSHOT:       return "local_snapshot";
+        case IpLimitTimer::SWEEP:                return "sweep";
+        case IpLimitTimer::RECONCILE:            return "reconcile";
+        default:                                 return "unknown";
+    }
+}
+
+char const* IpLimitMetrics::GetName(IpLimitCounter counter)
+{
+    switch (counter)
+    {
+        case IpLimitCounter::ADMISSIONS:               return "admissions";
+        case IpLimitCounter::RATE_LIMIT_KICKS:         return "rate_limit_kicks";
+        case IpLimitCounter::CONCURRENT_LIMIT_KICKS:   return "concurrent_limit_kicks";
+        case IpLimitCounter::RATE_LIMIT_REJECTS:       return "rate_limit_rejects";
+        case IpLimitCounter::CONCURRENT_LIMIT_REJECTS: return "concurrent_limit_rejects";
+        case IpLimitCounter::BURST_REJECTS:            return "burst_rejects";
+        case IpLimitCounter::TEMP_BAN_REJECTS:         return "temp_ban_rejects";
+        case IpLimitCounter::GM_BYPASSES:              return "gm_bypasses";
+        case IpLimitCounter::ACCESS_LOG_LINES:         return "access_log_lines";
+        case IpLimitCounter::BACKUP_ROWS:              return "backup_rows";
+        default:                                       return "unknown";
+    }
+}
+
+std::string IpLimitMetrics::FormatDuration(uint64_t nanoseconds)
+{
+    char buffer[32];
+    if (nanoseconds < 1000)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%lluns", static_cast<unsigned long long>(nanoseconds));
+    }
+    else if (nanoseconds < 1000000)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.1fus", nanoseconds / 1e3);
+    }
+    else if (nanoseconds < 1000000000)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.2fms", nanoseconds / 1e6);
+    }
+    else
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.2fs", nanoseconds / 1e9);
+    }
+
+    return buffer;
+}
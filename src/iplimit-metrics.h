@@ -0,0 +1,164 @@
+// Filename iplimit-metrics.h
+#ifndef IPLIMIT_METRICS_H
+#define IPLIMIT_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// 로그-선형 히스토그램 (잠금 없음)
+// 2의 거듭제곱 구간마다 SUB_BUCKETS 개의 같은 폭 구간을 두어 상대 오차를 1/SUB_BUCKETS 이내로 유지합니다.
+// 기록은 relaxed 원자 연산 몇 번뿐이므로 여러 스레드의 훅에서 동시에 호출해도 됩니다.
+// 읽는 쪽은 기록 중인 값과 섞인 근사 값을 볼 수 있으며 통계 표시용으로는 충분합니다.
+class LogLinearHistogram
+{
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 3;
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr uint32_t MAX_EXPONENT = 40;     // 2^41 ns (약 36분) 이상은 마지막 구간에 모읍니다.
+    static constexpr uint32_t BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Summary
+    {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+    };
+
+    void Record(uint64_t value);
+    Summary Summarize() const;
+    void Reset();
+
+    static uint32_t BucketIndex(uint64_t value);
+    // 구간에 속하는 가장 큰 값
+    static uint64_t BucketUpperBound(uint32_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> _buckets{};
+    std::atomic<uint64_t> _sum{ 0 };
+    std::atomic<uint64_t> _max{ 0 };
+};
+
+// 시간을 재는 작업 (ns 단위로 기록)
+enum class IpLimitTimer : uint8_t
+{
+    ACCOUNT_LOGIN,          // AccountScript::OnAccountLogin (비동기 쿼리 등록)
+    ACCOUNT_LOGIN_RESULT,   // 인증 쿼리 결과 처리 (ProcessAccountLogin)
+    SESSION_ADMISSION,      // 캐릭터 목록 요청 전 세션 판정
+    PLAYER_LOGIN,           // 판정 포함
+    PLAYER_LOGOUT,
+    DB_LOGIN_QUERY,         // 인증 쿼리 등록부터 결과 처리까지 (DB 왕복 + 월드 틱 대기)
+    DB_COMMAND_QUERY,       // 관리 명령의 동기 쿼리
+    DB_KICK_UPDATE,         // 강제 퇴장 시 online 플래그 갱신
+    DB_LOAD,                // 시작 시 화이트리스트/로그인 기록 로드
+    FORMATION_FLUSH,
+    FORMATION_PARTITION,    // 일별 기록 파티션 추가/삭제 (작업 스레드)
+    TEMP_BAN_FLUSH,         // 임시 차단 변경 DB 기록
+    ACCESS_LOG_WRITE,       // CSV 파일 쓰기 (로그 스레드)
+    ACCESS_LOG_COMPRESS,    // 교체된 로그 파일 gzip 압축 (압축 스레드)
+    BACKUP,                 // 로그인 기록 DB 백업 SQL 생성/전송 (작업 스레드, 종료 시에는 커밋 포함)
+    LOCAL_SNAPSHOT,
+    SWEEP,
+    RECONCILE,
+    COUNT
+};
+
+// 누적 횟수
+enum class IpLimitCounter : uint8_t
+{
+    ADMISSIONS,
+    RATE_LIMIT_KICKS,
+    CONCURRENT_LIMIT_KICKS,
+    RATE_LIMIT_REJECTS,         // 캐릭터 목록 요청 전 세션 거부
+    CONCURRENT_LIMIT_REJECTS,
+    BURST_REJECTS,              // 로그인 시도 폭주 (세션 거부 + 입장 후 퇴장)
+    TEMP_BAN_REJECTS,           // 임시 차단 중인 IP의 시도
+    GM_BYPASSES,
+    ACCESS_LOG_LINES,
+    BACKUP_ROWS,
+    COUNT
+};
+
+// 모듈 계측 값 모음
+// 훅/DB 호출/파일 쓰기의 소요 시간 히스토그램과 판정 결과 횟수를 모으고, .iplimit stats 와 주기적 로그로 보여줍니다.
+class IpLimitMetrics
+{
+public:
+    static IpLimitMetrics* instance();
+
+    // 꺼져 있으면 시간 측정(시계 읽기)을 건너뜁니다. 횟수는 항상 셉니다.
+    void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    void Record(IpLimitTimer timer, uint64_t nanoseconds) { _timers[static_cast<std::size_t>(timer)].Record(nanoseconds); }
+    void Increment(IpLimitCounter counter, uint64_t amount = 1) { _counters[static_cast<std::size_t>(counter)].fetch_add(amount, std::memory_order_relaxed); }
+
+    LogLinearHistogram::Summary GetTimer(IpLimitTimer timer) const { return _timers[static_cast<std::size_t>(timer)].Summarize(); }
+    uint64_t GetCounter(IpLimitCounter counter) const { return _counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed); }
+
+    // 모든 값을 0으로 되돌립니다. 반환값은 이전 초기화 이후 지난 시간(초)
+    uint64_t Reset();
+    uint64_t GetSecondsSinceReset() const;
+
+    static char const* GetName(IpLimitTimer timer);
+    static char const* GetName(IpLimitCounter counter);
+
+    // 850ns, 12.3us, 4.56ms, 1.20s 형식
+    static std::string FormatDuration(uint64_t nanoseconds);
+
+private:
+    IpLimitMetrics();
+
+    std::atomic<bool> _enabled{ true };
+    std::array<LogLinearHistogram, static_cast<std::size_t>(IpLimitTimer::COUNT)> _timers;
+    std::array<std::atomic<uint64_t>, static_cast<std::size_t>(IpLimitCounter::COUNT)> _counters{};
+    std::atomic<int64_t> _resetTime;    // steady_clock 초
+};
+
+#define sIpLimitMetrics IpLimitMetrics::instance()
+
+// 범위를 벗어날 때 경과 시간을 기록합니다.
+class IpLimitScopedTimer
+{
+public:
+    explicit IpLimitScopedTimer(IpLimitTimer timer) : _timer(timer), _active(sIpLimitMetrics->IsEnabled())
+    {
+        if (_active)
+        {
+            _start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~IpLimitScopedTimer()
+    {
+        if (_active)
+        {
+            sIpLimitMetrics->Record(_timer, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count()));
+        }
+    }
+
+    IpLimitScopedTimer(IpLimitScopedTimer const&) = delete;
+    IpLimitScopedTimer& operator=(IpLimitScopedTimer const&) = delete;
+
+private:
+    IpLimitTimer _timer;
+    bool _active;
+    std::chrono::steady_clock::time_point _start;
+};
+
+// fn 의 실행 시간을 기록하고 반환값을 그대로 돌려줍니다. (예: DB 쿼리)
+template<typename Function>
+decltype(auto) MeasureTime(IpLimitTimer timer, Function&& fn)
+{
+    IpLimitScopedTimer scope(timer);
+    return std::forward<Function>(fn)();
+}
+
+#endif
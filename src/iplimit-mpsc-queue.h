@@ -0,0 +1,110 @@
+// Filename iplimit-mpsc-queue.h
+#ifndef IPLIMIT_MPSC_QUEUE_H
+#define IPLIMIT_MPSC_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 고정 크기 다중 생산자 / 단일 소비자 큐 (잠금 없음)
+// 칸마다 순번(sequence)을 두어 생산자는 위치 하나를 CAS 로 예약한 뒤 값을 쓰고 순번을 게시합니다. (Vyukov 방식)
+// 큐가 가득 차면 TryPush 는 기다리지 않고 false 를 반환하므로 호출 쪽(게임 훅)이 막히지 않습니다.
+// T 는 복사가 싸고 예외를 던지지 않는 POD 구조체를 전제로 합니다.
+template<typename T>
+class BoundedMpscQueue
+{
+public:
+    // capacity 는 2의 거듭제곱으로 올림합니다.
+    explicit BoundedMpscQueue(std::size_t capacity)
+        : _capacity(std::bit_ceil(capacity < 2 ? std::size_t(2) : capacity)), _mask(_capacity - 1), _cells(new Cell[_capacity])
+    {
+        for (std::size_t i = 0; i < _capacity; ++i)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(BoundedMpscQueue const&) = delete;
+    BoundedMpscQueue& operator=(BoundedMpscQueue const&) = delete;
+
+    std::size_t Capacity() const { return _capacity; }
+
+    // 여러 스레드에서 동시에 호출할 수 있습니다.
+    bool TryPush(T const& value)
+    {
+        std::size_t position = _enqueue.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &_cells[position & _mask];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (diff == 0)
+            {
+                if (_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = _enqueue.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 소비자 스레드 하나에서만 호출합니다.
+    bool TryPop(T& value)
+    {
+        Cell& cell = _cells[_dequeue & _mask];
+        if (cell.sequence.load(std::memory_order_acquire) != _dequeue + 1)
+        {
+            return false;
+        }
+
+        value = cell.value;
+        cell.sequence.store(_dequeue + _capacity, std::memory_order_release);
+        ++_dequeue;
+        return true;
+    }
+
+    // 대략적인 대기 건수 (통계/깨우기 판단용)
+    std::size_t ApproxSize() const
+    {
+        std::size_t enqueue = _enqueue.load(std::memory_order_relaxed);
+        std::size_t dequeue = _dequeueSnapshot.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    // 소비자가 처리 위치를 다른 스레드에 알립니다. (ApproxSize 용)
+    void PublishProgress() { _dequeueSnapshot.store(_dequeue, std::memory_order_relaxed); }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::size_t const _capacity;
+    std::size_t const _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    // 생산자와 소비자 위치가 같은 캐시 라인을 두고 경합하지 않도록 분리합니다.
+    alignas(64) std::atomic<std::size_t> _enqueue{0};
+    alignas(64) std::size_t _dequeue = 0;
+    std::atomic<std::size_t> _dequeueSnapshot{0};
+};
+
+#endif
@@ -0,0 +1,345 @@
+// Filename iplimit-session-registry.cpp
+#include "iplimit-session-registry.h"
+#include <algorithm>
+
+IpSessionRegistry* IpSessionRegistry::instance()
+{
+    static IpSessionRegistry instance;
+    return &instance;
+}
+
+void IpSessionRegistry::DetachLocked(uint32_t accountId, AccountEntry const& entry)
+{
+    auto it = _ips.find(entry.ip);
+    if (it == _ips.end())
+    {
+        return;
+    }
+
+    std::vector<uint32_t>& accounts = it->second.accounts;
+    auto account = std::find(accounts.begin(), accounts.end(), accountId);
+    if (account != accounts.end())
+    {
+        *account = accounts.back();
+        accounts.pop_back();
+    }
+
+    if (entry.inWorld && it->second.players > 0)
+    {
+        --it->second.players;
+    }
+
+    if (accounts.empty() && it->second.players == 0)
+    {
+        _ips.erase(it);
+    }
+}
+
+void IpSessionRegistry::AttachLocked(uint32_t accountId, AccountEntry const& entry)
+{
+    IpCounters& counters = _ips[entry.ip];
+    counters.accounts.push_back(accountId);
+    if (entry.inWorld)
+    {
+        ++counters.players;
+    }
+}
+
+void IpSessionRegistry::OnSessionAuthenticated(uint32_t accountId)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    if (it != _accounts.end())
+    {
+        it->second.admitted = false;
+    }
+}
+
+void IpSessionRegistry::OnSessionOpened(uint32_t accountId, IpAddress const& ip, uint64_t session)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    if (it != _accounts.end())
+    {
+        if (it->second.ip == ip)
+        {
+            // 같은 IP로 재접속한 새 세션
+            if (session && it->second.session != session)
+            {
+                it->second.session = session;
+                it->second.admitted = false;
+            }
+
+            return;
+        }
+
+        // 같은 계정이 다른 IP로 재접속: 이전 IP의 카운터를 먼저 해제
+        DetachLocked(it->first, it->second);
+        it->second.ip = ip;
+        it->second.session = session;
+        it->second.admitted = false;
+        AttachLocked(it->first, it->second);
+        return;
+    }
+
+    AccountEntry& entry = _accounts[accountId];
+    entry.ip = ip;
+    entry.session = session;
+    AttachLocked(accountId, entry);
+}
+
+void IpSessionRegistry::OnSessionAdmitted(uint32_t accountId, IpAddress const& ip, uint64_t session)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    if (it == _accounts.end())
+    {
+        // 인증 콜백보다 캐릭터 목록 요청이 먼저 처리된 경우
+        AccountEntry& entry = _accounts[accountId];
+        entry.ip = ip;
+        entry.session = session;
+        entry.admitted = true;
+        AttachLocked(accountId, entry);
+        return;
+    }
+
+    if (it->second.ip != ip)
+    {
+        DetachLocked(it->first, it->second);
+        it->second.ip = ip;
+        AttachLocked(it->first, it->second);
+    }
+
+    it->second.session = session;
+    it->second.admitted = true;
+}
+
+void IpSessionRegistry::OnSessionClosed(uint32_t accountId)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    if (it == _accounts.end())
+    {
+        return;
+    }
+
+    DetachLocked(it->first, it->second);
+    _accounts.erase(it);
+}
+
+void IpSessionRegistry::OnPlayerEntered(uint32_t accountId, IpAddress const& ip)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    if (it == _accounts.end())
+    {
+        // 인증 콜백보다 캐릭터 입장이 먼저 처리된 경우
+        AccountEntry& entry = _accounts[accountId];
+        entry.ip = ip;
+        entry.inWorld = true;
+        AttachLocked(accountId, entry);
+        return;
+    }
+
+    if (it->second.ip != ip)
+    {
+        DetachLocked(it->first, it->second);
+        it->second.ip = ip;
+        it->second.inWorld = true;
+        it->second.admitted = false;
+        AttachLocked(it->first, it->second);
+        return;
+    }
+
+    if (!it->second.inWorld)
+    {
+        it->second.inWorld = true;
+        ++_ips[ip].players;
+    }
+}
+
+void IpSessionRegistry::OnPlayerLeft(uint32_t accountId)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    if (it == _accounts.end() || !it->second.inWorld)
+    {
+        return;
+    }
+
+    it->second.inWorld = false;
+
+    auto ipItr = _ips.find(it->second.ip);
+    if (ipItr != _ips.end() && ipItr->second.players > 0)
+    {
+        --ipItr->second.players;
+    }
+}
+
+uint32_t IpSessionRegistry::GetSessionCount(IpAddress const& ip, uint32_t excludeAccountId) const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _ips.find(ip);
+    if (it == _ips.end())
+    {
+        return 0;
+    }
+
+    uint32_t count = static_cast<uint32_t>(it->second.accounts.size());
+    if (excludeAccountId && count > 0)
+    {
+        auto self = _accounts.find(excludeAccountId);
+        if (self != _accounts.end() && self->second.ip == ip)
+        {
+            --count;
+        }
+    }
+
+    return count;
+}
+
+uint32_t IpSessionRegistry::GetOnlinePlayerCount(IpAddress const& ip, uint32_t excludeAccountId) const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _ips.find(ip);
+    if (it == _ips.end())
+    {
+        return 0;
+    }
+
+    uint32_t count = it->second.players;
+    if (excludeAccountId && count > 0)
+    {
+        auto self = _accounts.find(excludeAccountId);
+        if (self != _accounts.end() && self->second.inWorld && self->second.ip == ip)
+        {
+            --count;
+        }
+    }
+
+    return count;
+}
+
+bool IpSessionRegistry::GetAccountIp(uint32_t accountId, IpAddress& ip) const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    if (it == _accounts.end())
+    {
+        return false;
+    }
+
+    ip = it->second.ip;
+    return true;
+}
+
+std::vector<uint32_t> IpSessionRegistry::GetSessionAccounts(IpAddress const& ip, uint32_t excludeAccountId) const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _ips.find(ip);
+    if (it == _ips.end())
+    {
+        return {};
+    }
+
+    std::vector<uint32_t> accounts = it->second.accounts;
+    std::erase(accounts, excludeAccountId);
+    return accounts;
+}
+
+bool IpSessionRegistry::IsSessionAdmitted(uint32_t accountId, IpAddress const& ip, uint64_t session) const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto it = _accounts.find(accountId);
+    return it != _accounts.end() && it->second.admitted && it->second.ip == ip && (!session || it->second.session == session);
+}
+
+std::size_t IpSessionRegistry::GetAccountCount() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _accounts.size();
+}
+
+std::size_t IpSessionRegistry::GetIpCount() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _ips.size();
+}
+
+std::size_t IpSessionRegistry::MemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    // unordered_map 노드는 (키, 값) 과 다음 노드 포인터, 캐시된 해시를 담습니다.
+    std::size_t nodeSize = sizeof(std::pair<uint32_t const, AccountEntry>) + 2 * sizeof(void*);
+    std::size_t usage = sizeof(*this) + _ips.memory_usage() + _accounts.bucket_count() * sizeof(void*) + _accounts.size() * nodeSize;
+    for (auto const& [ip, counters] : _ips)
+    {
+        usage += counters.accounts.capacity() * sizeof(uint32_t);
+    }
+
+    return usage;
+}
+
+uint32_t IpSessionRegistry::Reconcile(LiveSessionMap const& liveSessions)
+{
+    std::unordered_map<uint32_t, AccountEntry> accounts;
+    FlatHashMap<IpAddress, IpCounters, IpAddressHash> ips;
+    accounts.reserve(liveSessions.size());
+
+    for (auto const& [accountId, session] : liveSessions)
+    {
+        AccountEntry& entry = accounts[accountId];
+        entry.ip = session.ip;
+        entry.inWorld = session.inWorld;
+        entry.session = session.session;
+
+        IpCounters& counters = ips[entry.ip];
+        counters.accounts.push_back(accountId);
+        if (entry.inWorld)
+        {
+            ++counters.players;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+
+    // 변경된 계정 수 집계 (추가/삭제/IP 또는 입장 상태 불일치)
+    uint32_t corrected = 0;
+    for (auto& [accountId, entry] : accounts)
+    {
+        auto it = _accounts.find(accountId);
+        if (it == _accounts.end() || it->second.ip != entry.ip || it->second.inWorld != entry.inWorld)
+        {
+            ++corrected;
+        }
+
+        if (it != _accounts.end() && it->second.ip == entry.ip && (!entry.session || it->second.session == entry.session))
+        {
+            entry.admitted = it->second.admitted;
+        }
+    }
+
+    for (auto const& [accountId, entry] : _accounts)
+    {
+        if (accounts.find(accountId) == accounts.end())
+        {
+            ++corrected;
+        }
+    }
+
+    _accounts.swap(accounts);
+    _ips.swap(ips);
+    return corrected;
+}
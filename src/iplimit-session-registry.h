@@ -0,0 +1,91 @@
+// Filename iplimit-session-registry.h
+#ifndef IPLIMIT_SESSION_REGISTRY_H
+#define IPLIMIT_SESSION_REGISTRY_H
+
+#include "iplimit-flat-map.h"
+#include "iplimit-ip-address.h"
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 현재 접속 중인 세션을 계정/IP 기준으로 추적하는 레지스트리
+// 동시 접속 검사가 DB(characters.online) 조회 없이 메모리에서 O(1)로 끝나도록 합니다.
+// 로그인/캐릭터 입장·퇴장 훅에서 갱신하고, 주기적으로 실제 WorldSession 목록과 대조(Reconcile)하여 오차를 바로잡습니다.
+// 세션 종료 훅은 없으므로 끊긴 세션은 Reconcile 에서 빠집니다.
+// 판정 엔진/벤치마크에서도 쓰이므로 AzerothCore 헤더에 의존하지 않습니다.
+class IpSessionRegistry
+{
+public:
+    // 재조정에 사용하는 실제 세션 정보 (계정 ID -> 세션)
+    struct LiveSession
+    {
+        IpAddress ip;
+        bool inWorld;
+        uint64_t session = 0;
+    };
+    typedef std::unordered_map<uint32_t, LiveSession> LiveSessionMap;
+
+    static IpSessionRegistry* instance();
+
+    // session 은 세션 인스턴스의 식별자입니다. (서버는 WorldSession 주소, 0 이면 구분하지 않음)
+    // 판정 통과 표시는 세션 인스턴스에 속하므로, 같은 계정/IP로 다시 접속한 새 세션은 다시 판정합니다.
+
+    // 계정 인증 (새 세션 시작) - 이전 세션의 판정 통과 표시를 지웁니다.
+    void OnSessionAuthenticated(uint32_t accountId);
+    // 계정 인증 완료 (세션 생성)
+    void OnSessionOpened(uint32_t accountId, IpAddress const& ip, uint64_t session = 0);
+    // 세션이 캐릭터 목록 요청 전 판정을 통과함 (세션이 없으면 함께 등록)
+    void OnSessionAdmitted(uint32_t accountId, IpAddress const& ip, uint64_t session = 0);
+    // 세션 종료
+    void OnSessionClosed(uint32_t accountId);
+    // 캐릭터가 월드에 입장 / 퇴장
+    void OnPlayerEntered(uint32_t accountId, IpAddress const& ip);
+    void OnPlayerLeft(uint32_t accountId);
+
+    // 해당 IP에서 접속 중인 세션 수 (excludeAccountId 자신은 제외)
+    uint32_t GetSessionCount(IpAddress const& ip, uint32_t excludeAccountId = 0) const;
+    // 해당 IP에서 월드에 입장해 있는 다른 계정의 캐릭터 수 (excludeAccountId 자신은 제외)
+    uint32_t GetOnlinePlayerCount(IpAddress const& ip, uint32_t excludeAccountId = 0) const;
+    // 계정의 현재 세션 IP
+    bool GetAccountIp(uint32_t accountId, IpAddress& ip) const;
+    // 해당 IP에 세션이 등록된 다른 계정 목록
+    std::vector<uint32_t> GetSessionAccounts(IpAddress const& ip, uint32_t excludeAccountId = 0) const;
+    // 계정의 현재 세션(session)이 ip 에서 판정을 통과했는지
+    bool IsSessionAdmitted(uint32_t accountId, IpAddress const& ip, uint64_t session = 0) const;
+    // 추적 중인 계정 / IP 수
+    std::size_t GetAccountCount() const;
+    std::size_t GetIpCount() const;
+    // 대략적인 사용 메모리 (바이트)
+    std::size_t MemoryUsage() const;
+
+    // 실제 세션 목록으로 레지스트리를 재구성합니다. 바로잡은 계정 수를 반환합니다.
+    // 같은 IP, 같은 세션 인스턴스로 남아 있는 세션의 판정 통과 여부는 유지합니다.
+    uint32_t Reconcile(LiveSessionMap const& liveSessions);
+
+private:
+    struct AccountEntry
+    {
+        IpAddress ip;
+        bool inWorld = false;
+        bool admitted = false;      // 세션 단계 판정 통과 (IP나 세션 인스턴스가 바뀌면 해제)
+        uint64_t session = 0;
+    };
+
+    struct IpCounters
+    {
+        std::vector<uint32_t> accounts;     // 세션이 등록된 계정 (세션 수 = 크기, 순서 없음)
+        uint32_t players = 0;
+    };
+
+    void DetachLocked(uint32_t accountId, AccountEntry const& entry);
+    void AttachLocked(uint32_t accountId, AccountEntry const& entry);
+
+    mutable std::mutex _lock;
+    std::unordered_map<uint32_t, AccountEntry> _accounts;
+    FlatHashMap<IpAddress, IpCounters, IpAddressHash> _ips;
+};
+
+#define sIpSessionRegistry IpSessionRegistry::instance()
+
+#endif
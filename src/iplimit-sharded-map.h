@@ -0,0 +1,106 @@
+// Filename iplimit-sharded-map.h
+#ifndef IPLIMIT_SHARDED_MAP_H
+#define IPLIMIT_SHARDED_MAP_H
+
+#include "iplimit-flat-map.h"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+// 키 해시로 고른 샤드마다 별도의 잠금을 두는 해시 맵 (striped locking)
+// 서로 다른 IP의 로그인은 대부분 다른 샤드를 잠그므로 하나의 전역 mutex 에서 경합하지 않습니다.
+// 백업/관리 명령은 ForEachShard 로 샤드를 하나씩 잠그며 순회하여, 순회 중에도 나머지 샤드의 로그인은 진행됩니다.
+// 샤드 선택에는 해시 상위 비트를, 샤드 내부 FlatHashMap 은 하위 비트를 사용하여 서로 영향을 주지 않습니다.
+template<typename Key, typename Value, typename Hash, std::size_t ShardCount = 16>
+class ShardedMap
+{
+public:
+    typedef FlatHashMap<Key, Value, Hash> Map;
+
+    static_assert(ShardCount > 1 && std::has_single_bit(ShardCount), "ShardCount must be a power of two");
+    static constexpr std::size_t SHARD_COUNT = ShardCount;
+
+    static std::size_t ShardOf(Key const& key)
+    {
+        return Hash()(key) >> (std::numeric_limits<std::size_t>::digits - std::countr_zero(ShardCount));
+    }
+
+    // 키가 속한 샤드를 잠근 상태로 fn(map) 을 호출하고 그 결과를 반환합니다.
+    template<typename Function>
+    decltype(auto) With(Key const& key, Function&& fn)
+    {
+        return WithShard(ShardOf(key), std::forward<Function>(fn));
+    }
+
+    template<typename Function>
+    decltype(auto) With(Key const& key, Function&& fn) const
+    {
+        return WithShard(ShardOf(key), std::forward<Function>(fn));
+    }
+
+    template<typename Function>
+    decltype(auto) WithShard(std::size_t index, Function&& fn)
+    {
+        Shard& shard = _shards[index];
+        std::lock_guard<std::mutex> lock(shard.lock);
+        return fn(shard.map);
+    }
+
+    template<typename Function>
+    decltype(auto) WithShard(std::size_t index, Function&& fn) const
+    {
+        Shard const& shard = _shards[index];
+        std::lock_guard<std::mutex> lock(shard.lock);
+        return fn(shard.map);
+    }
+
+    // 샤드를 하나씩 잠그며 fn(index, map) 을 호출합니다. 샤드 사이의 일관성은 보장하지 않습니다.
+    template<typename Function>
+    void ForEachShard(Function&& fn)
+    {
+        for (std::size_t i = 0; i < ShardCount; ++i)
+        {
+            WithShard(i, [&](Map& map) { fn(i, map); });
+        }
+    }
+
+    template<typename Function>
+    void ForEachShard(Function&& fn) const
+    {
+        for (std::size_t i = 0; i < ShardCount; ++i)
+        {
+            WithShard(i, [&](Map const& map) { fn(i, map); });
+        }
+    }
+
+    std::size_t Size() const
+    {
+        std::size_t size = 0;
+        ForEachShard([&size](std::size_t, Map const& map) { size += map.size(); });
+        return size;
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    std::size_t MemoryUsage() const
+    {
+        std::size_t bytes = sizeof(*this);
+        ForEachShard([&bytes](std::size_t, Map const& map) { bytes += map.memory_usage(); });
+        return bytes;
+    }
+
+private:
+    // 인접한 샤드의 잠금이 같은 캐시 라인을 공유하지 않도록 정렬합니다.
+    struct alignas(64) Shard
+    {
+        mutable std::mutex lock;
+        Map map;
+    };
+
+    std::array<Shard, ShardCount> _shards;
+};
+
+#endif
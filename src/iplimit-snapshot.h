@@ -0,0 +1,37 @@
+// Filename iplimit-snapshot.h
+#ifndef IPLIMIT_SNAPSHOT_H
+#define IPLIMIT_SNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+
+// 불변(immutable) 객체를 원자적으로 교체/조회하기 위한 래퍼
+// 읽는 쪽은 한 번의 원자적 로드로 스냅샷을 얻고, 쓰는 쪽은 새 객체를 만들어 통째로 교체합니다.
+template<typename T>
+class AtomicSnapshot
+{
+public:
+    typedef std::shared_ptr<T const> Pointer;
+
+    AtomicSnapshot() = default;
+    explicit AtomicSnapshot(Pointer value) : _value(std::move(value)) { }
+
+    AtomicSnapshot(AtomicSnapshot const&) = delete;
+    AtomicSnapshot& operator=(AtomicSnapshot const&) = delete;
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+    Pointer Load() const { return _value.load(std::memory_order_acquire); }
+    void Store(Pointer value) { _value.store(std::move(value), std::memory_order_release); }
+
+private:
+    std::atomic<Pointer> _value;
+#else
+    Pointer Load() const { return std::atomic_load_explicit(&_value, std::memory_order_acquire); }
+    void Store(Pointer value) { std::atomic_store_explicit(&_value, std::move(value), std::memory_order_release); }
+
+private:
+    Pointer _value;
+#endif
+};
+
+#endif
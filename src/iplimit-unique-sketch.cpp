@@ -0,0 +1,203 @@
+// Filename iplimit-unique-sketch.cpp
+#include "iplimit-unique-sketch.h"
+#include "iplimit-ip-address.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+uint8_t UniqueAccountSketch::PrecisionForError(double relativeError)
+{
+    if (!(relativeError > 0.0))
+    {
+        return MAX_PRECISION;
+    }
+
+    double registers = std::pow(1.04 / relativeError, 2.0);
+    int precision = static_cast<int>(std::ceil(std::log2(registers)));
+    return static_cast<uint8_t>(std::clamp<int>(precision, MIN_PRECISION, MAX_PRECISION));
+}
+
+double UniqueAccountSketch::ErrorOf(uint8_t precision)
+{
+    return 1.04 / std::sqrt(static_cast<double>(uint32_t(1) << precision));
+}
+
+void UniqueAccountSketch::Init(uint8_t precision, uint32_t buckets, uint32_t window)
+{
+    _precision = std::clamp(precision, MIN_PRECISION, MAX_PRECISION);
+    _window = std::max<uint32_t>(window, 1);
+
+    buckets = std::clamp<uint32_t>(buckets, 1, _window);
+    _span = (_window + buckets - 1) / buckets;
+
+    // 창에 걸친 구간 수 + 지금 채우는 구간 하나
+    _slots = (_window + _span - 1) / _span + 1;
+
+    std::size_t registers = (std::size_t(_slots) + 1) << _precision;
+    _registers = std::make_unique<uint8_t[]>(registers);
+    _epochs = std::make_unique<uint32_t[]>(_slots);
+    std::memset(_registers.get(), 0, registers);
+    std::memset(_epochs.get(), 0, sizeof(uint32_t) * _slots);
+
+    _unionEpoch = 0;
+    _unionValid = false;
+    _estimateValid = false;
+    _estimate = 0;
+}
+
+uint32_t UniqueAccountSketch::OldestEpoch(uint32_t now) const
+{
+    // 구간 e 는 [(e - 1) * span, e * span) 을 담으며, e * span > now - window 이면 창 안입니다.
+    return now > _window ? (now - _window) / _span + 1 : 1;
+}
+
+void UniqueAccountSketch::Add(uint32_t accountId, uint32_t loginTime)
+{
+    uint32_t epoch = loginTime / _span + 1;
+    uint32_t slot = epoch % _slots;
+
+    if (_epochs[slot] != epoch)
+    {
+        // 같은 칸을 이미 더 새로운 구간이 쓰고 있으면 창 밖의 기록이므로 버립니다.
+        if (_epochs[slot] > epoch)
+        {
+            return;
+        }
+
+        std::memset(Bucket(slot), 0, std::size_t(1) << _precision);
+        _epochs[slot] = epoch;
+        _unionValid = false;
+        _estimateValid = false;
+    }
+
+    uint64_t hash = IpAddressHash::Mix(accountId);
+    uint32_t index = static_cast<uint32_t>(hash >> (64 - _precision));
+    uint8_t rank = static_cast<uint8_t>(std::min<int>(std::countl_zero(hash << _precision), 64 - _precision) + 1);
+
+    uint8_t& reg = Bucket(slot)[index];
+    if (reg >= rank)
+    {
+        return;
+    }
+
+    reg = rank;
+    if (_unionValid && epoch >= _unionEpoch && Union()[index] < rank)
+    {
+        Union()[index] = rank;
+        _estimateValid = false;
+    }
+}
+
+void UniqueAccountSketch::RebuildUnion(uint32_t oldestEpoch)
+{
+    std::size_t registers = std::size_t(1) << _precision;
+    uint8_t* target = Union();
+    std::memset(target, 0, registers);
+
+    for (uint32_t slot = 0; slot < _slots; ++slot)
+    {
+        if (_epochs[slot] < oldestEpoch)
+        {
+            continue;
+        }
+
+        uint8_t const* source = Bucket(slot);
+        for (std::size_t i = 0; i < registers; ++i)
+        {
+            target[i] = std::max(target[i], source[i]);
+        }
+    }
+
+    _unionEpoch = oldestEpoch;
+    _unionValid = true;
+    _estimateValid = false;
+}
+
+uint32_t UniqueAccountSketch::Estimate(uint32_t accountId, uint32_t now, bool& contains)
+{
+    uint32_t oldestEpoch = OldestEpoch(now);
+    if (!_unionValid || _unionEpoch != oldestEpoch)
+    {
+        RebuildUnion(oldestEpoch);
+    }
+
+    uint8_t const* registers = Union();
+
+    uint64_t hash = IpAddressHash::Mix(accountId);
+    uint32_t index = static_cast<uint32_t>(hash >> (64 - _precision));
+    uint8_t rank = static_cast<uint8_t>(std::min<int>(std::countl_zero(hash << _precision), 64 - _precision) + 1);
+    contains = registers[index] >= rank;
+
+    if (_estimateValid)
+    {
+        return _estimate;
+    }
+
+    uint32_t count = uint32_t(1) << _precision;
+    double m = static_cast<double>(count);
+    double sum = 0.0;
+    uint32_t zeros = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        sum += std::ldexp(1.0, -int(registers[i]));
+        zeros += registers[i] == 0;
+    }
+
+    double alpha;
+    switch (count)
+    {
+        case 16: alpha = 0.673; break;
+        case 32: alpha = 0.697; break;
+        case 64: alpha = 0.709; break;
+        default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+    }
+
+    double estimate = alpha * m * m / sum;
+
+    // 적은 수에서는 선형 계수가 더 정확합니다.
+    if (estimate <= 2.5 * m && zeros)
+    {
+        estimate = m * std::log(m / zeros);
+    }
+
+    _estimate = static_cast<uint32_t>(std::llround(estimate));
+    _estimateValid = true;
+    return _estimate;
+}
+
+bool UniqueAccountSketch::Expire(uint32_t now)
+{
+    uint32_t oldestEpoch = OldestEpoch(now);
+    bool empty = true;
+
+    for (uint32_t slot = 0; slot < _slots; ++slot)
+    {
+        if (!_epochs[slot])
+        {
+            continue;
+        }
+
+        if (_epochs[slot] < oldestEpoch)
+        {
+            // 레지스터는 칸을 다시 쓸 때 비웁니다.
+            _epochs[slot] = 0;
+            _unionValid = false;
+            continue;
+        }
+
+        empty = false;
+    }
+
+    return empty;
+}
+
+std::size_t UniqueAccountSketch::MemoryUsage() const
+{
+    if (!_registers)
+    {
+        return 0;
+    }
+
+    return ((std::size_t(_slots) + 1) << _precision) + sizeof(uint32_t) * _slots;
+}
@@ -0,0 +1,66 @@
+// Filename iplimit-unique-sketch.h
+#ifndef IPLIMIT_UNIQUE_SKETCH_H
+#define IPLIMIT_UNIQUE_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// IP 하나의 시간 구간별 HyperLogLog 스케치 (고유 계정 수 근사)
+// 시간 창을 buckets 개의 구간으로 나눠 구간마다 2^precision 바이트의 레지스터를 두고,
+// 창 안의 구간을 레지스터별 최댓값으로 합쳐 고유 계정 수를 추정합니다.
+// 사용 메모리는 (buckets + 2) * 2^precision 바이트로 고정되어 로그인 수와 무관합니다.
+// 창의 시작은 구간 단위로 잘리므로, 만료는 최대 한 구간(창 / buckets)만큼 늦어집니다.
+// 엔진/도구에서도 쓰이므로 AzerothCore 헤더에 의존하지 않습니다.
+class UniqueAccountSketch
+{
+public:
+    static constexpr uint8_t MIN_PRECISION = 4;
+    static constexpr uint8_t MAX_PRECISION = 14;
+
+    // 상대 표준 오차(예: 0.02 = 2%) 이하가 되는 가장 작은 정밀도 (1.04 / sqrt(2^p))
+    static uint8_t PrecisionForError(double relativeError);
+    // 정밀도의 상대 표준 오차
+    static double ErrorOf(uint8_t precision);
+
+    UniqueAccountSketch() = default;
+    UniqueAccountSketch(UniqueAccountSketch&&) noexcept = default;
+    UniqueAccountSketch& operator=(UniqueAccountSketch&&) noexcept = default;
+
+    // 사용 전에 한 번 호출합니다. 창 길이가 바뀌면 다시 호출하며 그때까지의 기록은 버립니다.
+    void Init(uint8_t precision, uint32_t buckets, uint32_t window);
+    bool IsInitialized() const { return _registers != nullptr; }
+    uint32_t Window() const { return _window; }
+
+    void Add(uint32_t accountId, uint32_t loginTime);
+
+    // now 기준 창 안의 고유 계정 추정치
+    // contains 는 accountId 를 더해도 추정치가 바뀌지 않는지(이미 포함되었을 수 있는지)를 담습니다.
+    uint32_t Estimate(uint32_t accountId, uint32_t now, bool& contains);
+
+    // 창이 지난 구간을 비웁니다. 모든 구간이 비면 true
+    bool Expire(uint32_t now);
+
+    std::size_t MemoryUsage() const;
+
+private:
+    uint8_t* Bucket(uint32_t slot) const { return _registers.get() + (std::size_t(slot) << _precision); }
+    uint8_t* Union() const { return _registers.get() + (std::size_t(_slots) << _precision); }
+    uint32_t OldestEpoch(uint32_t now) const;
+    void RebuildUnion(uint32_t oldestEpoch);
+
+    std::unique_ptr<uint8_t[]> _registers;      // 구간 _slots 개 + 합친 레지스터
+    std::unique_ptr<uint32_t[]> _epochs;        // 구간 번호 (loginTime / _span + 1), 0 이면 빈 구간
+    uint32_t _slots = 0;
+    uint32_t _span = 0;
+    uint32_t _window = 0;
+    uint8_t _precision = 0;
+
+    // 합친 레지스터와 추정치 캐시 (구간이 만료되면 다시 합침)
+    uint32_t _unionEpoch = 0;                   // 합칠 때 창 안에 있던 가장 오래된 구간 번호
+    bool _unionValid = false;
+    bool _estimateValid = false;
+    uint32_t _estimate = 0;
+};
+
+#endif
@@ -3,98 +3,179 @@
 #include "World.h"
 #include "ScriptMgr.h"
 #include "Chat.h"
-#include "Config.h"
 #include "DatabaseEnv.h"
-#include "AccountMgr.h"
+#include "AsyncCallbackProcessor.h"
 #include "WorldSession.h"
+#include "WorldPacket.h"
 #include "GameTime.h"
+#include "ObjectAccessor.h"
+#include "WorldSessionMgr.h"
+#include "CharacterCache.h"
+#include "ObjectMgr.h"
+#include "iplimit-access-log.h"
+#include "iplimit-account-graph.h"
+#include "iplimit-account-name-cache.h"
+#include "iplimit-admission-engine.h"
+#include "iplimit-burst-limiter.h"
+#include "iplimit-cidr-trie.h"
+#include "iplimit-config.h"
+#include "iplimit-formation-buffer.h"
+#include "iplimit-history-store.h"
+#include "iplimit-flat-map.h"
+#include "iplimit-ip-address.h"
+#include "iplimit-kick-scheduler.h"
+#include "iplimit-login-window.h"
+#include "iplimit-metrics.h"
+#include "iplimit-session-registry.h"
+#include "iplimit-sharded-map.h"
 #include <unordered_map>
+#include <map>
 #include <set>
 #include <mutex>
 #include <sstream>
-#include <fstream>
 #include <iomanip>
 #include <filesystem>
+#include <future>
 #include <ctime>
-#include <deque>
-
-std::mutex ipMutex;
-std::unordered_map<std::string, uint32> ipConnectionCount;
-std::unordered_map<std::string, uint32> ipMaxConnectionLimits;
+#include <cstdio>
+#include <algorithm>
 
+// IP별 고유 계정 로그인 기록을 저장하기 위한 데이터 구조
+// <IP 주소, 계정별 최근 로그인 시간 창>
+// 만료된 기록은 로그인 시 해당 IP에서, 그리고 OnUpdate 의 점진적 정리(sweep)로 전체에서 제거됩니다.
+ShardedMap<IpAddress, LoginWindow, IpAddressHash> ipLoginHistory;
 
-// IP별 제한 설정을 위한 구조체
-struct IpLimitSettings
+// 게임 시간(초)을 판정 시각으로 사용
+class GameTimeAdmissionClock : public AdmissionClock
 {
-    uint32 maxConnections;
-    uint32 maxUniqueAccounts;
+public:
+    uint32 Now() const override { return static_cast<uint32>(GameTime::GetGameTime().count()); }
 };
-std::unordered_map<std::string, IpLimitSettings> allowedIps;
-
-// IP별 고유 계정 로그인 기록을 저장하기 위한 데이터 구조
-// <IP 주소, <(계정 ID, 로그인 시간) 목록>>
-std::unordered_map<std::string, std::deque<std::pair<uint32, time_t>>> ipLoginHistory;
 
+// 접속 허용 판정 엔진 (화이트리스트 포함), 상태는 위의 로그인 기록과 세션 레지스트리에 둡니다.
+GameTimeAdmissionClock admissionClock;
+MemoryAdmissionStorage admissionStorage(ipLoginHistory, *sIpSessionRegistry);
+AdmissionEngine admissionEngine(admissionClock, admissionStorage, sKickScheduler, sBurstLimiter);
 
-// 강제 퇴장 예정인 플레이어 관리를 위한 구조체와 맵
-enum class KickReason
+static BurstPolicy MakeBurstPolicy(IpLimitConfig const& config)
 {
-    CONCURRENT_LIMIT,
-    RATE_LIMIT
-};
-
-struct KickInfo {
-    uint32 accountId;
-    uint32 kickTime;
-    bool messageSent;
-    KickReason reason;
-};
-std::unordered_map<ObjectGuid, KickInfo> pendingKicks;
-std::mutex kickMutex;
+    BurstPolicy policy;
+    policy.capacity = config.burstCapacity;
+    policy.refillSeconds = config.burstRefillSeconds;
+    policy.banThreshold = config.burstBanThreshold;
+    policy.violationWindow = config.burstViolationWindow;
+    policy.banResetSeconds = config.burstBanResetSeconds;
+    policy.banLevels = static_cast<uint8>(std::min(config.burstBanDurations.size(), BurstPolicy::MAX_BAN_LEVELS));
+    std::copy_n(config.burstBanDurations.begin(), policy.banLevels, policy.banDurations.begin());
+    return policy;
+}
 
-// CSV 로깅을 위한 전역 변수
-std::mutex csvMutex;
-std::ofstream csvFile;
-std::string currentLogDate;
-std::string serverStartTime;
+// 현재 설정에서 판정 정책을 만듭니다.
+static AdmissionPolicy MakeAdmissionPolicy(IpLimitConfig const& config)
+{
+    AdmissionPolicy policy;
+    policy.maxAccountEnable = config.maxAccountEnable;
+    policy.maxAccount = config.maxAccount;
+    policy.rateLimitEnable = config.rateLimitEnable;
+    policy.rateLimitTimeWindow = config.rateLimitTimeWindow;
+    policy.rateLimitMaxUniqueAccounts = config.rateLimitMaxUniqueAccounts;
+    policy.burstEnable = config.burstEnable;
+    policy.burst = MakeBurstPolicy(config);
+    return policy;
+}
 
-// CSV 로깅 유틸리티 함수
-void EnsureLogDirectory()
+// 거부 사유 (로그용)
+static char const* KickReasonText(KickReason reason)
 {
-    // logs 폴더가 없으면 생성하기, 그외 각종 시스템 로그도 여기에 저장됨
-    std::filesystem::path baseLogDir = "logs";
-    if (!std::filesystem::exists(baseLogDir))
+    switch (reason)
     {
-        std::filesystem::create_directory(baseLogDir);
-        LOG_INFO("module.iplimit", "Created base log directory: {}", baseLogDir.string());
+        case KickReason::CONCURRENT_LIMIT: return "동시 접속 제한 초과";
+        case KickReason::RATE_LIMIT:       return "로그인 빈도 제한 초과";
+        case KickReason::BURST_LIMIT:      return "로그인 시도 폭주";
+        case KickReason::TEMP_BAN:         return "임시 차단 중";
+        default:                           return "알 수 없음";
     }
+}
 
-    std::filesystem::path logDir = "logs/iplimit";
-    if (!std::filesystem::exists(logDir))
+// 거부 사유별 횟수 (세션 단계 거부 / 월드 입장 후 퇴장)
+static IpLimitCounter KickReasonCounter(KickReason reason, AdmissionStage stage)
+{
+    switch (reason)
     {
-        std::filesystem::create_directories(logDir);
-        LOG_INFO("module.iplimit", "Created IPLimit log directory: {}", logDir.string());
+        case KickReason::RATE_LIMIT:  return stage == AdmissionStage::SESSION ? IpLimitCounter::RATE_LIMIT_REJECTS : IpLimitCounter::RATE_LIMIT_KICKS;
+        case KickReason::BURST_LIMIT: return IpLimitCounter::BURST_REJECTS;
+        case KickReason::TEMP_BAN:    return IpLimitCounter::TEMP_BAN_REJECTS;
+        default:                      return stage == AdmissionStage::SESSION ? IpLimitCounter::CONCURRENT_LIMIT_REJECTS : IpLimitCounter::CONCURRENT_LIMIT_KICKS;
     }
 }
 
-std::string GetCurrentDateTime()
+// 세션 레지스트리에서 세션 인스턴스를 구분하는 값
+static uint64 SessionKey(WorldSession const* session)
 {
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    return static_cast<uint64>(reinterpret_cast<uintptr_t>(session));
 }
 
-std::string GetCurrentDate()
+// 세션 단계에서 거부한 세션 (계정 -> 세션, 월드 스레드에서만 사용)
+// 인증 쿼리 콜백이 거부 뒤에 도착해도 끊긴 세션을 레지스트리에 다시 등록하지 않도록 남겨 두며,
+// 콜백이 처리하거나 재조정에서 세션이 사라졌을 때 지웁니다.
+std::unordered_map<uint32, WorldSession const*> rejectedSessions;
+
+// 세션 레지스트리에서 ip 에 남은 다른 계정의 세션 중 이미 끊긴 것을 제거합니다. (월드 스레드)
+// 세션 종료 훅이 없으므로, 재조정을 기다리지 않고 끊긴 세션이 세션 단계의 동시 접속 수에 남지 않게 합니다.
+static void CloseStaleSessions(IpAddress const& address, uint32 excludeAccountId)
 {
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d");
-    return ss.str();
+    if (!sIpSessionRegistry->GetSessionCount(address, excludeAccountId))
+    {
+        return;
+    }
+
+    for (uint32 accountId : sIpSessionRegistry->GetSessionAccounts(address, excludeAccountId))
+    {
+        WorldSession* session = sWorldSessionMgr->FindSession(accountId);
+        IpAddress live;
+        if (session && IpAddress::Parse(session->GetRemoteAddress(), live) && live == address)
+        {
+            continue;
+        }
+
+        sIpSessionRegistry->OnSessionClosed(accountId);
+    }
 }
 
+// 로그인 기록의 로컬 저장소 (스냅샷 + WAL), IpLimitManager.LocalStore.Enable 일 때 서버 시작 시 만들어집니다.
+std::unique_ptr<LoginHistoryStore> localHistoryStore;
+std::future<void> localSnapshotTask;
+
+// 접속 로그(CSV) 파일명에 사용
+std::string serverStartTime;
+
+// 계정-IP 그래프는 시작 시 account_formation 을 모두 읽어야 하므로 켜기/끄기는 서버 시작 시에만 적용합니다.
+bool accountGraphEnabled = false;
+
+// account_formation_daily 일별 기록도 시작 시 테이블/파티션을 확인한 뒤에만 켭니다.
+bool formationDailyEnabled = false;
+
+// .allowip reload 결과 (DB 조회와 트라이 구성은 별도 스레드에서 하고, 안내는 OnUpdate 에서 합니다.)
+struct AllowListReloadResult
+{
+    bool loaded = false;
+    bool applied = false;       // 거짓이면 다시 읽는 동안 append/remove 로 목록이 바뀌어 적용하지 않음
+    uint32 count = 0;
+    uint32 invalid = 0;
+    uint64 elapsed = 0;         // ns
+    std::string error;
+};
+
+std::future<AllowListReloadResult> allowListReloadTask;
+uint32 allowListReloadRequester = 0;    // 요청한 계정 (콘솔이면 0)
+
+// 로그인 승인(admission) 비동기 쿼리 콜백 처리기
+// AccountScript 훅은 네트워크 스레드에서 호출되므로 등록/처리 모두 잠금으로 보호하며,
+// 콜백은 IpLimitManagerWorldScript::OnUpdate 에서 월드 스레드로 실행됩니다.
+std::mutex admissionCallbackMutex;
+QueryCallbackProcessor admissionCallbacks;
+
+// 접속 로그 파일명에 붙는 서버 시작 시각 (HHMMSS)
 void InitializeServerStartTime()
 {
     auto now = std::chrono::system_clock::now();
@@ -104,106 +185,56 @@ void InitializeServerStartTime()
     serverStartTime = ss.str();
 }
 
-void EnsureLogFileOpen()
+// .iplimit stats 와 주기적 로그에 쓰는 통계 보고서 (한 줄씩)
+static std::vector<std::string> BuildStatsReport()
 {
-    std::string date = GetCurrentDate();
-    if (date != currentLogDate || !csvFile.is_open())
+    std::vector<std::string> lines;
+    auto count = [](IpLimitCounter counter) { return sIpLimitMetrics->GetCounter(counter); };
+
+    lines.push_back(Acore::StringFormat("[IP Limit Manager] 통계 (최근 {}초)", sIpLimitMetrics->GetSecondsSinceReset()));
+    lines.push_back(Acore::StringFormat("판정: 통과 {}, 세션 거부 (빈도 {}, 동시 {}), 입장 후 퇴장 (빈도 {}, 동시 {}), GM 우회 {}",
+        count(IpLimitCounter::ADMISSIONS), count(IpLimitCounter::RATE_LIMIT_REJECTS), count(IpLimitCounter::CONCURRENT_LIMIT_REJECTS),
+        count(IpLimitCounter::RATE_LIMIT_KICKS), count(IpLimitCounter::CONCURRENT_LIMIT_KICKS), count(IpLimitCounter::GM_BYPASSES)));
+    lines.push_back(Acore::StringFormat("상태: 로그인 기록 IP {} (근사 {}, {} KB), 세션 {} (IP {}), 퇴장 예약 {}, 화이트리스트 {}",
+        admissionStorage.TrackedIpCount(), admissionStorage.SketchIpCount(), admissionStorage.MemoryUsage() / 1024, sIpSessionRegistry->GetAccountCount(),
+        sIpSessionRegistry->GetIpCount(), sKickScheduler->GetScheduledCount(), admissionEngine.AllowListSize()));
+    lines.push_back(Acore::StringFormat("시도 폭주: 거부 {} (차단 중 {}), 추적 IP {} ({} KB), 차단 중 IP {} (누적 {}), 기록 대기 {}",
+        count(IpLimitCounter::BURST_REJECTS), count(IpLimitCounter::TEMP_BAN_REJECTS), sBurstLimiter->TrackedIpCount(), sBurstLimiter->MemoryUsage() / 1024,
+        sBurstLimiter->BanCount(admissionClock.Now()), sBurstLimiter->IssuedBanCount(), sBurstLimiter->GetPendingCount()));
+
+    AccountNameCache::Stats nameCache = sAccountNameCache->GetStats();
+    lines.push_back(Acore::StringFormat("기록: CSV {}줄 (버림 {}), 백업 {}행, account_formation 대기 {}, 계정 이름 캐시 {}/{} (적중 {}, 실패 {})",
+        count(IpLimitCounter::ACCESS_LOG_LINES), sAccessLog->GetDroppedCount(), count(IpLimitCounter::BACKUP_ROWS), sAccountFormation->GetPendingCount(),
+        nameCache.size, nameCache.capacity, nameCache.hits, nameCache.misses));
+
+    if (accountGraphEnabled)
     {
-        if (csvFile.is_open())
-        {
-            csvFile.close();
-        }
-        
-        EnsureLogDirectory();
-        // 파일명에 서버 시작 시간 추가
-        std::string filename = "logs/iplimit/access_log_" + date + "_" + serverStartTime + ".csv";
-        bool fileExists = std::filesystem::exists(filename);
-        
-        csvFile.open(filename, std::ios::app);
-        currentLogDate = date;
-        
-        if (!fileExists)
-        {
-            csvFile << "datetime,ip_address,account_id,account_username,action\n";
-        }
+        AccountIpGraph::Stats graph = sAccountIpGraph->GetStats();
+        lines.push_back(Acore::StringFormat("계정-IP 그래프: 계정 {}, IP {}, 연결 {}, 묶음 {} ({} KB)",
+            graph.accounts, graph.ips, graph.links, graph.components, graph.memory / 1024));
     }
-}
 
-void LogAccountAction(uint32 accountId, const std::string& ip, const std::string& action)
-{
-    std::lock_guard<std::mutex> lock(csvMutex);
-    
-    try
-    {
-        // 계정 사용자명 조회
-        std::string username;
-        if (QueryResult result = LoginDatabase.Query("SELECT username FROM account WHERE id = {}", accountId))
-        {
-            username = result->Fetch()[0].Get<std::string>();
-        }
-        else
-        {
-            username = "unknown";
-        }
-        
-        EnsureLogFileOpen();
-        
-        std::string currentDateTime = GetCurrentDateTime();
-        
-        csvFile << currentDateTime << ","
-                << ip << ","
-                << accountId << ","
-                << username << ","
-                << action << std::endl;
-                
-        // 즉시 디스크에 쓰기
-        csvFile.flush();
-    }
-    catch (const std::exception& e)
+    if (!sIpLimitMetrics->IsEnabled())
     {
-        LOG_ERROR("module.iplimit", "Failed to log account action: {}", e.what());
+        lines.push_back("소요 시간 측정이 꺼져 있습니다. (IpLimitManager.Stats.Enable)");
+        return lines;
     }
-}
 
-// IP 유효성 검사 함수
-static bool IsValidIP(const std::string& ip)
-{
-    std::istringstream iss(ip);
-    std::string segment;
-    int segmentCount = 0;
-    
-    while (std::getline(iss, segment, '.'))
+    for (std::size_t i = 0; i < static_cast<std::size_t>(IpLimitTimer::COUNT); ++i)
     {
-        segmentCount++;
-        
-        if (segmentCount > 4)
-            return false;
-
-        if (segment.empty())
-            return false;
-
-        if (segment.find_first_not_of("0123456789") != std::string::npos)
-            return false;
-
-        if (segment.length() > 3)
-            return false;
-
-        try 
-        {
-            int value = std::stoi(segment);
-            if (value < 0 || value > 255)
-                return false;
-
-            if (segment.length() > 1 && segment[0] == '0')
-                return false;
-        }
-        catch (...)
+        IpLimitTimer timer = static_cast<IpLimitTimer>(i);
+        LogLinearHistogram::Summary summary = sIpLimitMetrics->GetTimer(timer);
+        if (!summary.count)
         {
-            return false;
+            continue;
         }
+
+        lines.push_back(Acore::StringFormat("  {}: {}회, 평균 {}, p50 {}, p90 {}, p99 {}, 최대 {}", IpLimitMetrics::GetName(timer), summary.count,
+            IpLimitMetrics::FormatDuration(summary.sum / summary.count), IpLimitMetrics::FormatDuration(summary.p50), IpLimitMetrics::FormatDuration(summary.p90),
+            IpLimitMetrics::FormatDuration(summary.p99), IpLimitMetrics::FormatDuration(summary.max)));
     }
 
-    return segmentCount == 4;
+    return lines;
 }
 
 // 계정 인증 단계에서 IP 체크를 위한 새로운 클래스
@@ -214,35 +245,92 @@ public:
 
     void OnAccountLogin(uint32 accountId) override
     {
-        if (!sConfigMgr->GetOption<bool>("EnableIpLimitManager", true))
+        auto const config = IpLimitConfig::Get();
+
+        if (!config->enabled)
         {
             LOG_DEBUG("module.iplimit", "IpLimitManager disabled in config.");
             return;
         }
 
-        std::string ip;
-        std::string username;
+        IpLimitScopedTimer timer(IpLimitTimer::ACCOUNT_LOGIN);
+        auto issued = std::chrono::steady_clock::now();
+
+        // 새 세션은 같은 계정/IP의 이전 세션이 받은 판정 통과 표시를 물려받지 않습니다.
+        sIpSessionRegistry->OnSessionAuthenticated(accountId);
+
+        // 세션 처리 스레드를 막지 않도록 사용자명/IP/GM 레벨을 한 번의 비동기 쿼리로 조회하고,
+        // 결과는 월드 업데이트에서 ProcessAccountLogin 으로 처리합니다.
+        std::lock_guard<std::mutex> lock(admissionCallbackMutex);
+        admissionCallbacks.AddCallback(LoginDatabase.AsyncQuery(Acore::StringFormat(
+            "SELECT a.username, a.last_ip, aa.gmlevel FROM account a LEFT JOIN account_access aa ON a.id = aa.id WHERE a.id = {}", accountId))
+            .WithCallback([accountId, issued](QueryResult result)
+            {
+                if (sIpLimitMetrics->IsEnabled())
+                {
+                    sIpLimitMetrics->Record(IpLimitTimer::DB_LOGIN_QUERY, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - issued).count());
+                }
+
+                ProcessAccountLogin(accountId, result);
+            }));
+    }
+
+    static void ProcessAccountLogin(uint32 accountId, QueryResult result)
+    {
+        IpLimitScopedTimer timer(IpLimitTimer::ACCOUNT_LOGIN_RESULT);
+
+        if (!result)
+        {
+            return;
+        }
+
+        Field* fields = result->Fetch();
+        std::string username = fields[0].Get<std::string>();
+        std::string ip = fields[1].Get<std::string>();
         uint32 gmlevel = 0;
+        if (!fields[2].IsNull())
+        {
+            gmlevel = fields[2].Get<uint32>();
+        }
 
-        if (QueryResult result = LoginDatabase.Query("SELECT a.username, a.last_ip, aa.gmlevel FROM account a LEFT JOIN account_access aa ON a.id = aa.id WHERE a.id = {}", accountId))
+        IpAddress address;
+        if (!IpAddress::Parse(ip, address))
         {
-            Field* fields = result->Fetch();
-            username = fields[0].Get<std::string>();
-            ip = fields[1].Get<std::string>();
-            if (!fields[2].IsNull())
+            LOG_ERROR("module.iplimit", "IPLimit: 계정 {} 의 IP 주소 형식을 해석할 수 없습니다: {}", accountId, ip);
+            return;
+        }
+
+        // 로그인할 때마다 캐시의 사용자명을 갱신합니다. (이름 변경 반영)
+        sAccountNameCache->Put(accountId, username);
+        sAccessLog->Log(accountId, address, username, AccessAction::LOGIN);
+
+        auto const config = IpLimitConfig::Get();
+
+        // 쿼리를 기다리는 동안 끊겼거나 세션 단계에서 거부된 세션은 등록하지 않습니다.
+        WorldSession* session = sWorldSessionMgr->FindSession(accountId);
+        auto rejected = rejectedSessions.find(accountId);
+        if (rejected != rejectedSessions.end())
+        {
+            bool wasRejected = rejected->second == session;
+            rejectedSessions.erase(rejected);
+            if (wasRejected)
             {
-                gmlevel = fields[2].Get<uint32>();
+                return;
             }
-            LogAccountAction(accountId, ip, "login");
         }
-        else
+
+        if (!session)
         {
             return;
         }
 
-        if (sConfigMgr->GetOption<bool>("IpLimitManager.Bypass.GM.Enable", true))
+        // 접속 중인 세션 등록 (GM 포함, 동시 접속 수 계산에 사용)
+        // 이 세션이 아직 판정받지 않았으면 이전 세션의 판정 통과 표시를 지웁니다.
+        sIpSessionRegistry->OnSessionOpened(accountId, address, SessionKey(session));
+
+        if (config->bypassGMEnable)
         {
-            uint32 minGmLevel = sConfigMgr->GetOption<uint32>("IpLimitManager.Bypass.GM.Level", 3);
+            uint32 minGmLevel = config->bypassGMLevel;
             if (gmlevel >= minGmLevel)
             {
                 LOG_DEBUG("module.iplimit", "Account {} ({}) is a GM (level {}), bypassing IP limit checks in AccountScript.", accountId, username, gmlevel);
@@ -252,76 +340,110 @@ public:
 
         LOG_DEBUG("module.iplimit", "Checking login for account {} (ID: {}) from IP: {}", username, accountId, ip);
 
-        std::lock_guard<std::mutex> lock(ipMutex);
+        // 화이트리스트에 있는 경우 DB 값, 없는 경우 설정 파일 값이 판정 시점에 적용됩니다.
+        IpPrefix matched;
+        IpLimitSettings settings;
+        if (admissionEngine.FindAllowed(address, settings, &matched))
+        {
+            LOG_DEBUG("module.iplimit", "IP {} is in allowed list ({}). Limits: max_conn={}, max_unique={}", ip, matched.ToString(), settings.maxConnections, settings.maxUniqueAccounts);
+        }
+
+        LOG_DEBUG("module.iplimit", "IP {} current connection count: {}", ip, sIpSessionRegistry->GetSessionCount(address));
+    }
+
+    // AccountScript 에는 세션 종료 훅이 없습니다. 끊긴 세션은 ReconcileSessionRegistry 가 레지스트리에서 제거합니다.
+};
 
-        // IP에 적용할 제한 설정
-        uint32 maxConnections;
-        uint32 maxUniqueAccounts;
-        uint32 timeWindow = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.TimeWindowSeconds", 3600);
+// 캐릭터 목록 요청 전 접속 허용 판정
+// 인증된 세션의 첫 캐릭터 목록/입장 요청을 메모리 상태(세션 레지스트리, 로그인 기록)만으로 판정하고,
+// 거부되면 패킷을 처리하지 않고 연결을 끊습니다. 세션마다 한 번만 판정하며 결과는 세션 레지스트리에 남깁니다.
+// 두 요청은 월드 스레드에서 처리되므로, 판정 전에 같은 IP의 다른 세션이 실제로 살아 있는지 WorldSessionMgr 로 확인합니다.
+// IpLimitManager.FriendlyKick.Enable 이면 이 단계를 건너뛰고 월드 입장 후 안내 메시지와 함께 지연 퇴장합니다.
+class IpLimitManager_ServerScript : public ServerScript
+{
+public:
+    IpLimitManager_ServerScript() : ServerScript("IpLimitManager_ServerScript", {
+        SERVERHOOK_CAN_PACKET_RECEIVE
+    }) {}
 
-        auto it = allowedIps.find(ip);
-        if (it != allowedIps.end())
+    bool CanPacketReceive(WorldSession* session, WorldPacket const& packet) override
+    {
+        // 캐릭터 목록을 건너뛰고 바로 입장을 요청하는 클라이언트도 같은 판정을 거칩니다.
+        uint16 opcode = packet.GetOpcode();
+        if (!session || (opcode != CMSG_CHAR_ENUM && opcode != CMSG_PLAYER_LOGIN))
         {
-            // 화이트리스트에 있는 경우: DB 값 사용
-            maxConnections = it->second.maxConnections;
-            maxUniqueAccounts = it->second.maxUniqueAccounts;
-            LOG_DEBUG("module.iplimit", "IP {} is in allowed list. Limits: max_conn={}, max_unique={}", ip, maxConnections, maxUniqueAccounts);
+            return true;
         }
-        else
+
+        auto const config = IpLimitConfig::Get();
+        if (!config->enabled || config->friendlyKickEnable)
         {
-            // 화이트리스트에 없는 경우: 설정 파일 값 사용
-            maxConnections = sConfigMgr->GetOption<uint32>("IpLimitManager.Max.Account", 1);
-            maxUniqueAccounts = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.MaxUniqueAccounts", 1);
+            return true;
         }
 
-        // PlayerScript에서 사용할 수 있도록 최대 연결 수를 저장
-        ipMaxConnectionLimits[ip] = maxConnections;
-
-
+        IpAddress address;
+        if (!IpAddress::Parse(session->GetRemoteAddress(), address))
+        {
+            return true;
+        }
 
-        // --- 2. 동시 접속 제한 ---
-        if (sConfigMgr->GetOption<bool>("IpLimitManager.Max.Account.Enable", true))
+        uint32 accountId = session->GetAccountId();
+        if (config->bypassGMEnable && session->GetSecurity() >= config->bypassGMLevel)
         {
-            ipConnectionCount[ip]++;
-            LOG_DEBUG("module.iplimit", "IP {} current connection count: {}", ip, ipConnectionCount[ip]);
+            // 판정은 건너뛰지만 다른 계정의 동시 접속 수에는 포함됩니다.
+            sIpSessionRegistry->OnSessionOpened(accountId, address, SessionKey(session));
+            return true;
         }
-    }
 
-    void OnAccountLogout(uint32 accountId)
-    {
-        if (!sConfigMgr->GetOption<bool>("EnableIpLimitManager", true))
+        if (sIpSessionRegistry->IsSessionAdmitted(accountId, address, SessionKey(session)))
         {
-            return;
+            return true;
         }
 
-        // 계정의 마지막 알려진 IP 가져오기
-        if (QueryResult result = LoginDatabase.Query("SELECT last_ip FROM account WHERE id = {}", accountId))
+        IpLimitScopedTimer timer(IpLimitTimer::SESSION_ADMISSION);
+        CloseStaleSessions(address, accountId);
+        AdmissionPolicy const policy = MakeAdmissionPolicy(*config);
+        AdmissionDecision const decision = admissionEngine.AdmitSession(policy, accountId, address);
+
+        if (decision.admitted)
         {
-            std::string ip = result->Fetch()[0].Get<std::string>();
+            sIpSessionRegistry->OnSessionAdmitted(accountId, address, SessionKey(session));
+            sIpLimitMetrics->Increment(IpLimitCounter::ADMISSIONS);
 
-            if (!ip.empty())
+            // 통과한 로그인은 엔진이 메모리 기록에 추가하고, 로컬 저장소에는 같은 시각으로 남깁니다.
+            if (config->rateLimitEnable && localHistoryStore)
             {
-                // CSV 로그 기록
-                LogAccountAction(accountId, ip, "logout");
-                
-                if (sConfigMgr->GetOption<bool>("IpLimitManager.Max.Account.Enable", true))
-                {
-                    std::lock_guard<std::mutex> lock(ipMutex);
-                    
-                    if (ipConnectionCount.find(ip) != ipConnectionCount.end())
-                    {
-                        ipConnectionCount[ip]--;
-                        LOG_DEBUG("module.iplimit", "IP {} decremented connection count: {}", ip, ipConnectionCount[ip]);
-
-                        if (ipConnectionCount[ip] <= 0)
-                        {
-                            ipConnectionCount.erase(ip);
-                            LOG_DEBUG("module.iplimit", "IP {} removed from connection count map.", ip);
-                        }
-                    }
-                }
+                localHistoryStore->Append({ address.hi, address.lo, accountId, decision.time });
             }
+
+            return true;
+        }
+
+        sIpLimitMetrics->Increment(KickReasonCounter(decision.reason, AdmissionStage::SESSION));
+        if (decision.reason == KickReason::TEMP_BAN)
+        {
+            LOG_INFO("module.iplimit", "IPLimit: {} ({}, {}초 남음) 로 인해 계정 {} 의 세션을 캐릭터 목록 전에 거부합니다.",
+                address.ToString(), KickReasonText(decision.reason), decision.banUntil - decision.time, accountId);
         }
+        else
+        {
+            LOG_INFO("module.iplimit", "IPLimit: {} ({}, 한도 {}) 로 인해 계정 {} 의 세션을 캐릭터 목록 전에 거부합니다.",
+                address.ToString(), KickReasonText(decision.reason), decision.limit, accountId);
+        }
+
+        // 끊긴 세션이 재조정 전까지 같은 IP의 동시 접속 수에 남지 않도록 바로 해제하고,
+        // 늦게 도착한 인증 쿼리 콜백이 다시 등록하지 않도록 표시합니다.
+        sIpSessionRegistry->OnSessionClosed(accountId);
+        rejectedSessions[accountId] = session;
+        switch (decision.reason)
+        {
+            case KickReason::RATE_LIMIT:  session->KickPlayer("IpLimitManager: login rate limit"); break;
+            case KickReason::BURST_LIMIT: session->KickPlayer("IpLimitManager: login burst limit"); break;
+            case KickReason::TEMP_BAN:    session->KickPlayer("IpLimitManager: temporary ban"); break;
+            default:                      session->KickPlayer("IpLimitManager: concurrent limit"); break;
+        }
+
+        return false;
     }
 };
 
@@ -330,18 +452,30 @@ class IpLimitManager_PlayerScript : public PlayerScript
 public:
     IpLimitManager_PlayerScript() : PlayerScript("IpLimitManager_PlayerScript", { 
         PLAYERHOOK_ON_LOGIN,
-        PLAYERHOOK_ON_UPDATE,
         PLAYERHOOK_ON_LOGOUT
     }) {}
 
     void OnPlayerLogin(Player* player)
     {
-        if (sConfigMgr->GetOption<bool>("IpLimitManager.Bypass.GM.Enable", true))
+        IpLimitScopedTimer timer(IpLimitTimer::PLAYER_LOGIN);
+        auto const config = IpLimitConfig::Get();
+
+        IpAddress playerAddress;
+        bool validAddress = IpAddress::Parse(player->GetSession()->GetRemoteAddress(), playerAddress);
+
+        // 월드 입장 세션 등록 (GM 포함, 동시 접속 수는 자신을 제외하고 계산)
+        if (config->enabled && validAddress)
+        {
+            sIpSessionRegistry->OnPlayerEntered(player->GetSession()->GetAccountId(), playerAddress);
+        }
+
+        if (config->bypassGMEnable)
         {
-            uint32 minGmLevel = sConfigMgr->GetOption<uint32>("IpLimitManager.Bypass.GM.Level", 3);
+            uint32 minGmLevel = config->bypassGMLevel;
             if (player->GetSession()->GetSecurity() >= minGmLevel)
             {
-                if (sConfigMgr->GetOption<bool>("IpLimitManager.Announce.Enable", true))
+                sIpLimitMetrics->Increment(IpLimitCounter::GM_BYPASSES);
+                if (config->announce)
                 {
                     ChatHandler(player->GetSession()).PSendSysMessage("|cff4CFF00[IP Limit Manager]|r GM 계정(레벨 {})은 IP 제한 검사를 우회합니다.", minGmLevel);
                 }
@@ -349,30 +483,26 @@ public:
             }
         }
 
-        if (!sConfigMgr->GetOption<bool>("EnableIpLimitManager", true))
+        if (!config->enabled)
             return;
 
-        std::string playerIp = player->GetSession()->GetRemoteAddress();
+        if (!validAddress)
+        {
+            LOG_ERROR("module.iplimit", "IPLimit: 플레이어 {} 의 IP 주소 형식을 해석할 수 없습니다: {}", player->GetName(), player->GetSession()->GetRemoteAddress());
+            return;
+        }
+
+        std::string playerIp = playerAddress.ToString();
         uint32 accountId = player->GetSession()->GetAccountId();
 
         LOG_DEBUG("module.iplimit", "Player {} (Account: {}) logging in from IP: {}", 
             player->GetName(), accountId, playerIp);
 
-        // IP가 허용 목록에 있는지 확인 (로직 수정: 모든 IP에 대해 중복 접속 확인)
-        {
-            std::lock_guard<std::mutex> lock(ipMutex);
-            auto it = allowedIps.find(playerIp);
-            if (it != allowedIps.end())
-            {
-                LOG_DEBUG("module.iplimit", "IP {} is in allowed list. Checking for duplicate connections.", playerIp);
-            }
-        }
-
         // 모듈 알림 메시지 표시
-        if (sConfigMgr->GetOption<bool>("IpLimitManager.Announce.Enable", true))
+        if (config->announce)
         {
-            bool maxConnEnabled = sConfigMgr->GetOption<bool>("IpLimitManager.Max.Account.Enable", true);
-            bool rateLimitEnabled = sConfigMgr->GetOption<bool>("IpLimitManager.RateLimit.Enable", true);
+            bool maxConnEnabled = config->maxAccountEnable;
+            bool rateLimitEnabled = config->rateLimitEnable;
             std::string msg = "|cff4CFF00[시스템]|r ";
             bool active = false;
 
@@ -398,180 +528,84 @@ public:
             }
         }
 
-        // --- 제한 로직 시작 ---
-        bool kickPlayer = false;
-        KickReason reason = KickReason::CONCURRENT_LIMIT; // 기본값
-        std::string reasonStrForLog;
+        // 세션 단계에서 이미 통과한 경우 다시 판정하지 않습니다. (로그인 기록/통과 횟수도 그때 남김)
+        AdmissionPolicy const policy = MakeAdmissionPolicy(*config);
+        bool sessionAdmitted = !config->friendlyKickEnable && sIpSessionRegistry->IsSessionAdmitted(accountId, playerAddress, SessionKey(player->GetSession()));
 
-        // 1. 고유 계정 로그인 빈도 제한 확인
-        if (sConfigMgr->GetOption<bool>("IpLimitManager.RateLimit.Enable", true))
+        // --- 제한 판정 (빈도 제한 -> 동시 접속 제한), 거부되면 강제 퇴장이 예약됩니다 ---
+        AdmissionDecision decision;
+        if (sessionAdmitted)
         {
-            std::lock_guard<std::mutex> lock(ipMutex);
-            time_t now = GameTime::GetGameTime().count();
-            uint32 timeWindow = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.TimeWindowSeconds", 3600);
-
-            auto& history = ipLoginHistory[playerIp];
-            history.erase(std::remove_if(history.begin(), history.end(),
-                [now, timeWindow](const auto& record) {
-                    return (now - record.second) > timeWindow;
-                }), history.end());
-
-            std::set<uint32> uniqueAccounts;
-            for (const auto& record : history)
-            {
-                uniqueAccounts.insert(record.first);
-            }
-
-            bool isNewAccount = uniqueAccounts.find(accountId) == uniqueAccounts.end();
-            uint32 maxUniqueAccounts = 1;
-            auto it = allowedIps.find(playerIp);
-            if (it != allowedIps.end())
-            {
-                maxUniqueAccounts = it->second.maxUniqueAccounts;
-            }
-            else
-            {
-                maxUniqueAccounts = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.MaxUniqueAccounts", 1);
-            }
-
-            if (isNewAccount && uniqueAccounts.size() >= maxUniqueAccounts)
-            {
-                kickPlayer = true;
-                reason = KickReason::RATE_LIMIT;
-                reasonStrForLog = "로그인 빈도 제한 초과";
-                LOG_INFO("module.iplimit", "IPLimit: IP {} 에서 최근 {}초 동안 허용된 고유 계정 수({})를 초과했습니다.", playerIp, timeWindow, maxUniqueAccounts);
-            }
+            decision.time = admissionClock.Now();
         }
-
-        // 2. 동시 접속 제한 확인 (고유 계정 제한에 걸리지 않은 경우에만)
-        if (!kickPlayer && sConfigMgr->GetOption<bool>("IpLimitManager.Max.Account.Enable", true))
+        else
         {
-            uint32 maxConnections = 1;
-            {
-                std::lock_guard<std::mutex> lock(ipMutex);
-                auto it = ipMaxConnectionLimits.find(playerIp);
-                if (it != ipMaxConnectionLimits.end())
-                {
-                    maxConnections = it->second;
-                }
-                else 
-                {
-                    maxConnections = sConfigMgr->GetOption<uint32>("IpLimitManager.Max.Account", 1);
-                }
-            }
-
-            QueryResult result = CharacterDatabase.Query(
-                "SELECT COUNT(c.guid) FROM characters c "
-                "INNER JOIN acore_auth.account a ON c.account = a.id "
-                "WHERE a.last_ip = '{}' AND c.online = 1",
-                playerIp);
+            decision = admissionEngine.Admit(policy, accountId, playerAddress, player->GetGUID().GetRawValue());
+        }
 
-            if (result)
-            {
-                uint32 onlineCount = result->Fetch()[0].Get<uint32>();
-                if (onlineCount >= maxConnections)
-                {
-                    kickPlayer = true;
-                    reason = KickReason::CONCURRENT_LIMIT;
-                    reasonStrForLog = "동시 접속 제한 초과";
-                }
-            }
+        if (decision.allowListed)
+        {
+            LOG_DEBUG("module.iplimit", "IP {} is in allowed list. Checked with allowed list limits.", playerIp);
         }
 
         // 강제 퇴장 처리
-        if (kickPlayer)
+        if (!decision.admitted)
         {
-            LOG_INFO("module.iplimit", "IPLimit: {} ({}) 로 인해 캐릭터 ({})가 10초 후 강제 퇴장이 예약됩니다.", playerIp, reasonStrForLog, player->GetName());
+            KickReason reason = decision.reason;
+            sIpLimitMetrics->Increment(KickReasonCounter(reason, AdmissionStage::WORLD));
+            std::string reasonStrForLog = KickReasonText(reason);
 
+            if (reason == KickReason::RATE_LIMIT)
             {
-                std::lock_guard<std::mutex> lock(kickMutex);
-                KickInfo kickInfo;
-                kickInfo.accountId = accountId;
-                kickInfo.kickTime = GameTime::GetGameTime().count() + 10;
-                kickInfo.messageSent = false;
-                kickInfo.reason = reason;
-                pendingKicks[player->GetGUID()] = kickInfo;
+                LOG_INFO("module.iplimit", "IPLimit: IP {} 에서 최근 {}초 동안 허용된 고유 계정 수({})를 초과했습니다.", playerIp, policy.rateLimitTimeWindow, decision.limit);
             }
 
+            LOG_INFO("module.iplimit", "IPLimit: {} ({}) 로 인해 캐릭터 ({})가 {}초 후 강제 퇴장이 예약됩니다.", playerIp, reasonStrForLog, player->GetName(), policy.kickDelay);
+
             std::string msg = "|cff4CFF00[시스템]|r 경고: ";
-            if (reason == KickReason::CONCURRENT_LIMIT)
-            {
-                msg += "허용된 최대 동시 접속 수를 초과했습니다.";
-            }
-            else // KickReason::RATE_LIMIT
+            switch (reason)
             {
-                msg += "짧은 시간 내에 너무 많은 계정으로 접속했습니다.";
+                case KickReason::CONCURRENT_LIMIT:
+                    msg += "허용된 최대 동시 접속 수를 초과했습니다.";
+                    break;
+                case KickReason::BURST_LIMIT:
+                    msg += "짧은 시간 내에 너무 자주 접속을 시도했습니다.";
+                    break;
+                case KickReason::TEMP_BAN:
+                    msg += Acore::StringFormat("반복된 접속 시도로 이 IP는 {}초 동안 접속이 제한됩니다.", decision.banUntil - decision.time);
+                    break;
+                default: // KickReason::RATE_LIMIT
+                    msg += "짧은 시간 내에 너무 많은 계정으로 접속했습니다.";
+                    break;
             }
-            msg += " 10초 후 연결이 끊어집니다.";
+            msg += Acore::StringFormat(" {}초 후 연결이 끊어집니다.", policy.kickDelay);
             ChatHandler(player->GetSession()).PSendSysMessage(msg);
         }
-        else 
+        else
         {
-            // 모든 제한을 통과한 경우에만 로그인 기록 추가
-            if (sConfigMgr->GetOption<bool>("IpLimitManager.RateLimit.Enable", true))
+            if (!sessionAdmitted)
             {
-                std::lock_guard<std::mutex> lock(ipMutex);
-                auto& history = ipLoginHistory[playerIp];
-                
-                // 기존에 있던 동일 계정 기록을 삭제
-                history.erase(std::remove_if(history.begin(), history.end(),
-                    [accountId](const auto& record) {
-                        return record.first == accountId;
-                    }), history.end());
-
-                // 새로운 기록 추가
-                history.push_back({accountId, GameTime::GetGameTime().count()});
-            }
+                sIpLimitMetrics->Increment(IpLimitCounter::ADMISSIONS);
 
-            // account_formation에 기록
-            if (sConfigMgr->GetOption<bool>("AccountIpLogger.Enable", true))
-            {
-                if (!player->GetSession()->IsGMAccount() || sConfigMgr->GetOption<bool>("AccountIpLogger.Log.GM.Enable", false))
+                // 통과한 로그인은 엔진이 메모리 기록에 추가하고, 로컬 저장소에는 같은 시각으로 남깁니다.
+                if (config->rateLimitEnable && localHistoryStore)
                 {
-                    LoginDatabase.Execute(
-                        "INSERT INTO account_formation (accountId, ipAddress) VALUES ({}, '{}') "
-                        "ON DUPLICATE KEY UPDATE lastSeen = NOW(), loginCount = loginCount + 1",
-                        accountId, playerIp
-                    );
+                    localHistoryStore->Append({ playerAddress.hi, playerAddress.lo, accountId, decision.time });
                 }
             }
-        }
-    }
-
-    void OnPlayerUpdate(Player* player, uint32 diff)
-    {
-        std::lock_guard<std::mutex> lock(kickMutex);
-        auto it = pendingKicks.find(player->GetGUID());
-        if (it != pendingKicks.end())
-        {
-            uint32 currentTime = GameTime::GetGameTime().count();
-            uint32 remainingTime = it->second.kickTime > currentTime ? it->second.kickTime - currentTime : 0;
-
-            if (remainingTime <= 5 && !it->second.messageSent)
-            {
-                ChatHandler(player->GetSession()).PSendSysMessage("|cff4CFF00[시스템]|r 경고: 5초 후에 연결이 끊어집니다.");
-                it->second.messageSent = true;
-            }
 
-            if (remainingTime == 2) // 2초 남기고 메세지
+            // account_formation에 기록
+            if (config->accountIpLoggerEnable)
             {
-                std::string msg = "|cff4CFF00[시스템]|r ";
-                if (it->second.reason == KickReason::CONCURRENT_LIMIT)
-                {
-                    msg += "최대 동시 접속 제한으로 인해 연결이 끊어졌습니다.";
-                }
-                else // KickReason::RATE_LIMIT
+                if (!player->GetSession()->IsGMAccount() || config->accountIpLoggerLogGM)
                 {
-                    msg += "로그인 빈도 제한으로 인해 연결이 끊어졌습니다.";
+                    // 메모리에 모아 두었다가 OnUpdate 에서 여러 행을 한 번에 기록합니다.
+                    sAccountFormation->Record(accountId, playerAddress, decision.time);
+                    if (accountGraphEnabled)
+                    {
+                        sAccountIpGraph->AddLogin(accountId, playerAddress, decision.time);
+                    }
                 }
-                ChatHandler(player->GetSession()).PSendSysMessage(msg);
-
-                CharacterDatabase.DirectExecute("UPDATE characters SET online = 0 WHERE guid = {}", player->GetGUID().GetCounter());
-                LoginDatabase.DirectExecute("UPDATE account SET online = 0 WHERE id = {}", it->second.accountId);
-
-                player->GetSession()->KickPlayer();
-                
-                pendingKicks.erase(it);
             }
         }
     }
@@ -579,520 +613,1918 @@ public:
     // 캐릭터(플레이어) 종료 시 로그아웃 액션이 CSV에 정상적으로 기록됩니다.
     void OnPlayerLogout(Player* player)
     {
-        if (!sConfigMgr->GetOption<bool>("EnableIpLimitManager", true))
+        auto const config = IpLimitConfig::Get();
+
+        if (!config->enabled)
             return;
 
+        IpLimitScopedTimer timer(IpLimitTimer::PLAYER_LOGOUT);
+
         uint32 accountId = player->GetSession()->GetAccountId();
         std::string playerIp = player->GetSession()->GetRemoteAddress();
 
-        // 로그아웃 액션 기록
-        LogAccountAction(accountId, playerIp, "logout");
+        sIpSessionRegistry->OnPlayerLeft(accountId);
 
-        // 메모리 정리를 위해 맵에서 IP 제거
+        IpAddress playerAddress;
+        if (IpAddress::Parse(playerIp, playerAddress))
         {
-            std::lock_guard<std::mutex> lock(ipMutex);
-            ipMaxConnectionLimits.erase(playerIp);
+            // 로그아웃 액션 기록
+            sAccessLog->Log(accountId, playerAddress, {}, AccessAction::CHARACTER_LOGOUT);
         }
 
         // 강제 퇴장 목록에서 제거
-        {
-            std::lock_guard<std::mutex> lock(kickMutex);
-            pendingKicks.erase(player->GetGUID());
-        }
+        sKickScheduler->Cancel(player->GetGUID().GetRawValue());
     }
 };
 
-class IpLimitManager_CommandScript : public CommandScript
+// account_formation 조회 명령 (.account ip / .ip accounts) 의 페이지 커서 캐시
+// 페이지마다 마지막 행의 (lastSeen, id) 를 기억해 두어, 다음 페이지는 인덱스 범위 읽기 한 번으로 가져옵니다.
+// 같은 페이지를 곧바로 다시 요청하면 DB 조회 없이 이전 출력을 보여줍니다.
+struct FormationPageCursor
 {
-public:
-    IpLimitManager_CommandScript() : CommandScript("IpLimitManager_CommandScript") {}
+    uint32 lastSeen;
+    uint64 id;
+};
 
-    Acore::ChatCommands::ChatCommandTable GetCommands() const override
-    {
-        using namespace Acore::ChatCommands;
+struct FormationPageCache
+{
+    std::string key;                                    // 조회 대상 ("account:<id>" / "ip:<주소>")
+    std::map<uint32, FormationPageCursor> pageEnds;     // 페이지 번호 -> 그 페이지의 마지막 행
+    uint32 page = 0;                                    // 마지막으로 보여준 페이지와 출력
+    std::vector<std::string> lines;
+    std::chrono::steady_clock::time_point used;
+};
 
-        // help string 인자를 제거하여 기본 형태로 수정
-        static ChatCommandTable allowIpCommandTable =
-        {
-            { "append", HandleAddIpCommand, SEC_ADMINISTRATOR, Console::Yes },
-            { "remove", HandleDelIpCommand, SEC_ADMINISTRATOR, Console::Yes },
-            { "show",   HandleShowIpCommand, SEC_ADMINISTRATOR, Console::Yes }
-        };
+// GM 계정 ID -> 캐시
+std::mutex formationPageMutex;
+std::unordered_map<uint32, FormationPageCache> formationPageCaches;
 
-        static ChatCommandTable accountIpCommandTable =
-        {
-            { "ip", HandleAccountIpCommand, SEC_GAMEMASTER, Console::No }
-        };
+// 같은 페이지의 출력을 재사용하는 시간 / 쓰이지 않는 캐시를 정리하는 시간
+constexpr std::chrono::seconds FORMATION_PAGE_REUSE(30);
+constexpr std::chrono::minutes FORMATION_PAGE_EXPIRE(10);
+constexpr uint32 FORMATION_MAX_PAGE = 100000;      // OFFSET 이 지나치게 커지지 않도록 페이지 번호를 제한
 
-        static ChatCommandTable ipAccountsCommandTable =
-        {
-            { "accounts", HandleIpAccountsCommand, SEC_GAMEMASTER, Console::No }
-        };
+// 명령 인자가 ASCII 숫자로만 이루어졌는지 (isdigit 에 음수 char 를 넘기지 않음)
+static bool IsDigits(std::string_view text)
+{
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
 
-        static ChatCommandTable commandTable =
-        {
-            { "allowip", allowIpCommandTable },
-            { "account", accountIpCommandTable },
-            { "ip", ipAccountsCommandTable }
-        };
- 
+struct FormationPageRequest
+{
+    std::string key;
+    std::string columns;        // 공통 열 (id, lastSeen, loginCount) 뒤에 붙는 열
+    std::string source;         // FROM 절
+    std::string filter;         // WHERE 조건
+    bool listIps;               // true: 계정의 IP 목록, false: IP의 계정 목록
+    std::string from;           // 기간 조회 (YYYY-MM-DD, 일별 기록에서 읽음), 비어 있으면 전체 기간
+    std::string to;
+    std::string dailyFilter;    // 일별 기록 조회의 WHERE 조건
+    std::string title;
+    std::string command;        // 다음 페이지 안내에 쓰는 명령 (페이지 번호 제외)
+    uint32 page;
+};
+
+static std::string FormatUnixTime(uint64 time)
+{
+    std::time_t value = static_cast<std::time_t>(time);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &value);
+#else
+    localtime_r(&value, &local);
+#endif
+
+    char buffer[20];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", &local);
+    return buffer;
+}
+
+static void SendLines(WorldSession* session, std::vector<std::string> const& lines)
+{
+    ChatHandler handler(session);
+    for (std::string const& line : lines)
+    {
+        handler.SendSysMessage(line);
+    }
+}
+
+// 명령 인자의 기간을 해석합니다.
+//   30d                    오늘을 포함한 최근 30일
+//   2026-01-01             그날 하루
+//   2026-01-01..2026-01-31 두 날짜 사이 (양 끝 포함)
+static bool ParseFormationRange(std::string const& token, std::string& from, std::string& to)
+{
+    auto parseDate = [](std::string const& text, std::string& out)
+    {
+        unsigned year = 0;
+        unsigned month = 0;
+        unsigned day = 0;
+        char tail = 0;
+        if (text.size() != 10 || std::sscanf(text.c_str(), "%4u-%2u-%2u%c", &year, &month, &day, &tail) != 3 ||
+            year < 1970 || month < 1 || month > 12 || day < 1 || day > 31)
+        {
+            return false;
+        }
+
+        out = Acore::StringFormat("{:04}-{:02}-{:02}", year, month, day);
+        return true;
+    };
+
+    if (token.size() > 1 && token.back() == 'd' && IsDigits(std::string_view(token).substr(0, token.size() - 1)))
+    {
+        uint32 days = std::clamp<uint32>(std::strtoul(token.c_str(), nullptr, 10), 1, 3660);
+        std::time_t now = std::time(nullptr);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        char buffer[16];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &local);
+        to = buffer;
+
+        local.tm_mday -= static_cast<int>(days - 1);
+        local.tm_isdst = -1;
+        std::time_t start = std::mktime(&local);
+#ifdef _WIN32
+        localtime_s(&local, &start);
+#else
+        localtime_r(&start, &local);
+#endif
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &local);
+        from = buffer;
+        return true;
+    }
+
+    std::size_t separator = token.find("..");
+    if (separator == std::string::npos)
+    {
+        return parseDate(token, from) && parseDate(token, to);
+    }
+
+    return parseDate(token.substr(0, separator), from) && parseDate(token.substr(separator + 2), to) && from <= to;
+}
+
+// 기간 조회: 일별 기록을 (IP 또는 계정) 별로 합쳐 최근 날짜 순으로 보여줍니다.
+// 날짜 조건으로 파티션이 걸러지므로 기간에 해당하는 파티션만 읽습니다.
+static void ShowFormationRangePage(WorldSession* session, FormationPageRequest request)
+{
+    uint32 pageSize = IpLimitConfig::Get()->accountIpLoggerPageSize;
+
+    static char const* const AGGREGATE = "CAST(SUM(d.loginCount) AS UNSIGNED) AS logins, DATE_FORMAT(MIN(d.day), '%Y-%m-%d'), DATE_FORMAT(MAX(d.day), '%Y-%m-%d')";
+    std::string sql = request.listIps
+        ? Acore::StringFormat("SELECT d.ipAddress, {} FROM account_formation_daily d WHERE {} AND d.day BETWEEN '{}' AND '{}' "
+            "GROUP BY d.ipAddress", AGGREGATE, request.dailyFilter, request.from, request.to)
+        : Acore::StringFormat("SELECT d.accountId, {}, a.username FROM account_formation_daily d LEFT JOIN account a ON a.id = d.accountId "
+            "WHERE {} AND d.day BETWEEN '{}' AND '{}' GROUP BY d.accountId, a.username", AGGREGATE, request.dailyFilter, request.from, request.to);
+
+    // 다음 페이지가 있는지 알기 위해 한 행을 더 읽습니다.
+    sql += Acore::StringFormat(" ORDER BY MAX(d.day) DESC, logins DESC LIMIT {} OFFSET {}", pageSize + 1, uint64(request.page - 1) * pageSize);
+
+    auto issued = std::chrono::steady_clock::now();
+    session->GetQueryProcessor().AddCallback(LoginDatabase.AsyncQuery(sql).WithCallback([session, pageSize, issued, request = std::move(request)](QueryResult result)
+    {
+        if (sIpLimitMetrics->IsEnabled())
+        {
+            sIpLimitMetrics->Record(IpLimitTimer::DB_COMMAND_QUERY, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - issued).count());
+        }
+
+        std::vector<std::string> lines;
+        lines.push_back(Acore::StringFormat("{} ({} ~ {}) - page {}", request.title, request.from, request.to, request.page));
+
+        uint32 rows = 0;
+        bool hasMore = false;
+        if (result)
+        {
+            do
+            {
+                if (rows == pageSize)
+                {
+                    hasMore = true;
+                    break;
+                }
+
+                Field* fields = result->Fetch();
+                uint64 logins = fields[1].Get<uint64>();
+                std::string days = fields[2].Get<std::string>() + " ~ " + fields[3].Get<std::string>();
+
+                if (request.listIps)
+                {
+                    lines.push_back(Acore::StringFormat("  {} | {} | {} logins", fields[0].Get<std::string>(), days, logins));
+                }
+                else
+                {
+                    uint32 accountId = fields[0].Get<uint32>();
+                    std::string accountName = fields[4].IsNull() ? "Unknown" : fields[4].Get<std::string>();
+                    if (!fields[4].IsNull())
+                    {
+                        sAccountNameCache->Put(accountId, accountName);
+                    }
+
+                    lines.push_back(Acore::StringFormat("  {} (ID {}) | {} | {} logins", accountName, accountId, days, logins));
+                }
+
+                ++rows;
+            } while (result->NextRow());
+        }
+
+        if (!rows)
+        {
+            lines.push_back(request.page == 1 ? "  No records found." : "  No more records.");
+        }
+        else if (hasMore)
+        {
+            lines.push_back(Acore::StringFormat("Next page: {} {}..{} {}", request.command, request.from, request.to, request.page + 1));
+        }
+
+        SendLines(session, lines);
+    }));
+}
+
+// 한 페이지를 비동기로 조회해 한 줄에 한 행씩 보여줍니다.
+// 콜백은 GM 세션의 쿼리 처리기에 등록되므로 세션이 먼저 사라지면 함께 버려집니다.
+static void ShowFormationPage(WorldSession* session, FormationPageRequest request)
+{
+    if (!request.from.empty())
+    {
+        ShowFormationRangePage(session, std::move(request));
+        return;
+    }
+
+    uint32 gmAccountId = session->GetAccountId();
+    uint32 pageSize = IpLimitConfig::Get()->accountIpLoggerPageSize;
+    std::string range;
+
+    {
+        std::lock_guard<std::mutex> lock(formationPageMutex);
+        auto now = std::chrono::steady_clock::now();
+
+        std::erase_if(formationPageCaches, [now](auto const& entry) { return now - entry.second.used > FORMATION_PAGE_EXPIRE; });
+
+        FormationPageCache& cache = formationPageCaches[gmAccountId];
+        if (cache.key != request.key)
+        {
+            cache = FormationPageCache();
+            cache.key = request.key;
+        }
+        else if (cache.page == request.page && !cache.lines.empty() && now - cache.used < FORMATION_PAGE_REUSE)
+        {
+            SendLines(session, cache.lines);
+            return;
+        }
+
+        cache.used = now;
+
+        // 앞 페이지의 커서가 있으면 keyset, 처음 건너뛰는 페이지는 OFFSET 으로 읽습니다.
+        if (request.page > 1)
+        {
+            auto cursor = cache.pageEnds.find(request.page - 1);
+            if (cursor != cache.pageEnds.end())
+            {
+                range = Acore::StringFormat(" AND (f.lastSeen < FROM_UNIXTIME({0}) OR (f.lastSeen = FROM_UNIXTIME({0}) AND f.id < {1}))", cursor->second.lastSeen, cursor->second.id);
+            }
+        }
+    }
+
+    uint64 offset = range.empty() && request.page > 1 ? uint64(request.page - 1) * pageSize : 0;
+
+    // 다음 페이지가 있는지 알기 위해 한 행을 더 읽습니다.
+    std::string sql = Acore::StringFormat("SELECT f.id, UNIX_TIMESTAMP(f.lastSeen), f.loginCount, {} FROM {} WHERE {}{} ORDER BY f.lastSeen DESC, f.id DESC LIMIT {}",
+        request.columns, request.source, request.filter, range, pageSize + 1);
+    if (offset)
+    {
+        sql += Acore::StringFormat(" OFFSET {}", offset);
+    }
+
+    auto issued = std::chrono::steady_clock::now();
+    session->GetQueryProcessor().AddCallback(LoginDatabase.AsyncQuery(sql).WithCallback([session, gmAccountId, pageSize, issued, request = std::move(request)](QueryResult result)
+    {
+        if (sIpLimitMetrics->IsEnabled())
+        {
+            sIpLimitMetrics->Record(IpLimitTimer::DB_COMMAND_QUERY, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - issued).count());
+        }
+
+        std::vector<std::string> lines;
+        lines.push_back(Acore::StringFormat("{} - page {}", request.title, request.page));
+
+        uint32 rows = 0;
+        bool hasMore = false;
+        FormationPageCursor last{};
+        if (result)
+        {
+            do
+            {
+                if (rows == pageSize)
+                {
+                    hasMore = true;
+                    break;
+                }
+
+                Field* fields = result->Fetch();
+                last = { static_cast<uint32>(fields[1].Get<uint64>()), fields[0].Get<uint64>() };
+                std::string lastSeen = FormatUnixTime(fields[1].Get<uint64>());
+                uint32 loginCount = fields[2].Get<uint32>();
+
+                if (request.listIps)
+                {
+                    lines.push_back(Acore::StringFormat("  {} | last {} | first {} | {} logins",
+                        fields[3].Get<std::string>(), lastSeen, FormatUnixTime(fields[4].Get<uint64>()), loginCount));
+                }
+                else
+                {
+                    uint32 accountId = fields[3].Get<uint32>();
+                    std::string accountName = fields[4].IsNull() ? "Unknown" : fields[4].Get<std::string>();
+                    if (!fields[4].IsNull())
+                    {
+                        sAccountNameCache->Put(accountId, accountName);
+                    }
+
+                    lines.push_back(Acore::StringFormat("  {} (ID {}) | last {} | {} logins", accountName, accountId, lastSeen, loginCount));
+                }
+
+                ++rows;
+            } while (result->NextRow());
+        }
+
+        if (!rows)
+        {
+            lines.push_back(request.page == 1 ? "  No records found." : "  No more records.");
+        }
+        else if (hasMore)
+        {
+            lines.push_back(Acore::StringFormat("Next page: {} {}", request.command, request.page + 1));
+        }
+
+        SendLines(session, lines);
+
+        std::lock_guard<std::mutex> lock(formationPageMutex);
+        auto cache = formationPageCaches.find(gmAccountId);
+        if (cache != formationPageCaches.end() && cache->second.key == request.key)
+        {
+            cache->second.page = request.page;
+            cache->second.lines = std::move(lines);
+            cache->second.used = std::chrono::steady_clock::now();
+            if (hasMore)
+            {
+                cache->second.pageEnds[request.page] = last;
+            }
+        }
+    }));
+}
+
+bool BuildAllowListFromDB(AdmissionEngine::AllowList& allowList, uint32& count, uint32& invalid, std::string& error);
+
+class IpLimitManager_CommandScript : public CommandScript
+{
+public:
+    IpLimitManager_CommandScript() : CommandScript("IpLimitManager_CommandScript") {}
+
+    Acore::ChatCommands::ChatCommandTable GetCommands() const override
+    {
+        using namespace Acore::ChatCommands;
+
+        // help string 인자를 제거하여 기본 형태로 수정
+        static ChatCommandTable allowIpCommandTable =
+        {
+            { "append", HandleAddIpCommand, SEC_ADMINISTRATOR, Console::Yes },
+            { "remove", HandleDelIpCommand, SEC_ADMINISTRATOR, Console::Yes },
+            { "show",   HandleShowIpCommand, SEC_ADMINISTRATOR, Console::Yes },
+            { "reload", HandleReloadIpCommand, SEC_ADMINISTRATOR, Console::Yes }
+        };
+
+        static ChatCommandTable accountIpCommandTable =
+        {
+            { "ip", HandleAccountIpCommand, SEC_GAMEMASTER, Console::No }
+        };
+
+        static ChatCommandTable ipAccountsCommandTable =
+        {
+            { "accounts", HandleIpAccountsCommand, SEC_GAMEMASTER, Console::No },
+            { "cluster",  HandleIpClusterCommand,  SEC_GAMEMASTER, Console::Yes },
+            { "unban",    HandleIpUnbanCommand,    SEC_ADMINISTRATOR, Console::Yes }
+        };
+
+        static ChatCommandTable ipLimitCommandTable =
+        {
+            { "stats", HandleStatsCommand, SEC_ADMINISTRATOR, Console::Yes }
+        };
+
+        static ChatCommandTable commandTable =
+        {
+            { "iplimit", ipLimitCommandTable },
+            { "allowip", allowIpCommandTable },
+            { "account", accountIpCommandTable },
+            { "ip", ipAccountsCommandTable }
+        };
+ 
         return commandTable;
     }
 
-    static bool HandleAccountIpCommand(ChatHandler* handler, const std::string& args)
+    // .iplimit stats [reset]
+    static bool HandleStatsCommand(ChatHandler* handler, std::string const& args)
     {
-        if (args.empty())
+        for (std::string const& line : BuildStatsReport())
+        {
+            handler->PSendSysMessage(line);
+        }
+
+        if (args == "reset")
+        {
+            sIpLimitMetrics->Reset();
+            handler->PSendSysMessage("통계를 초기화했습니다.");
+        }
+
+        return true;
+    }
+
+    // 이름/IP 뒤의 인자 (페이지 번호, 기간) 를 순서와 관계없이 읽습니다.
+    static bool ParseFormationOptions(ChatHandler* handler, std::stringstream& ss, FormationPageRequest& request)
+    {
+        request.page = 1;
+
+        std::string token;
+        while (ss >> token)
+        {
+            if (IsDigits(token))
+            {
+                uint64 page = token.size() <= 6 ? std::strtoull(token.c_str(), nullptr, 10) : 0;
+                if (page < 1 || page > FORMATION_MAX_PAGE)
+                {
+                    handler->PSendSysMessage("Invalid page '{}'. Use 1 to {}.", token, FORMATION_MAX_PAGE);
+                    return false;
+                }
+
+                request.page = static_cast<uint32>(page);
+            }
+            else if (!ParseFormationRange(token, request.from, request.to))
+            {
+                handler->PSendSysMessage("Invalid page or range '{}'. Use 30d, 2026-01-01 or 2026-01-01..2026-01-31.", token);
+                return false;
+            }
+        }
+
+        if (!request.from.empty() && !formationDailyEnabled)
         {
-            handler->SendSysMessage("Usage: .account ip <CharacterName>");
+            handler->SendSysMessage("Daily rollups are disabled, time ranges are not available. (AccountIpLogger.Daily.Enable)");
             return false;
         }
 
-        std::string characterName = args;
-        uint32 accountId = 0;
-        ObjectGuid playerGuid;
+        return true;
+    }
+
+    // .account ip <캐릭터이름> [페이지] [기간]
+    static bool HandleAccountIpCommand(ChatHandler* handler, const std::string& args)
+    {
+        std::string characterName;
+        std::stringstream ss(args);
+        ss >> characterName;
 
-        // Find account and guid from character name
-        QueryResult charResult = CharacterDatabase.Query("SELECT guid, account FROM characters WHERE name = '{}'", characterName);
-        if (charResult)
+        if (characterName.empty() || !handler->GetSession())
         {
-            Field* fields = charResult->Fetch();
-            playerGuid = ObjectGuid::Create<HighGuid::Player>(fields[0].Get<uint32>());
-            accountId = fields[1].Get<uint32>();
+            handler->SendSysMessage("Usage: .account ip <CharacterName> [page] [30d|YYYY-MM-DD[..YYYY-MM-DD]]");
+            return false;
         }
-        else
+
+        FormationPageRequest request;
+        if (!ParseFormationOptions(handler, ss, request))
         {
-            handler->PSendSysMessage("Player '%s' not found.", characterName.c_str());
             return false;
         }
 
+        // 캐릭터 캐시에서 계정을 찾습니다. (DB 조회 없음)
+        uint32 accountId = normalizePlayerName(characterName) ? sCharacterCache->GetCharacterAccountIdByName(characterName) : 0;
         if (!accountId)
         {
-            handler->PSendSysMessage("Could not find account for player '%s'.", characterName.c_str());
+            handler->PSendSysMessage("Player '{}' not found.", characterName);
             return false;
         }
 
-        QueryResult result = LoginDatabase.Query("SELECT ipAddress, firstSeen, lastSeen, loginCount FROM account_formation WHERE accountId = {} ORDER BY lastSeen DESC", accountId);
+        request.key = Acore::StringFormat("account:{}", accountId);
+        request.columns = "f.ipAddress, UNIX_TIMESTAMP(f.firstSeen)";
+        request.source = "account_formation f";
+        request.filter = Acore::StringFormat("f.accountId = {}", accountId);
+        request.dailyFilter = Acore::StringFormat("d.accountId = {}", accountId);
+        request.listIps = true;
+        request.title = Acore::StringFormat("IP history for account of {} (ID: {})", characterName, accountId);
+        request.command = ".account ip " + characterName;
 
-        if (!result)
+        ShowFormationPage(handler->GetSession(), std::move(request));
+        return true;
+    }
+
+    // .ip accounts <IP주소> [페이지] [기간]
+    static bool HandleIpAccountsCommand(ChatHandler* handler, const std::string& args)
+    {
+        std::string ip;
+        std::stringstream ss(args);
+        ss >> ip;
+
+        if (ip.empty() || !handler->GetSession())
         {
-            handler->PSendSysMessage("No IP information found for account of player '%s'.", characterName.c_str());
-            return true;
+            handler->SendSysMessage("Usage: .ip accounts <IPAddress> [page] [30d|YYYY-MM-DD[..YYYY-MM-DD]]");
+            return false;
         }
 
-        handler->PSendSysMessage("IP History for account of %s (ID: %u):", characterName.c_str(), accountId);
-        handler->SendSysMessage("-------------------------------------------------");
+        FormationPageRequest request;
+        if (!ParseFormationOptions(handler, ss, request))
+        {
+            return false;
+        }
 
-        do
+        IpAddress address;
+        if (!IpAddress::Parse(ip, address))
         {
-            Field* fields = result->Fetch();
-            std::string ip = fields[0].Get<std::string>();
-            std::string firstSeen = fields[1].Get<std::string>();
-            std::string lastSeen = fields[2].Get<std::string>();
-            uint32 count = fields[3].Get<uint32>();
+            handler->PSendSysMessage("Invalid IP address '{}'.", ip);
+            return false;
+        }
 
-            handler->PSendSysMessage("IP: %s", ip.c_str());
-            handler->PSendSysMessage("  First Seen: %s", firstSeen.c_str());
-            handler->PSendSysMessage("  Last Seen:  %s", lastSeen.c_str());
-            handler->PSendSysMessage("  Login Count: %u", count);
+        // 계정 이름은 같은 쿼리에서 함께 읽습니다.
+        std::string ipAddress = address.ToString();
+        request.key = "ip:" + ipAddress;
+        request.columns = "f.accountId, a.username";
+        request.source = "account_formation f LEFT JOIN account a ON a.id = f.accountId";
+        request.filter = Acore::StringFormat("f.ipAddress = '{}'", ipAddress);
+        request.dailyFilter = Acore::StringFormat("d.ipAddress = '{}'", ipAddress);
+        request.listIps = false;
+        request.title = "Account history for IP " + ipAddress;
+        request.command = ".ip accounts " + ipAddress;
+
+        ShowFormationPage(handler->GetSession(), std::move(request));
+        return true;
+    }
 
-        } while (result->NextRow());
-        
-        handler->SendSysMessage("-------------------------------------------------");
+    // .ip unban <IP주소> - 임시 차단과 차단 단계를 초기화합니다.
+    static bool HandleIpUnbanCommand(ChatHandler* handler, std::string const& args)
+    {
+        IpAddress address;
+        if (args.empty() || !IpAddress::Parse(args, address))
+        {
+            handler->SendSysMessage("사용법: .ip unban <IP주소>");
+            return false;
+        }
+
+        // DB 행은 다음 임시 차단 기록 때 함께 지웁니다.
+        if (sBurstLimiter->Unban(address, admissionClock.Now()))
+        {
+            handler->PSendSysMessage("IP {} 의 임시 차단을 해제했습니다.", address.ToString());
+        }
+        else
+        {
+            handler->PSendSysMessage("IP {} 는 임시 차단 중이 아닙니다. (차단 단계는 초기화했습니다)", address.ToString());
+        }
 
         return true;
     }
 
-    static bool HandleIpAccountsCommand(ChatHandler* handler, const std::string& args)
+    // .ip cluster <IP주소|캐릭터이름> [페이지]
+    // 메모리 그래프에서 서로 이어진 계정/IP 전체를 로그인 횟수 순으로 보여줍니다. (DB 조회 없음)
+    static bool HandleIpClusterCommand(ChatHandler* handler, std::string const& args)
     {
-        if (args.empty())
+        std::string target;
+        uint32 page = 1;
+        std::stringstream ss(args);
+        ss >> target >> page;
+
+        if (target.empty())
         {
-            handler->SendSysMessage("Usage: .ip accounts <IPAddress>");
+            handler->SendSysMessage("Usage: .ip cluster <IPAddress|CharacterName> [page]");
             return false;
         }
 
-        std::string ipAddress = args;
-        QueryResult result = LoginDatabase.Query("SELECT accountId, lastSeen, loginCount FROM account_formation WHERE ipAddress = '{}' ORDER BY lastSeen DESC", ipAddress);
+        if (!accountGraphEnabled)
+        {
+            handler->SendSysMessage("Account-IP graph is disabled. (AccountIpLogger.Graph.Enable)");
+            return false;
+        }
 
-        if (!result)
+        auto start = std::chrono::steady_clock::now();
+        AccountIpGraph::Cluster cluster;
+        std::string title;
+        bool found = false;
+
+        IpAddress address;
+        if (IpAddress::Parse(target, address))
+        {
+            title = "IP " + address.ToString();
+            found = sAccountIpGraph->FindByIp(address, cluster);
+        }
+        else
+        {
+            std::string characterName = target;
+            uint32 accountId = normalizePlayerName(characterName) ? sCharacterCache->GetCharacterAccountIdByName(characterName) : 0;
+            if (!accountId)
+            {
+                handler->PSendSysMessage("Player '{}' not found.", target);
+                return false;
+            }
+
+            title = Acore::StringFormat("account of {} (ID: {})", characterName, accountId);
+            found = sAccountIpGraph->FindByAccount(accountId, cluster);
+        }
+
+        uint64 elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (!found)
         {
-            handler->PSendSysMessage("No accounts found for IP address '%s'.", ipAddress.c_str());
+            handler->PSendSysMessage("No recorded logins for {}.", title);
             return true;
         }
 
-        handler->PSendSysMessage("Account History for IP: %s", ipAddress.c_str());
-        handler->SendSysMessage("-------------------------------------------------");
+        uint32 pageSize = IpLimitConfig::Get()->accountIpLoggerPageSize;
+        uint32 pages = static_cast<uint32>((cluster.members.size() + pageSize - 1) / pageSize);
+        page = std::clamp<uint32>(page, 1, pages);
+
+        handler->PSendSysMessage("Cluster of {}: {} accounts, {} IPs, {} links ({}) - page {}/{}",
+            title, cluster.accounts, cluster.ips, cluster.links, IpLimitMetrics::FormatDuration(elapsed), page, pages);
+
+        std::string accountName;
+        std::size_t end = std::min<std::size_t>(cluster.members.size(), std::size_t(page) * pageSize);
+        for (std::size_t i = std::size_t(page - 1) * pageSize; i < end; ++i)
+        {
+            AccountIpGraph::Member const& member = cluster.members[i];
+            if (member.isAccount)
+            {
+                if (!sAccountNameCache->Get(member.accountId, accountName))
+                {
+                    accountName = "Unknown";
+                }
+
+                handler->PSendSysMessage("  account {} (ID {}) | last {} | {} logins | {} IPs",
+                    accountName, member.accountId, FormatUnixTime(member.lastSeen), member.logins, member.degree);
+            }
+            else
+            {
+                handler->PSendSysMessage("  ip {} | last {} | {} logins | {} accounts",
+                    member.ip.ToString(), FormatUnixTime(member.lastSeen), member.logins, member.degree);
+            }
+        }
+
+        if (page < pages)
+        {
+            handler->PSendSysMessage("Next page: .ip cluster {} {}", target, page + 1);
+        }
+
+        return true;
+    }
+
+    static bool HandleAddIpCommand(ChatHandler* handler, std::string const& args)
+    {
+        if (args.empty())
+        {
+            handler->PSendSysMessage("사용법: .allowip append <ip|cidr> [max_conn] [max_unique]");
+            handler->PSendSysMessage("예시: .allowip append 192.168.1.1 3 5");
+            handler->PSendSysMessage("예시: .allowip append 203.0.113.0/24 10 10");
+            return false;
+        }
+
+        std::stringstream ss(args);
+        std::string ip;
+        uint32 max_connections = 2; // 기본값
+        uint32 max_unique_accounts = 1; // 기본값
+
+        ss >> ip;
+        ss >> max_connections;
+        ss >> max_unique_accounts;
+        
+        IpPrefix prefix;
+        if (!IpPrefix::Parse(ip, prefix))
+        {
+            handler->PSendSysMessage("오류: 잘못된 IP 주소 형식입니다. IPv4/IPv6 주소 또는 CIDR(예: 10.0.0.0/24) 형식을 사용해주세요.");
+            return false;
+        }
+
+        // DB에는 정규화된 표기로 저장 (호스트 비트는 0으로 정리)
+        ip = prefix.ToString();
+
+        // IP가 이미 존재하는지 확인
+        QueryResult checkResult = MeasureTime(IpLimitTimer::DB_COMMAND_QUERY, [&] { return LoginDatabase.Query("SELECT 1 FROM custom_allowed_ips WHERE ip = '{}'", ip); });
+        if (checkResult)
+        {
+            handler->PSendSysMessage("오류: IP {} 는 이미 허용 목록에 존재합니다.", ip);
+            return false;
+        }
+
+        // .allowip reload 가 바로 뒤에 실행되어도 이 변경을 읽도록 동기로 기록합니다.
+        LoginDatabase.DirectExecute("INSERT INTO custom_allowed_ips (ip, max_connections, max_unique_accounts) VALUES ('{}', {}, {})", ip, max_connections, max_unique_accounts);
+        admissionEngine.AllowListInsert(prefix, {max_connections, max_unique_accounts});
+        handler->PSendSysMessage("IP {} 가 허용 목록에 추가되었습니다. (최대 접속: {}, 최대 고유 계정: {})", ip, max_connections, max_unique_accounts);
+        return true;
+    }
+
+    static bool HandleDelIpCommand(ChatHandler* handler, std::string const& args)
+    {
+        if (args.empty())
+        {
+            handler->PSendSysMessage("사용법: .allowip remove <ip|cidr>");
+            handler->PSendSysMessage("예시: .allowip remove 192.168.1.1");
+            return false;
+        }
+
+        std::string ip = args;
+
+        IpPrefix prefix;
+        if (!IpPrefix::Parse(ip, prefix))
+        {
+            handler->PSendSysMessage("오류: 잘못된 IP 주소 형식입니다. IPv4/IPv6 주소 또는 CIDR(예: 10.0.0.0/24) 형식을 사용해주세요.");
+            return false;
+        }
+
+        ip = prefix.ToString();
+
+        // IP가 존재하는지 확인
+        QueryResult checkResult = MeasureTime(IpLimitTimer::DB_COMMAND_QUERY, [&] { return LoginDatabase.Query("SELECT 1 FROM custom_allowed_ips WHERE ip = '{}'", ip); });
+        if (!checkResult)
+        {
+            handler->PSendSysMessage("오류: IP {} 는 허용 목록에 존재하지 않습니다.", ip);
+            return false;
+        }
+
+        LoginDatabase.DirectExecute("DELETE FROM custom_allowed_ips WHERE ip = '{}'", ip);
+        admissionEngine.AllowListErase(prefix);
+        handler->PSendSysMessage("IP {} 가 허용 목록에서 제거되었습니다.", ip);
+        return true;
+    }
+
+    static bool HandleShowIpCommand(ChatHandler* handler, std::string const& args)
+    {
+        // 테이블 존재 여부 먼저 확인
+        QueryResult tableCheck = MeasureTime(IpLimitTimer::DB_COMMAND_QUERY, [&] { return LoginDatabase.Query("SHOW TABLES LIKE 'custom_allowed_ips'"); });
+        if (!tableCheck)
+        {
+            handler->PSendSysMessage("|cFFFF0000오류:|r custom_allowed_ips 테이블이 존재하지 않습니다.");
+            LOG_ERROR("module.iplimit", "custom_allowed_ips 테이블이 존재하지 않음");
+            return false;
+        }
+
+        QueryResult result = MeasureTime(IpLimitTimer::DB_COMMAND_QUERY, [&] { return LoginDatabase.Query("SELECT ip, description, max_connections, max_unique_accounts FROM custom_allowed_ips"); });
+
+        if (!result)
+        {
+            handler->PSendSysMessage("|cFF00FFFF알림:|r 허용된 IP 목록이 비어있습니다.");
+            return true;
+        }
+
+        handler->PSendSysMessage("|cFF00FF00=== 허용된 IP 목록 ===|r");
+        handler->PSendSysMessage("-----------------------------------------------------------------");
+        handler->PSendSysMessage("|cFFFFFF00IP 주소           최대접속   최대고유계정   설명|r");
+        handler->PSendSysMessage("-----------------------------------------------------------------");
+
+        uint32 count = 0;
+        do
+        {
+            Field* fields = result->Fetch();
+
+            std::string ip = fields[0].Get<std::string>();
+            std::string desc = fields[1].Get<std::string>();
+            uint32 max_connections = fields[2].Get<uint32>();
+            uint32 max_unique_accounts = fields[3].Get<uint32>();
+
+            std::string paddedIp = ip;
+            while (paddedIp.length() < 18)
+                paddedIp += " ";
+
+            handler->PSendSysMessage("|cFFFFFF00{}|r  |cFFFF0000{:>2}|r         |cFF00FFFF{:>2}|r            {}", paddedIp, max_connections, max_unique_accounts, desc);
+            count++;
+        } while (result->NextRow());
+
+        handler->PSendSysMessage("-----------------------------------------------------------------");
+        handler->PSendSysMessage("총 |cFF00FF00{}|r개의 IP가 등록되어 있습니다.", count);
+
+        return true;
+    }
+
+    // .allowip reload - SQL 로 직접 고친 custom_allowed_ips 를 재시작 없이 반영합니다.
+    // 새 목록은 별도 스레드에서 만들고, 판정은 그동안 이전 목록으로 계속됩니다.
+    static bool HandleReloadIpCommand(ChatHandler* handler, std::string const& /*args*/)
+    {
+        if (allowListReloadTask.valid())
+        {
+            handler->PSendSysMessage("허용 목록을 이미 다시 읽는 중입니다. 잠시 후 다시 시도해주세요.");
+            return false;
+        }
+
+        allowListReloadRequester = handler->GetSession() ? handler->GetSession()->GetAccountId() : 0;
+        uint64 version = admissionEngine.AllowListVersion();
+
+        allowListReloadTask = std::async(std::launch::async, [version]()
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            AllowListReloadResult result;
+            AdmissionEngine::AllowList loaded;
+            try
+            {
+                result.loaded = BuildAllowListFromDB(loaded, result.count, result.invalid, result.error);
+            }
+            catch (const std::exception& e)
+            {
+                result.error = e.what();
+            }
+
+            if (result.loaded)
+            {
+                result.applied = admissionEngine.ReplaceAllowList(std::move(loaded), version);
+            }
+
+            result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        });
+
+        handler->PSendSysMessage("custom_allowed_ips 에서 허용 목록을 다시 읽습니다. 완료되면 알려드립니다.");
+        return true;
+    }
+};
+
+// custom_allowed_ips 를 읽어 새 화이트리스트를 만듭니다. 월드 스레드 밖(.allowip reload)에서도 호출됩니다.
+bool BuildAllowListFromDB(AdmissionEngine::AllowList& allowList, uint32& count, uint32& invalid, std::string& error)
+{
+    QueryResult checkTable = LoginDatabase.Query("SHOW TABLES LIKE 'custom_allowed_ips'");
+    if (!checkTable)
+    {
+        error = "`custom_allowed_ips` 테이블이 존재하지 않습니다. SQL 파일을 DB에 임포트해주세요.";
+        return false;
+    }
+
+    QueryResult result = LoginDatabase.Query("SELECT ip, max_connections, max_unique_accounts FROM custom_allowed_ips");
+    count = 0;
+    invalid = 0;
+
+    if (!result)
+    {
+        return true;
+    }
+
+    do
+    {
+        Field* fields = result->Fetch();
+        std::string ip = fields[0].Get<std::string>();
+        uint32 max_connections = fields[1].Get<uint32>();
+        uint32 max_unique_accounts = fields[2].Get<uint32>();
+
+        IpPrefix prefix;
+        if (!ip.empty() && IpPrefix::Parse(ip, prefix))
+        {
+            allowList.Insert(prefix, {max_connections, max_unique_accounts});
+            ++count;
+            LOG_DEBUG("module.iplimit", "허용된 IP 로드: {} (최대 접속: {}, 최대 고유 계정: {})", ip, max_connections, max_unique_accounts);
+        }
+        else
+        {
+            ++invalid;
+            LOG_ERROR("module.iplimit", "잘못된 IP 형식 발견: {}", ip);
+        }
+    } while (result->NextRow());
+
+    return true;
+}
+
+void LoadAllowedIpsFromDB()
+{
+    IpLimitScopedTimer timer(IpLimitTimer::DB_LOAD);
+
+    try
+    {
+        QueryResult testConnection = LoginDatabase.Query("SELECT 1");
+        if (!testConnection)
+        {
+            LOG_ERROR("module.iplimit", "데이터베이스 연결이 불가능하여 허용된 IP를 로드할 수 없습니다");
+            return;
+        }
+
+        // 3. DB 초기화 안내
+        LOG_INFO("module.iplimit", "IPLimit: 데이터베이스 초기화 중...");
+        
+        // 새 트라이를 따로 구성한 뒤 한 번에 교체합니다.
+        AdmissionEngine::AllowList loaded;
+        uint32 count = 0;
+        uint32 invalid = 0;
+        std::string error;
+        if (!BuildAllowListFromDB(loaded, count, invalid, error))
+        {
+            LOG_ERROR("module.iplimit", "IPLimit: {}", error);
+            return;
+        }
+
+        admissionEngine.ReplaceAllowList(std::move(loaded));
+
+        // 6. 허용된 IP 로드 완료
+        LOG_INFO("module.iplimit", "IPLimit: 데이터베이스에서 {}개의 허용된 IP를 로드했습니다.", count);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("module.iplimit", "허용된 IP 로드 중 오류 발생: {}", e.what());
+    }
+}
+
+void LoadLoginHistoryFromDB()
+{
+    IpLimitScopedTimer timer(IpLimitTimer::DB_LOAD);
+
+    try
+    {
+        LOG_INFO("module.iplimit", "IPLimit: 데이터베이스에서 IP 로그인 기록을 로드합니다...");
+
+        // 1. 테이블 존재 여부 확인 및 생성
+        QueryResult checkTable = LoginDatabase.Query("SHOW TABLES LIKE 'ip_login_history'");
+        if (!checkTable)
+        {
+            LOG_ERROR("module.iplimit", "IPLimit: `ip_login_history` 테이블이 존재하지 않습니다. SQL 파일을 DB에 임포트해주세요.");
+            return;
+        }
+
+        // 2. 데이터 로드
+        uint32 timeWindow = IpLimitConfig::Get()->rateLimitTimeWindow;
+        time_t minTime = GameTime::GetGameTime().count() - timeWindow;
+
+        QueryResult result = LoginDatabase.Query("SELECT ip, account_id, login_time FROM ip_login_history WHERE login_time >= {}", (uint32)minTime);
+
+        if (!result)
+        {
+            LOG_INFO("module.iplimit", "IPLimit: 로드할 IP 로그인 기록이 없습니다.");
+            return;
+        }
+
+        uint32 count = 0;
+        do
+        {
+            Field* fields = result->Fetch();
+            std::string ip = fields[0].Get<std::string>();
+            uint32 accountId = fields[1].Get<uint32>();
+            uint32 loginTime = fields[2].Get<uint32>();
+
+            IpAddress address;
+            if (!IpAddress::Parse(ip, address))
+            {
+                continue;
+            }
+
+            // DB에 이미 있는 기록이므로 다음 백업 대상에서 제외합니다.
+            ipLoginHistory.With(address, [&](auto& historyMap)
+            {
+                LoginWindow& history = historyMap[address];
+                bool dirty = history.IsDirty();
+                history.Add(accountId, loginTime);
+                if (!dirty)
+                {
+                    history.MarkClean();
+                }
+            });
+            count++;
+
+        } while (result->NextRow());
+
+        LOG_INFO("module.iplimit", "IPLimit: {}개의 IP 로그인 기록을 로드했습니다.", count);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("module.iplimit", "IP 로그인 기록 로드 중 오류 발생: {}", e.what());
+    }
+}
+
+// account_formation 의 모든 (계정, IP) 연결로 계정-IP 그래프를 만듭니다.
+void LoadAccountGraphFromDB()
+{
+    IpLimitScopedTimer timer(IpLimitTimer::DB_LOAD);
+
+    try
+    {
+        sAccountIpGraph->Clear();
+
+        QueryResult result = LoginDatabase.Query("SELECT accountId, ipAddress, UNIX_TIMESTAMP(lastSeen), loginCount FROM account_formation");
+        if (!result)
+        {
+            LOG_INFO("module.iplimit", "IPLimit: 계정-IP 그래프에 로드할 기록이 없습니다.");
+            return;
+        }
+
+        do
+        {
+            Field* fields = result->Fetch();
+
+            IpAddress address;
+            if (!IpAddress::Parse(fields[1].Get<std::string>(), address))
+            {
+                continue;
+            }
+
+            sAccountIpGraph->AddLogin(fields[0].Get<uint32>(), address, static_cast<uint32>(fields[2].Get<uint64>()), fields[3].Get<uint32>());
+        } while (result->NextRow());
+
+        AccountIpGraph::Stats stats = sAccountIpGraph->GetStats();
+        LOG_INFO("module.iplimit", "IPLimit: 계정-IP 그래프를 로드했습니다. (계정 {}, IP {}, 연결 {}, 묶음 {}, {} KB)",
+            stats.accounts, stats.ips, stats.links, stats.components, stats.memory / 1024);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("module.iplimit", "계정-IP 그래프 로드 중 오류 발생: {}", e.what());
+    }
+}
+
+// account_formation_daily 파티션 관리
+// 하루에 파티션 하나(pYYYYMMDD, 다음 날 0시 미만)를 두고, 앞으로 쓸 날짜의 파티션은 빈 p_future 를 나눠 미리 만듭니다.
+// 보존 기간이 지난 날짜는 DELETE 대신 DROP PARTITION 으로 지우므로 행 수와 관계없이 곧바로 끝납니다.
+constexpr int32 FORMATION_PARTITIONS_AHEAD = 7;
+constexpr uint32 FORMATION_PARTITION_INTERVAL = 3600;      // 초
+
+std::future<void> formationPartitionTask;
+
+// time 이 속한 날짜에서 offset 일 이동한 날의 0시 (서버 시간)
+static std::time_t LocalMidnight(std::time_t time, int32 offset)
+{
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_mday += offset;
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+static std::string FormatLocalDate(std::time_t time, char const* format)
+{
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), format, &local);
+    return buffer;
+}
+
+// 파티션으로 나뉜 account_formation_daily 가 있는지 확인합니다.
+bool CheckFormationDailyTable()
+{
+    QueryResult result = LoginDatabase.Query("SELECT 1 FROM information_schema.PARTITIONS "
+        "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'account_formation_daily' AND PARTITION_NAME = 'p_future'");
+    if (!result)
+    {
+        LOG_ERROR("module.iplimit", "IPLimit: 파티션(p_future)이 있는 `account_formation_daily` 테이블이 없어 일별 기록을 끕니다. SQL 파일을 DB에 임포트해주세요.");
+        return false;
+    }
+
+    return true;
+}
+
+// 앞으로 쓸 날짜의 파티션을 추가하고 보존 기간이 지난 파티션을 삭제합니다. (월드 스레드 밖에서도 호출)
+void MaintainFormationPartitions(uint32 retentionDays)
+{
+    IpLimitScopedTimer timer(IpLimitTimer::FORMATION_PARTITION);
+
+    QueryResult result = LoginDatabase.Query("SELECT PARTITION_NAME FROM information_schema.PARTITIONS "
+        "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'account_formation_daily' AND PARTITION_NAME IS NOT NULL");
+    if (!result)
+    {
+        LOG_ERROR("module.iplimit", "IPLimit: account_formation_daily 의 파티션 정보를 읽을 수 없습니다.");
+        return;
+    }
+
+    // 날짜 파티션 (YYYYMMDD, 문자열 순서 = 날짜 순서)
+    std::set<std::string> days;
+    bool hasFuture = false;
+    do
+    {
+        std::string name = result->Fetch()[0].Get<std::string>();
+        if (name == "p_future")
+        {
+            hasFuture = true;
+        }
+        else if (name.size() == 9 && name[0] == 'p')
+        {
+            days.insert(name.substr(1));
+        }
+    } while (result->NextRow());
+
+    if (!hasFuture)
+    {
+        LOG_ERROR("module.iplimit", "IPLimit: account_formation_daily 에 p_future 파티션이 없어 새 파티션을 만들 수 없습니다.");
+        return;
+    }
+
+    std::time_t now = std::time(nullptr);
+    std::string last = days.empty() ? std::string() : *days.rbegin();
+
+    // 1. 마지막 파티션 다음 날부터 FORMATION_PARTITIONS_AHEAD 일 뒤까지 추가 (p_future 는 비어 있으므로 곧바로 끝남)
+    std::string partitions;
+    uint32 added = 0;
+    for (int32 offset = 0; offset <= FORMATION_PARTITIONS_AHEAD; ++offset)
+    {
+        std::time_t day = LocalMidnight(now, offset);
+        std::string name = FormatLocalDate(day, "%Y%m%d");
+        if (name <= last)
+        {
+            continue;
+        }
+
+        partitions += Acore::StringFormat("PARTITION p{} VALUES LESS THAN ('{}'), ", name, FormatLocalDate(LocalMidnight(day, 1), "%Y-%m-%d"));
+        ++added;
+    }
+
+    if (added)
+    {
+        LoginDatabase.DirectExecute(Acore::StringFormat("ALTER TABLE account_formation_daily REORGANIZE PARTITION p_future INTO ({}PARTITION p_future VALUES LESS THAN (MAXVALUE))", partitions));
+    }
+
+    // 2. 보존 기간(오늘 포함 retentionDays 일)보다 오래된 파티션 삭제
+    uint32 dropped = 0;
+    if (retentionDays)
+    {
+        std::string cutoff = FormatLocalDate(LocalMidnight(now, 1 - static_cast<int32>(retentionDays)), "%Y%m%d");
+        std::string names;
+        for (std::string const& day : days)
+        {
+            if (day >= cutoff)
+            {
+                break;
+            }
+
+            names += (dropped ? ", p" : "p") + day;
+            ++dropped;
+        }
+
+        if (dropped)
+        {
+            LoginDatabase.DirectExecute(Acore::StringFormat("ALTER TABLE account_formation_daily DROP PARTITION {}", names));
+        }
+    }
+
+    if (added || dropped)
+    {
+        LOG_INFO("module.iplimit", "IPLimit: account_formation_daily 파티션 {}개를 추가하고 {}개를 삭제했습니다.", added, dropped);
+    }
+}
+
+// 로그인 시도 폭주 임시 차단 (ip_temp_ban)
+// 판정은 BurstLimiter 의 메모리 상태로만 하고, 차단 변경은 모아 두었다가 TEMP_BAN_FLUSH_INTERVAL 마다 여러 행을 한 번에 씁니다.
+// 단계를 이어가야 하므로 차단이 끝난 행도 BanResetSeconds 가 지날 때까지 남겨 둡니다.
+constexpr uint32 TEMP_BAN_FLUSH_INTERVAL = 5000;        // 밀리초
+constexpr uint32 TEMP_BAN_CLEANUP_INTERVAL = 3600;      // 초
+constexpr uint32 TEMP_BAN_FLUSH_BATCH = 500;
+
+bool tempBanTableReady = false;
+
+// 시작 시 지난 행을 지우고 남은 차단을 메모리로 읽어 옵니다.
+void LoadTempBansFromDB(uint32 banResetSeconds)
+{
+    IpLimitScopedTimer timer(IpLimitTimer::DB_LOAD);
+
+    tempBanTableReady = LoginDatabase.Query("SHOW TABLES LIKE 'ip_temp_ban'") != nullptr;
+    if (!tempBanTableReady)
+    {
+        LOG_ERROR("module.iplimit", "IPLimit: `ip_temp_ban` 테이블이 없어 임시 차단을 메모리에만 유지합니다. SQL 파일을 DB에 임포트해주세요.");
+        return;
+    }
+
+    uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+    uint32 resetBefore = now > banResetSeconds ? now - banResetSeconds : 0;
+    LoginDatabase.DirectExecute("DELETE FROM ip_temp_ban WHERE ban_until <= {} AND last_ban < {}", now, resetBefore);
+
+    QueryResult result = LoginDatabase.Query("SELECT ip, ban_until, last_ban, level FROM ip_temp_ban");
+    if (!result)
+    {
+        return;
+    }
+
+    uint32 count = 0;
+    uint32 active = 0;
+    do
+    {
+        Field* fields = result->Fetch();
+
+        TempBan ban;
+        if (!IpAddress::Parse(fields[0].Get<std::string>(), ban.ip))
+        {
+            continue;
+        }
+
+        ban.banUntil = fields[1].Get<uint32>();
+        ban.lastBan = fields[2].Get<uint32>();
+        ban.level = fields[3].Get<uint8>();
+        sBurstLimiter->Restore(ban);
+
+        ++count;
+        active += ban.banUntil > now;
+    } while (result->NextRow());
+
+    LOG_INFO("module.iplimit", "IPLimit: 임시 차단 기록 {}건을 불러왔습니다. (차단 중 {}건)", count, active);
+}
+
+// 모아 둔 차단 변경을 batch 행 단위의 upsert / DELETE 로 씁니다.
+void FlushTempBans(bool synchronous)
+{
+    std::vector<TempBan> bans;
+    sBurstLimiter->TakePendingBans(bans);
+    if (bans.empty() || !tempBanTableReady)
+    {
+        return;
+    }
+
+    IpLimitScopedTimer timer(IpLimitTimer::TEMP_BAN_FLUSH);
+
+    auto execute = [synchronous](std::string const& sql)
+    {
+        if (synchronous)
+        {
+            LoginDatabase.DirectExecute(sql);
+        }
+        else
+        {
+            LoginDatabase.Execute(sql);
+        }
+    };
+
+    static char const* const UPSERT_PREFIX = "INSERT INTO ip_temp_ban (ip, ban_until, last_ban, level) VALUES ";
+    static char const* const UPSERT_SUFFIX = " ON DUPLICATE KEY UPDATE ban_until = VALUES(ban_until), last_ban = VALUES(last_ban), level = VALUES(level)";
+
+    std::string upsert;
+    std::string remove;
+    uint32 upsertRows = 0;
+    uint32 removeRows = 0;
+
+    for (TempBan const& ban : bans)
+    {
+        char ip[IpAddress::INET6_STRING_LENGTH];
+        std::string_view address(ip, ban.ip.Format(ip));
+
+        // 차단 해제는 행 삭제
+        if (!ban.banUntil)
+        {
+            remove += removeRows ? ", '" : "DELETE FROM ip_temp_ban WHERE ip IN ('";
+            remove += address;
+            remove += "'";
+            if (++removeRows >= TEMP_BAN_FLUSH_BATCH)
+            {
+                execute(remove + ")");
+                remove.clear();
+                removeRows = 0;
+            }
+
+            continue;
+        }
+
+        upsert += upsertRows ? "," : UPSERT_PREFIX;
+        upsert += Acore::StringFormat("('{}', {}, {}, {})", address, ban.banUntil, ban.lastBan, ban.level);
+        if (++upsertRows >= TEMP_BAN_FLUSH_BATCH)
+        {
+            execute(upsert + UPSERT_SUFFIX);
+            upsert.clear();
+            upsertRows = 0;
+        }
+    }
+
+    if (upsertRows)
+    {
+        execute(upsert + UPSERT_SUFFIX);
+    }
+
+    if (removeRows)
+    {
+        execute(remove + ")");
+    }
+}
+
+void LoadAllowedIpsFromDB();
+void LoadLoginHistoryFromDB();
+bool LoadLocalHistoryStore();
+void SnapshotLocalHistoryStore(bool synchronous);
+void BackupLoginHistoryToDB(bool synchronous = false);
+
+// Load IP list only after full DB initialization
+class IpLimitManagerWorldScript : public WorldScript
+{
+private:
+    uint32 m_updateTimer;
+    uint32 m_reconcileTimer;
+    uint32 m_sweepTimer;
+    uint32 m_formationTimer;
+    uint32 m_partitionTimer;
+    uint32 m_tempBanTimer;
+    uint32 m_tempBanCleanupTimer;
+    uint32 m_snapshotTimer;
+    uint32 m_statsTimer;
+
+public:
+    IpLimitManagerWorldScript() : WorldScript("IpLimitManagerWorldScript") 
+    {
+        m_updateTimer = 0;
+        m_reconcileTimer = 0;
+        m_sweepTimer = 0;
+        m_formationTimer = 0;
+        m_partitionTimer = 0;
+        m_tempBanTimer = 0;
+        m_tempBanCleanupTimer = 0;
+        m_snapshotTimer = 0;
+        m_statsTimer = 0;
+    }
+
+    void OnAfterConfigLoad(bool /*reload*/) override
+    {
+        // 설정 스냅샷 재생성 (.reload config 포함)
+        IpLimitConfig::Load();
+
+        auto const config = IpLimitConfig::Get();
+        sIpLimitMetrics->SetEnabled(config->statsEnable);
+        sAccessLog->SetFlushPolicy(config->accessLogFlushInterval, config->accessLogFlushLines);
+        sAccessLog->SetRotationPolicy(config->accessLogMaxFileBytes, config->accessLogCompress, config->accessLogMaxTotalBytes);
+        sAccessLog->SetBinaryEnabled(config->accessLogBinary);
+        sAccountNameCache->Configure(config->accountNameCacheSize, config->accountNameCacheTtl);
+    }
+
+    void OnStartup() override
+    {
+        // 모듈 스크립트 등록 전에 최초 설정 로드가 끝났을 수 있으므로 한 번 더 읽어 둡니다.
+        IpLimitConfig::Load();
+        auto const config = IpLimitConfig::Get();
+
+        InitializeServerStartTime();
+        sIpLimitMetrics->SetEnabled(config->statsEnable);
+        sAccessLog->SetRotationPolicy(config->accessLogMaxFileBytes, config->accessLogCompress, config->accessLogMaxTotalBytes);
+        sAccessLog->SetBinaryEnabled(config->accessLogBinary);
+        sAccessLog->Start(serverStartTime, config->accessLogQueueSize, config->accessLogFlushInterval, config->accessLogFlushLines);
+        sAccountNameCache->Configure(config->accountNameCacheSize, config->accountNameCacheTtl);
+        LoadAllowedIpsFromDB();
+
+        if (config->rateLimitApproximateEnable)
+        {
+            uint8 precision = UniqueAccountSketch::PrecisionForError(config->rateLimitApproximateErrorPercent / 100.0);
+            admissionStorage.EnableSketches(precision, config->rateLimitApproximateBuckets, config->rateLimitApproximateExactThreshold);
+            LOG_INFO("module.iplimit", "IPLimit: 고유 계정 {}명을 넘은 IP는 근사 추적합니다. (오차 {:.2f}%, IP당 {} KB)",
+                config->rateLimitApproximateExactThreshold, UniqueAccountSketch::ErrorOf(precision) * 100.0,
+                ((config->rateLimitApproximateBuckets + 2) << precision) / 1024);
+        }
+
+        // 켜고 끄는 것은 .reload config 로도 바뀌므로 설정과 관계없이 읽어 둡니다.
+        LoadTempBansFromDB(config->burstBanResetSeconds);
+
+        accountGraphEnabled = config->accountIpLoggerGraphEnable;
+        if (accountGraphEnabled)
+        {
+            LoadAccountGraphFromDB();
+        }
+
+        // 첫 기록 전에 오늘 파티션을 만들어 둡니다.
+        formationDailyEnabled = config->accountIpLoggerEnable && config->accountIpLoggerDailyEnable && CheckFormationDailyTable();
+        sAccountFormation->SetDailyEnabled(formationDailyEnabled);
+        if (formationDailyEnabled)
+        {
+            MaintainFormationPartitions(config->accountIpLoggerDailyRetentionDays);
+        }
+
+        // 로컬 저장소에서 복구했으면 DB 백업은 읽지 않습니다.
+        bool restored = config->localStoreEnable && LoadLocalHistoryStore();
+        if (config->backupEnable && !restored)
+        {
+            LoadLoginHistoryFromDB();
+        }
+    }
+
+    void OnUpdate(uint32 diff) override
+    {
+        auto const config = IpLimitConfig::Get();
+
+        // 로그인 승인 쿼리 결과 처리
+        {
+            std::lock_guard<std::mutex> lock(admissionCallbackMutex);
+            admissionCallbacks.ProcessReadyCallbacks();
+        }
+
+        // 예약된 강제 퇴장 처리
+        ProcessPendingKicks();
+
+        // .allowip reload 완료 안내
+        ProcessAllowListReload();
+
+        // 로그인 기록 WAL 기록 및 주기적 스냅샷
+        if (localHistoryStore)
+        {
+            std::string error;
+            if (!localHistoryStore->Flush(error))
+            {
+                LOG_ERROR("module.iplimit", "IPLimit: 로컬 저장소 오류 - {}", error);
+            }
+
+            m_snapshotTimer += diff;
+            if (m_snapshotTimer >= config->localStoreSnapshotInterval * 1000)
+            {
+                m_snapshotTimer = 0;
+                SnapshotLocalHistoryStore(false);
+            }
+        }
+
+        // 주기적 통계 기록
+        if (config->statsLogInterval)
+        {
+            m_statsTimer += diff;
+            if (m_statsTimer >= config->statsLogInterval * 1000)
+            {
+                m_statsTimer = 0;
+                for (std::string const& line : BuildStatsReport())
+                {
+                    LOG_INFO("module.iplimit", "{}", line);
+                }
+            }
+        }
+
+        // 모아 둔 account_formation 기록 저장
+        m_formationTimer += diff;
+        if (m_formationTimer >= config->accountIpLoggerFlushInterval)
+        {
+            m_formationTimer = 0;
+            IpLimitScopedTimer timer(IpLimitTimer::FORMATION_FLUSH);
+            sAccountFormation->Flush(config->accountIpLoggerFlushBatchSize);
+        }
+
+        // 일별 기록 파티션 추가/보존 기간 정리 (DDL 은 작업 스레드에서)
+        if (formationDailyEnabled)
+        {
+            m_partitionTimer += diff;
+            if (m_partitionTimer >= FORMATION_PARTITION_INTERVAL * 1000)
+            {
+                m_partitionTimer = 0;
+                if (!formationPartitionTask.valid() || formationPartitionTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                {
+                    formationPartitionTask = std::async(std::launch::async, MaintainFormationPartitions, config->accountIpLoggerDailyRetentionDays);
+                }
+            }
+        }
+
+        // 만료된 로그인 기록 정리
+        m_sweepTimer += diff;
+        if (m_sweepTimer >= config->rateLimitSweepInterval)
+        {
+            m_sweepTimer = 0;
+            SweepLoginHistory(config->rateLimitTimeWindow, config->rateLimitSweepBudget);
+            sBurstLimiter->Sweep(MakeBurstPolicy(*config), static_cast<uint32>(GameTime::GetGameTime().count()), config->rateLimitSweepBudget);
+        }
+
+        // 임시 차단 변경 기록, 단계가 끝난 행 정리
+        m_tempBanTimer += diff;
+        if (m_tempBanTimer >= TEMP_BAN_FLUSH_INTERVAL)
+        {
+            m_tempBanTimer = 0;
+            FlushTempBans(false);
+        }
+
+        m_tempBanCleanupTimer += diff;
+        if (m_tempBanCleanupTimer >= TEMP_BAN_CLEANUP_INTERVAL * 1000)
+        {
+            m_tempBanCleanupTimer = 0;
+            if (tempBanTableReady)
+            {
+                uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+                uint32 resetBefore = now > config->burstBanResetSeconds ? now - config->burstBanResetSeconds : 0;
+                LoginDatabase.Execute("DELETE FROM ip_temp_ban WHERE ban_until <= {} AND last_ban < {}", now, resetBefore);
+            }
+        }
+
+        // 세션 레지스트리 재조정
+        m_reconcileTimer += diff;
+        if (m_reconcileTimer >= config->registryReconcileInterval * 1000)
+        {
+            m_reconcileTimer = 0;
+            if (config->enabled)
+            {
+                ReconcileSessionRegistry();
+            }
+        }
+
+        if (!config->backupEnable)
+        {
+            return;
+        }
+
+        m_updateTimer += diff;
+
+        if (m_updateTimer >= config->backupInterval * 1000)
+        {
+            m_updateTimer = 0;
+            BackupLoginHistoryToDB();
+        }
+    }
+
+    // 끝난 .allowip reload 작업의 결과를 로그와 요청한 관리자에게 알립니다.
+    static void ProcessAllowListReload()
+    {
+        if (!allowListReloadTask.valid() || allowListReloadTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return;
+        }
+
+        AllowListReloadResult result = allowListReloadTask.get();
+
+        std::string message;
+        if (!result.loaded)
+        {
+            message = Acore::StringFormat("허용 목록을 다시 읽지 못했습니다: {}", result.error);
+            LOG_ERROR("module.iplimit", "IPLimit: {}", message);
+        }
+        else if (!result.applied)
+        {
+            message = "허용 목록을 읽는 동안 .allowip append/remove 로 목록이 바뀌어 적용하지 않았습니다. 다시 실행해주세요.";
+            LOG_INFO("module.iplimit", "IPLimit: {}", message);
+        }
+        else
+        {
+            message = Acore::StringFormat("허용 목록을 다시 읽었습니다. ({}개, 잘못된 형식 {}개, {})", result.count, result.invalid, IpLimitMetrics::FormatDuration(result.elapsed));
+            LOG_INFO("module.iplimit", "IPLimit: {}", message);
+        }
+
+        if (allowListReloadRequester)
+        {
+            if (WorldSession* session = sWorldSessionMgr->FindSession(allowListReloadRequester))
+            {
+                ChatHandler(session).PSendSysMessage(message);
+            }
+        }
+    }
+
+    // 처리 시각이 된 강제 퇴장 예약을 꺼내 경고 메시지 전송 및 연결 종료를 수행합니다.
+    static void ProcessPendingKicks()
+    {
+        std::vector<KickScheduler::DueKick> due;
+        sKickScheduler->CollectDue(GameTime::GetGameTime().count(), due);
 
-        do
+        for (KickScheduler::DueKick const& kick : due)
         {
-            Field* fields = result->Fetch();
-            uint32 accountId = fields[0].Get<uint32>();
-            std::string lastSeen = fields[1].Get<std::string>();
-            uint32 count = fields[2].Get<uint32>();
-
-            std::string accountName;
-            if (!AccountMgr::GetName(accountId, accountName))
+            Player* player = ObjectAccessor::FindConnectedPlayer(ObjectGuid(kick.guid));
+            if (!player || !player->GetSession())
             {
-                accountName = "Unknown";
+                continue;
             }
 
-            handler->PSendSysMessage("Account: %s (ID: %u)", accountName.c_str(), accountId);
-            handler->PSendSysMessage("  Last Seen: %s", lastSeen.c_str());
-            handler->PSendSysMessage("  Login Count: %u", count);
+            if (kick.stage == KickStage::WARNING)
+            {
+                ChatHandler(player->GetSession()).PSendSysMessage("|cff4CFF00[시스템]|r 경고: 5초 후에 연결이 끊어집니다.");
+                continue;
+            }
 
-        } while (result->NextRow());
+            // 2초 남기고 메세지
+            std::string msg = "|cff4CFF00[시스템]|r ";
+            switch (kick.info.reason)
+            {
+                case KickReason::CONCURRENT_LIMIT:
+                    msg += "최대 동시 접속 제한으로 인해 연결이 끊어졌습니다.";
+                    break;
+                case KickReason::BURST_LIMIT:
+                case KickReason::TEMP_BAN:
+                    msg += "반복된 접속 시도로 인해 연결이 끊어졌습니다.";
+                    break;
+                default: // KickReason::RATE_LIMIT
+                    msg += "로그인 빈도 제한으로 인해 연결이 끊어졌습니다.";
+                    break;
+            }
+            ChatHandler(player->GetSession()).PSendSysMessage(msg);
 
-        handler->SendSysMessage("-------------------------------------------------");
+            {
+                IpLimitScopedTimer timer(IpLimitTimer::DB_KICK_UPDATE);
+                CharacterDatabase.DirectExecute("UPDATE characters SET online = 0 WHERE guid = {}", player->GetGUID().GetCounter());
+                LoginDatabase.DirectExecute("UPDATE account SET online = 0 WHERE id = {}", kick.info.accountId);
+            }
 
-        return true;
+            player->GetSession()->KickPlayer();
+        }
     }
 
-    static bool HandleAddIpCommand(ChatHandler* handler, std::string const& args)
+    // 로그인 기록 테이블을 budget 슬롯씩 나눠 검사하여 시간 창이 지난 기록과 빈 IP를 제거합니다.
+    // 다시 접속하지 않는 IP의 기록도 정리되어 메모리가 최근 활동 IP 수에 비례하도록 유지됩니다.
+    // 한 번에 샤드 하나만 잠그므로 정리 중에도 다른 샤드의 로그인은 대기하지 않습니다.
+    static void SweepLoginHistory(uint32 timeWindow, uint32 budget)
     {
-        if (args.empty())
+        IpLimitScopedTimer timer(IpLimitTimer::SWEEP);
+        static std::size_t shard = 0;
+        static std::size_t cursor = 0;
+        uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+
+        bool completed = ipLoginHistory.WithShard(shard, [&](auto& historyMap)
         {
-            handler->PSendSysMessage("사용법: .allowip append <ip> [max_conn] [max_unique]");
-            handler->PSendSysMessage("예시: .allowip append 192.168.1.1 3 5");
-            return false;
-        }
+            bool passed = historyMap.sweep(cursor, budget, [now, timeWindow](IpAddress const&, LoginWindow& history)
+            {
+                history.Expire(now, timeWindow);
+                return history.Empty();
+            });
 
-        std::stringstream ss(args);
-        std::string ip;
-        uint32 max_connections = 2; // 기본값
-        uint32 max_unique_accounts = 1; // 기본값
+            // 한 바퀴를 돌 때마다 대량 만료로 비어 있는 테이블 공간을 돌려줍니다.
+            if (passed)
+            {
+                historyMap.shrink_to_fit();
+            }
 
-        ss >> ip;
-        ss >> max_connections;
-        ss >> max_unique_accounts;
-        
-        if (!IsValidIP(ip))
-        {
-            handler->PSendSysMessage("오류: 잘못된 IP 주소 형식입니다. IPv4 형식을 사용해주세요.");
-            return false;
-        }
+            return passed;
+        });
 
-        // IP가 이미 존재하는지 확인
-        QueryResult checkResult = LoginDatabase.Query("SELECT 1 FROM custom_allowed_ips WHERE ip = '{}'", ip);
-        if (checkResult)
+        if (completed)
         {
-            handler->PSendSysMessage("오류: IP {} 는 이미 허용 목록에 존재합니다.", ip);
-            return false;
+            shard = (shard + 1) % ipLoginHistory.SHARD_COUNT;
         }
 
-        LoginDatabase.Execute("INSERT INTO custom_allowed_ips (ip, max_connections, max_unique_accounts) VALUES ('{}', {}, {})", ip, max_connections, max_unique_accounts);
-        allowedIps[ip] = {max_connections, max_unique_accounts};
-        handler->PSendSysMessage("IP {} 가 허용 목록에 추가되었습니다. (최대 접속: {}, 최대 고유 계정: {})", ip, max_connections, max_unique_accounts);
-        return true;
+        admissionStorage.SweepSketches(now);
     }
 
-    static bool HandleDelIpCommand(ChatHandler* handler, std::string const& args)
+    // 실제 WorldSession 목록을 기준으로 레지스트리 카운터 오차를 바로잡습니다.
+    static void ReconcileSessionRegistry()
     {
-        if (args.empty())
+        IpLimitScopedTimer timer(IpLimitTimer::RECONCILE);
+        IpSessionRegistry::LiveSessionMap liveSessions;
+        for (auto const& [accountId, session] : sWorldSessionMgr->GetAllSessions())
         {
-            handler->PSendSysMessage("사용법: .allowip remove <ip>");
-            handler->PSendSysMessage("예시: .allowip remove 192.168.1.1");
-            return false;
-        }
+            IpAddress address;
+            if (!session || !IpAddress::Parse(session->GetRemoteAddress(), address))
+            {
+                continue;
+            }
 
-        std::string ip = args;
+            Player* player = session->GetPlayer();
+            liveSessions[accountId] = { address, player && player->IsInWorld(), SessionKey(session) };
+        }
 
-        if (!IsValidIP(ip))
+        // 콜백이 오지 않은 거부 표시는 세션이 사라지면 지웁니다.
+        std::erase_if(rejectedSessions, [](auto const& rejected)
         {
-            handler->PSendSysMessage("오류: 잘못된 IP 주소 형식입니다. IPv4 형식을 사용해주세요.");
-            return false;
-        }
+            return sWorldSessionMgr->FindSession(rejected.first) != rejected.second;
+        });
 
-        // IP가 존재하는지 확인
-        QueryResult checkResult = LoginDatabase.Query("SELECT 1 FROM custom_allowed_ips WHERE ip = '{}'", ip);
-        if (!checkResult)
+        uint32 corrected = sIpSessionRegistry->Reconcile(liveSessions);
+        if (corrected)
         {
-            handler->PSendSysMessage("오류: IP {} 는 허용 목록에 존재하지 않습니다.", ip);
-            return false;
+            LOG_DEBUG("module.iplimit", "IPLimit: 세션 레지스트리 재조정 - {}개 계정의 접속 정보를 바로잡았습니다.", corrected);
         }
-
-        LoginDatabase.Execute("DELETE FROM custom_allowed_ips WHERE ip = '{}'", ip);
-        allowedIps.erase(ip);
-        handler->PSendSysMessage("IP {} 가 허용 목록에서 제거되었습니다.", ip);
-        return true;
     }
 
-    static bool HandleShowIpCommand(ChatHandler* handler, std::string const& args)
+    void OnShutdown() override
     {
-        // 디버깅을 위한 로그 추가
-        LOG_INFO("module.iplimit", "HandleShowIpCommand 함수 실행 시작");
+        auto const config = IpLimitConfig::Get();
 
-        // 테이블 존재 여부 먼저 확인
-        QueryResult tableCheck = LoginDatabase.Query("SHOW TABLES LIKE 'custom_allowed_ips'");
-        if (!tableCheck)
+        // 진행 중인 .allowip reload / 파티션 정리가 끝나기를 기다립니다.
+        if (allowListReloadTask.valid())
         {
-            handler->PSendSysMessage("|cFFFF0000오류:|r custom_allowed_ips 테이블이 존재하지 않습니다.");
-            LOG_ERROR("module.iplimit", "custom_allowed_ips 테이블이 존재하지 않음");
-            return false;
+            allowListReloadTask.wait();
         }
 
-        LOG_INFO("module.iplimit", "테이블 존재 확인됨, 데이터 조회 중...");
-
-        QueryResult result = LoginDatabase.Query("SELECT ip, description, max_connections, max_unique_accounts FROM custom_allowed_ips");
-
-        LOG_INFO("module.iplimit", "쿼리 실행 완료, 결과 확인 중...");
-
-        if (!result)
+        if (formationPartitionTask.valid())
         {
-            handler->PSendSysMessage("|cFF00FFFF알림:|r 허용된 IP 목록이 비어있습니다.");
-            LOG_INFO("module.iplimit", "쿼리 결과가 비어있음");
-            return true;
+            formationPartitionTask.wait();
         }
 
-        LOG_INFO("module.iplimit", "쿼리 결과 존재, 목록 출력 시작");
-        handler->PSendSysMessage("|cFF00FF00=== 허용된 IP 목록 ===|r");
-        handler->PSendSysMessage("-----------------------------------------------------------------");
-        handler->PSendSysMessage("|cFFFFFF00IP 주소           최대접속   최대고유계정   설명|r");
-        handler->PSendSysMessage("-----------------------------------------------------------------");
-
-        uint32 count = 0;
-        do
+        // 서버 종료 시 남은 접속 로그를 모두 기록하고 파일 정리
+        sAccessLog->Stop();
+        if (uint64 dropped = sAccessLog->GetDroppedCount())
         {
-            Field* fields = result->Fetch();
-
-            std::string ip = fields[0].Get<std::string>();
-            std::string desc = fields[1].Get<std::string>();
-            uint32 max_connections = fields[2].Get<uint32>();
-            uint32 max_unique_accounts = fields[3].Get<uint32>();
+            LOG_ERROR("module.iplimit", "IPLimit: 접속 로그 큐가 가득 차 {}건의 기록을 남기지 못했습니다. IpLimitManager.AccessLog.QueueSize 를 늘려주세요.", dropped);
+        }
 
-            std::string paddedIp = ip;
-            while (paddedIp.length() < 15)
-                paddedIp += " ";
+        // 아직 기록하지 않은 account_formation / 임시 차단을 종료 전에 저장
+        sAccountFormation->Flush(config->accountIpLoggerFlushBatchSize, true);
+        FlushTempBans(true);
 
-            handler->PSendSysMessage("|cFFFFFF00{}|r  |cFFFF0000{:>2}|r         |cFF00FFFF{:>2}|r            {}", paddedIp, max_connections, max_unique_accounts, desc);
-            count++;
-        } while (result->NextRow());
+        AccountNameCache::Stats nameCache = sAccountNameCache->GetStats();
+        LOG_INFO("module.iplimit", "IPLimit: 계정 이름 캐시 - 적중 {}, 실패 {}, 항목 {}/{}", nameCache.hits, nameCache.misses, nameCache.size, nameCache.capacity);
 
-        handler->PSendSysMessage("-----------------------------------------------------------------");
-        handler->PSendSysMessage("총 |cFF00FF00{}|r개의 IP가 등록되어 있습니다.", count);
+        if (config->backupEnable)
+        {
+            BackupLoginHistoryToDB(true);
+        }
 
-        return true;
+        if (localHistoryStore)
+        {
+            SnapshotLocalHistoryStore(true);
+        }
     }
 };
 
-void LoadAllowedIpsFromDB()
+// 로컬 저장소의 스냅샷과 WAL 로 로그인 기록을 복구합니다. 복구한 기록이 있으면 true
+bool LoadLocalHistoryStore()
 {
-    try
-    {
-        QueryResult testConnection = LoginDatabase.Query("SELECT 1");
-        if (!testConnection)
-        {
-            LOG_ERROR("module.iplimit", "데이터베이스 연결이 불가능하여 허용된 IP를 로드할 수 없습니다");
-            return;
-        }
+    auto const config = IpLimitConfig::Get();
+    localHistoryStore = std::make_unique<LoginHistoryStore>(config->localStoreDirectory);
 
-        // 3. DB 초기화 안내
-        LOG_INFO("module.iplimit", "IPLimit: 데이터베이스 초기화 중...");
-        
-        // 테이블 존재 여부 확인
-        QueryResult checkTable = LoginDatabase.Query("SHOW TABLES LIKE 'custom_allowed_ips'");
-        if (!checkTable)
+    uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+    uint32 cutoff = now > config->rateLimitTimeWindow ? now - config->rateLimitTimeWindow : 0;
+    auto start = std::chrono::steady_clock::now();
+
+    LoginHistoryStore::LoadStats stats;
+    bool found = localHistoryStore->Load([cutoff](LoginHistoryStore::Record const& record)
+    {
+        if (record.loginTime < cutoff)
         {
-            LOG_ERROR("module.iplimit", "IPLimit: `custom_allowed_ips` 테이블이 존재하지 않습니다. SQL 파일을 DB에 임포트해주세요.");
             return;
         }
 
-        // 데이터 로드
-        QueryResult result = LoginDatabase.Query("SELECT ip, max_connections, max_unique_accounts FROM custom_allowed_ips");
-        uint32 count = 0;
-
-        allowedIps.clear(); // 기존 데이터 초기화
-
-        if (result)
-        {
-            do
-            {
-                Field* fields = result->Fetch();
-                std::string ip = fields[0].Get<std::string>();
-                uint32 max_connections = fields[1].Get<uint32>();
-                uint32 max_unique_accounts = fields[2].Get<uint32>();
+        // 스냅샷과 WAL 에 같은 기록이 겹칠 수 있으므로 더 최근 시각만 반영합니다.
+        IpAddress address{ record.ipHi, record.ipLo };
+        ipLoginHistory.With(address, [&](auto& historyMap) { historyMap[address].Merge(record.accountId, record.loginTime); });
+    }, stats);
 
-                if (!ip.empty() && IsValidIP(ip))
-                {
-                    allowedIps[ip] = {max_connections, max_unique_accounts};
-                    ++count;
-                    LOG_DEBUG("module.iplimit", "허용된 IP 로드: {} (최대 접속: {}, 최대 고유 계정: {})", ip, max_connections, max_unique_accounts);
-                }
-                else
-                {
-                    LOG_ERROR("module.iplimit", "잘못된 IP 형식 발견: {}", ip);
-                }
-            } while (result->NextRow());
-        }
+    for (std::string const& warning : stats.warnings)
+    {
+        LOG_ERROR("module.iplimit", "IPLimit: 로컬 저장소 - {}", warning);
+    }
 
-        // 6. 허용된 IP 로드 완료
-        LOG_INFO("module.iplimit", "IPLimit: 데이터베이스에서 {}개의 허용된 IP를 로드했습니다.", count);
+    std::string error;
+    if (!localHistoryStore->OpenWal(error))
+    {
+        LOG_ERROR("module.iplimit", "IPLimit: 로컬 저장소를 사용할 수 없습니다 - {}", error);
+        localHistoryStore.reset();
+        return false;
     }
-    catch (const std::exception& e)
+
+    if (!found || (!stats.snapshotLoaded && !stats.walRecords))
     {
-        LOG_ERROR("module.iplimit", "허용된 IP 로드 중 오류 발생: {}", e.what());
+        LOG_INFO("module.iplimit", "IPLimit: 로컬 저장소({})에 복구할 기록이 없습니다.", config->localStoreDirectory);
+        return false;
     }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("module.iplimit", "IPLimit: 로컬 저장소에서 로그인 기록을 복구했습니다. (스냅샷 {}개, WAL {}개, IP {}개, {}ms)",
+        stats.snapshotRecords, stats.walRecords, ipLoginHistory.Size(), elapsed);
+    return true;
 }
 
-void LoadLoginHistoryFromDB()
+// 현재 WAL 을 돌린 뒤 전체 상태를 스냅샷으로 씁니다. 스냅샷 파일 쓰기는 별도 스레드에서 합니다.
+void SnapshotLocalHistoryStore(bool synchronous)
 {
-    try
+    if (localSnapshotTask.valid())
     {
-        LOG_INFO("module.iplimit", "IPLimit: 데이터베이스에서 IP 로그인 기록을 로드합니다...");
-
-        // 1. 테이블 존재 여부 확인 및 생성
-        QueryResult checkTable = LoginDatabase.Query("SHOW TABLES LIKE 'ip_login_history'");
-        if (!checkTable)
+        if (!synchronous && localSnapshotTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
         {
-            LOG_ERROR("module.iplimit", "IPLimit: `ip_login_history` 테이블이 존재하지 않습니다. SQL 파일을 DB에 임포트해주세요.");
             return;
         }
 
-        // 2. 데이터 로드
-        uint32 timeWindow = sConfigMgr->GetOption<uint32>("IpLimitManager.RateLimit.TimeWindowSeconds", 3600);
-        time_t minTime = GameTime::GetGameTime().count() - timeWindow;
+        localSnapshotTask.get();
+    }
 
-        QueryResult result = LoginDatabase.Query("SELECT ip, account_id, login_time FROM ip_login_history WHERE login_time >= {}", (uint32)minTime);
+    // WAL 을 먼저 돌리므로, 아래 복사 이후의 로그인은 새 WAL 에 남습니다.
+    std::string error;
+    if (!localHistoryStore->RotateWal(error))
+    {
+        LOG_ERROR("module.iplimit", "IPLimit: 로컬 저장소 WAL 교체 실패 - {}", error);
+        return;
+    }
 
-        if (!result)
-        {
-            LOG_INFO("module.iplimit", "IPLimit: 로드할 IP 로그인 기록이 없습니다.");
-            return;
-        }
+    auto const config = IpLimitConfig::Get();
+    uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+    uint32 cutoff = now > config->rateLimitTimeWindow ? now - config->rateLimitTimeWindow : 0;
 
-        uint32 count = 0;
+    std::vector<LoginHistoryStore::Record> records;
+    ipLoginHistory.ForEachShard([&records, cutoff](std::size_t, auto const& historyMap)
+    {
+        for (auto const& [address, history] : historyMap)
         {
-            std::lock_guard<std::mutex> lock(ipMutex);
-            do
+            for (LoginWindow::Record const& record : history)
             {
-                Field* fields = result->Fetch();
-                std::string ip = fields[0].Get<std::string>();
-                uint32 accountId = fields[1].Get<uint32>();
-                time_t loginTime = fields[2].Get<uint32>();
-
-                ipLoginHistory[ip].push_back({accountId, loginTime});
-                count++;
+                if (record.loginTime >= cutoff)
+                {
+                    records.push_back({ address.hi, address.lo, record.accountId, record.loginTime });
+                }
+            }
+        }
+    });
 
-            } while (result->NextRow());
+    auto write = [records = std::move(records), now]()
+    {
+        IpLimitScopedTimer timer(IpLimitTimer::LOCAL_SNAPSHOT);
+        std::string error;
+        if (!localHistoryStore->WriteSnapshot(records, now, error))
+        {
+            LOG_ERROR("module.iplimit", "IPLimit: 로컬 저장소 스냅샷 실패 - {}", error);
+            return;
         }
 
-        LOG_INFO("module.iplimit", "IPLimit: {}개의 IP 로그인 기록을 로드했습니다.", count);
+        LOG_DEBUG("module.iplimit", "IPLimit: 로컬 저장소 스냅샷 완료 ({}개 기록)", records.size());
+    };
+
+    if (synchronous)
+    {
+        write();
     }
-    catch (const std::exception& e)
+    else
     {
-        LOG_ERROR("module.iplimit", "IP 로그인 기록 로드 중 오류 발생: {}", e.what());
+        localSnapshotTask = std::async(std::launch::async, std::move(write));
     }
 }
 
-void LoadAllowedIpsFromDB();
-void LoadLoginHistoryFromDB();
-void BackupLoginHistoryToDB();
-
-// Load IP list only after full DB initialization
-class IpLimitManagerWorldScript : public WorldScript
+struct LoginHistoryRow
 {
-private:
-    uint32 m_updateTimer;
-    uint32 m_backupInterval;
+    IpAddress ip;
+    uint32 accountId;
+    uint32 loginTime;
+};
 
-public:
-    IpLimitManagerWorldScript() : WorldScript("IpLimitManagerWorldScript") 
-    {
-        m_updateTimer = 0;
-    }
+// 이전 백업의 SQL 생성 작업 (월드 스레드 밖에서 실행)
+std::future<void> loginHistoryBackupTask;
 
-    void OnStartup() override
+// 만료 기록 삭제와 변경 기록 upsert 를 하나의 트랜잭션으로 적용하여, 테이블이 비어 보이는 순간이 없습니다.
+void WriteLoginHistoryRows(std::vector<LoginHistoryRow> const& rows, uint32 cutoff, uint32 batchSize, bool synchronous)
+{
+    try
     {
-        InitializeServerStartTime();
-        LoadAllowedIpsFromDB();
+        IpLimitScopedTimer timer(IpLimitTimer::BACKUP);
+        SQLTransaction trans = LoginDatabase.BeginTransaction();
+        trans->Append("DELETE FROM ip_login_history WHERE login_time < {}", cutoff);
 
-        if (sConfigMgr->GetOption<bool>("IpLimitManager.Backup.Enable", true))
+        std::string sql;
+        uint32 batched = 0;
+        for (LoginHistoryRow const& row : rows)
         {
-            LoadLoginHistoryFromDB();
-            m_backupInterval = sConfigMgr->GetOption<uint32>("IpLimitManager.Backup.Interval", 300);
-        }
-    }
+            sql += batched ? "," : "INSERT INTO ip_login_history (ip, account_id, login_time) VALUES ";
+            sql += Acore::StringFormat("('{}', {}, {})", row.ip.ToString(), row.accountId, row.loginTime);
 
-    void OnUpdate(uint32 diff) override
-    {
-        if (!sConfigMgr->GetOption<bool>("IpLimitManager.Backup.Enable", true))
-        {
-            return;
+            if (++batched >= batchSize)
+            {
+                sql += " ON DUPLICATE KEY UPDATE login_time = VALUES(login_time)";
+                trans->Append(sql);
+                sql.clear();
+                batched = 0;
+            }
         }
 
-        m_updateTimer += diff;
-
-        if (m_updateTimer >= m_backupInterval * 1000)
+        if (batched)
         {
-            m_updateTimer = 0;
-            BackupLoginHistoryToDB();
+            sql += " ON DUPLICATE KEY UPDATE login_time = VALUES(login_time)";
+            trans->Append(sql);
         }
-    }
 
-    void OnShutdown() override
-    {
-        // 서버 종료 시 파일 스트림 정리
-        std::lock_guard<std::mutex> lock(csvMutex);
-        if (csvFile.is_open())
+        if (synchronous)
         {
-            csvFile.flush();
-            csvFile.close();
+            LoginDatabase.DirectCommitTransaction(trans);
         }
-
-        if (sConfigMgr->GetOption<bool>("IpLimitManager.Backup.Enable", true))
+        else
         {
-            BackupLoginHistoryToDB();
+            LoginDatabase.CommitTransaction(trans);
         }
-    }
-};
 
-void BackupLoginHistoryToDB()
-{
-    if (ipLoginHistory.empty())
+        sIpLimitMetrics->Increment(IpLimitCounter::BACKUP_ROWS, rows.size());
+        LOG_INFO("module.iplimit", "IPLimit: 변경된 IP 로그인 기록 {}개를 백업했습니다.", rows.size());
+    }
+    catch (const std::exception& e)
     {
-        return;
+        LOG_ERROR("module.iplimit", "IP 로그인 기록 백업 중 오류 발생: {}", e.what());
     }
+}
 
-    try
+// 마지막 백업 이후 바뀐 IP의 기록만 저장하고, 시간 창이 지난 기록은 DB에서 삭제합니다.
+// 샤드마다 잠금 안에서는 변경된 기록만 복사하며, SQL 생성은 별도 스레드에서 합니다.
+void BackupLoginHistoryToDB(bool synchronous)
+{
+    // 이전 백업이 아직 진행 중이면 다음 주기로 미룹니다. (변경 표시는 그대로 남아 다음 백업에 포함)
+    if (loginHistoryBackupTask.valid())
     {
-        LOG_INFO("module.iplimit", "IPLimit: IP 로그인 기록을 데이터베이스에 백업합니다...");
+        if (!synchronous && loginHistoryBackupTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            LOG_DEBUG("module.iplimit", "IPLimit: 이전 IP 로그인 기록 백업이 진행 중이므로 이번 백업은 건너뜁니다.");
+            return;
+        }
 
-        LoginDatabase.Execute("TRUNCATE TABLE `ip_login_history`");
+        loginHistoryBackupTask.get();
+    }
 
-        SQLTransaction trans = LoginDatabase.BeginTransaction();
-        uint32 count = 0;
+    auto const config = IpLimitConfig::Get();
+    uint32 now = static_cast<uint32>(GameTime::GetGameTime().count());
+    uint32 cutoff = now > config->rateLimitTimeWindow ? now - config->rateLimitTimeWindow : 0;
 
+    std::vector<LoginHistoryRow> rows;
+    ipLoginHistory.ForEachShard([&rows](std::size_t, auto& historyMap)
+    {
+        for (auto& [address, history] : historyMap)
         {
-            std::lock_guard<std::mutex> lock(ipMutex);
-            for (auto const& [ip, history] : ipLoginHistory)
+            if (!history.IsDirty())
             {
-                for (auto const& record : history)
-                {
-                    trans->Append("INSERT INTO ip_login_history (ip, account_id, login_time) VALUES ('{}', {}, {})", ip, record.first, (uint32)record.second);
-                    count++;
-                }
+                continue;
             }
-        }
 
-        if (count > 0)
-        {
-            LoginDatabase.CommitTransaction(trans);
+            for (LoginWindow::Record const& record : history)
+            {
+                rows.push_back({ address, record.accountId, record.loginTime });
+            }
+
+            history.MarkClean();
         }
+    });
 
-        LOG_INFO("module.iplimit", "IPLimit: {}개의 IP 로그인 기록을 백업했습니다.", count);
-    }
-    catch (const std::exception& e)
+    uint32 batchSize = config->backupBatchSize;
+    if (synchronous)
     {
-        LOG_ERROR("module.iplimit", "IP 로그인 기록 백업 중 오류 발생: {}", e.what());
+        WriteLoginHistoryRows(rows, cutoff, batchSize, true);
+        return;
     }
+
+    loginHistoryBackupTask = std::async(std::launch::async, [rows = std::move(rows), cutoff, batchSize]()
+    {
+        WriteLoginHistoryRows(rows, cutoff, batchSize, false);
+    });
 }
 
 void Addmod_iplimit_managerScripts()
 {
     new IpLimitManager_AccountScript();
+    new IpLimitManager_ServerScript();
     new IpLimitManager_PlayerScript();
     new IpLimitManager_CommandScript();
     new IpLimitManagerWorldScript();
 }
-
-
-
-
@@ -0,0 +1,403 @@
+// Filename iplimit-admission-bench.cpp
+// 접속 허용 판정 엔진 마이크로벤치마크 (AzerothCore 없이 빌드)
+//
+// 합성 작업 부하마다 새 엔진을 만들어 로그인 판정을 반복하고 다음을 출력합니다.
+//   logins/s   세션 등록/입장/퇴장을 포함한 초당 로그인 처리 수
+//   p50, p99   AdmissionEngine::Admit 한 번의 판정 지연 (ns)
+//   bytes/IP   작업 부하가 끝난 뒤 저장소 사용 메모리 / 추적 중인 IP 수
+//
+// 작업 부하
+//   uniform    고르게 분포된 IPv4 주소, 주소마다 계정 몇 개
+//   nat        절반의 로그인이 화이트리스트에 등록된 소수의 NAT 주소에 몰리는 경우
+//   storm      접속 중인 클라이언트 전체가 끊긴 뒤 몇 초 안에 다시 접속하는 경우 (재접속 구간만 측정)
+//
+// 사용법: iplimit-admission-bench [--logins N] [--ips N] [--clients N] [--threads N] [--seed N]
+#include "iplimit-admission-engine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // 처리한 로그인 수로 흐르는 가상 시계 (LOGINS_PER_SECOND 건마다 1초)
+    class VirtualClock : public AdmissionClock
+    {
+    public:
+        static constexpr uint64_t LOGINS_PER_SECOND = 2000;
+
+        uint32_t Now() const override
+        {
+            return BASE_TIME + static_cast<uint32_t>(_logins.load(std::memory_order_relaxed) / LOGINS_PER_SECOND);
+        }
+
+        void Advance(uint64_t logins) { _logins.fetch_add(logins, std::memory_order_relaxed); }
+
+    private:
+        static constexpr uint32_t BASE_TIME = 1700000000;
+        std::atomic<uint64_t> _logins{ 0 };
+    };
+
+    // 작업 부하마다 새로 만드는 엔진과 상태
+    struct Harness
+    {
+        MemoryAdmissionStorage::HistoryMap history;
+        IpSessionRegistry sessions;
+        KickScheduler kicks;
+        VirtualClock clock;
+        MemoryAdmissionStorage storage{ history, sessions };
+        AdmissionEngine engine{ clock, storage, &kicks };
+    };
+
+    struct Login
+    {
+        IpAddress ip;
+        uint32_t accountId;
+    };
+
+    struct Options
+    {
+        uint64_t logins = 1000000;
+        uint32_t ips = 200000;
+        uint32_t clients = 50000;
+        uint32_t threads = 0;
+        uint64_t seed = 42;
+    };
+
+    struct Result
+    {
+        uint64_t logins = 0;
+        uint64_t admitted = 0;
+        uint64_t denied = 0;
+        double seconds = 0.0;
+        std::vector<uint32_t> latencies;    // ns
+    };
+
+    // 스레드 하나가 맡은 로그인 목록을 처리합니다.
+    // 서버 훅과 같은 순서(세션 등록 -> 월드 입장 -> 판정)로 호출하고, 거부된 세션은 바로 정리합니다.
+    // 온라인 인원이 onlineCap 을 넘으면 가장 오래된 세션부터 로그아웃시킵니다. (0 이면 무제한)
+    void RunLogins(Harness& harness, AdmissionPolicy const& policy, std::vector<Login> const& logins, std::size_t onlineCap, uint64_t guidBase, Result& result)
+    {
+        std::deque<uint32_t> online;
+        result.latencies.reserve(logins.size());
+
+        uint64_t pendingTicks = 0;
+        uint64_t guid = guidBase;
+
+        for (Login const& login : logins)
+        {
+            harness.sessions.OnSessionOpened(login.accountId, login.ip);
+            harness.sessions.OnPlayerEntered(login.accountId, login.ip);
+
+            auto start = std::chrono::steady_clock::now();
+            AdmissionDecision decision = harness.engine.Admit(policy, login.accountId, login.ip, ++guid);
+            auto end = std::chrono::steady_clock::now();
+
+            result.latencies.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+
+            if (decision.admitted)
+            {
+                ++result.admitted;
+                online.push_back(login.accountId);
+            }
+            else
+            {
+                ++result.denied;
+                harness.kicks.Cancel(guid);
+                harness.sessions.OnPlayerLeft(login.accountId);
+                harness.sessions.OnSessionClosed(login.accountId);
+            }
+
+            while (onlineCap && online.size() > onlineCap)
+            {
+                harness.sessions.OnPlayerLeft(online.front());
+                harness.sessions.OnSessionClosed(online.front());
+                online.pop_front();
+            }
+
+            if (++pendingTicks == 256)
+            {
+                harness.clock.Advance(pendingTicks);
+                pendingTicks = 0;
+            }
+        }
+
+        harness.clock.Advance(pendingTicks);
+        result.logins = logins.size();
+    }
+
+    // 스레드별 로그인 목록을 동시에 처리하고 결과를 합칩니다.
+    Result RunParallel(Harness& harness, AdmissionPolicy const& policy, std::vector<std::vector<Login>> const& perThread, std::size_t onlineCap)
+    {
+        std::vector<Result> results(perThread.size());
+        std::vector<std::thread> workers;
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < perThread.size(); ++i)
+        {
+            workers.emplace_back([&, i]()
+            {
+                RunLogins(harness, policy, perThread[i], onlineCap, static_cast<uint64_t>(i) << 40, results[i]);
+            });
+        }
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        Result total;
+        total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (Result& result : results)
+        {
+            total.logins += result.logins;
+            total.admitted += result.admitted;
+            total.denied += result.denied;
+            total.latencies.insert(total.latencies.end(), result.latencies.begin(), result.latencies.end());
+        }
+
+        return total;
+    }
+
+    uint32_t Percentile(std::vector<uint32_t>& values, double fraction)
+    {
+        if (values.empty())
+        {
+            return 0;
+        }
+
+        std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(fraction * static_cast<double>(values.size())));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    void PrintHeader(uint32_t threads)
+    {
+        std::printf("threads: %u\n", threads);
+        std::printf("%-10s %10s %12s %9s %9s %10s %10s %12s %10s\n",
+            "workload", "logins", "logins/s", "p50(ns)", "p99(ns)", "admitted", "denied", "tracked IPs", "bytes/IP");
+    }
+
+    void PrintResult(char const* name, Result& result, Harness const& harness)
+    {
+        std::size_t tracked = harness.storage.TrackedIpCount();
+        std::size_t bytes = harness.storage.MemoryUsage();
+        uint32_t p50 = Percentile(result.latencies, 0.50);
+        uint32_t p99 = Percentile(result.latencies, 0.99);
+
+        std::printf("%-10s %10llu %12.0f %9u %9u %10llu %10llu %12zu %10.1f\n",
+            name,
+            static_cast<unsigned long long>(result.logins),
+            result.seconds > 0.0 ? static_cast<double>(result.logins) / result.seconds : 0.0,
+            p50, p99,
+            static_cast<unsigned long long>(result.admitted),
+            static_cast<unsigned long long>(result.denied),
+            tracked,
+            tracked ? static_cast<double>(bytes) / static_cast<double>(tracked) : 0.0);
+    }
+
+    // 스레드마다 같은 계정이 섞이지 않도록 계정 번호로 나눕니다. (한 계정의 세션은 한 스레드만 다룹니다)
+    std::vector<std::vector<Login>> Split(std::vector<Login> const& logins, uint32_t threads)
+    {
+        std::vector<std::vector<Login>> perThread(threads);
+        for (Login const& login : logins)
+        {
+            perThread[login.accountId % threads].push_back(login);
+        }
+
+        return perThread;
+    }
+
+    IpAddress RandomV4(std::mt19937_64& random)
+    {
+        // 사설/예약 대역과 상관없이 32비트 전체에서 고릅니다.
+        return IpAddress::FromV4(static_cast<uint32_t>(random()));
+    }
+
+    // 1. 고르게 분포된 IP: IP마다 계정 2개, 무작위 순서로 로그인
+    void RunUniform(Options const& options, uint32_t threads)
+    {
+        std::mt19937_64 random(options.seed);
+        std::vector<IpAddress> ips(options.ips);
+        for (IpAddress& ip : ips)
+        {
+            ip = RandomV4(random);
+        }
+
+        uint32_t accounts = options.ips * 2;
+        std::uniform_int_distribution<uint32_t> pickAccount(1, accounts);
+
+        std::vector<Login> logins(options.logins);
+        for (Login& login : logins)
+        {
+            login.accountId = pickAccount(random);
+            login.ip = ips[login.accountId % options.ips];
+        }
+
+        Harness harness;
+        AdmissionPolicy policy;
+        policy.maxAccount = 2;
+        policy.rateLimitMaxUniqueAccounts = 3;
+
+        Result result = RunParallel(harness, policy, Split(logins, threads), options.ips / 4 / threads);
+        PrintResult("uniform", result, harness);
+    }
+
+    // 2. NAT 집중: 64개 NAT 주소(화이트리스트 /24 대역)에 로그인의 절반, 계정 수천 개가 공유
+    void RunHeavyHitter(Options const& options, uint32_t threads)
+    {
+        static constexpr uint32_t NAT_COUNT = 64;
+        static constexpr uint32_t NAT_ACCOUNTS = 32768;
+
+        std::mt19937_64 random(options.seed + 1);
+
+        Harness harness;
+        AdmissionEngine::AllowList allowList;
+        std::vector<IpAddress> natIps(NAT_COUNT);
+        for (uint32_t i = 0; i < NAT_COUNT; ++i)
+        {
+            IpPrefix prefix;
+            IpPrefix::Parse("100.64." + std::to_string(i) + ".0/24", prefix);
+            allowList.Insert(prefix, { 512, 1024 });
+            natIps[i] = IpAddress::FromV4((100u << 24) | (64u << 16) | (i << 8) | 1);
+        }
+
+        harness.engine.ReplaceAllowList(std::move(allowList));
+
+        std::vector<IpAddress> ips(options.ips);
+        for (IpAddress& ip : ips)
+        {
+            ip = RandomV4(random);
+        }
+
+        // NAT 주소는 앞쪽 주소일수록 더 자주 쓰이도록 (대략 Zipf)
+        std::vector<double> weights(NAT_COUNT);
+        for (uint32_t i = 0; i < NAT_COUNT; ++i)
+        {
+            weights[i] = 1.0 / (i + 1);
+        }
+
+        std::discrete_distribution<uint32_t> pickNat(weights.begin(), weights.end());
+        std::uniform_int_distribution<uint32_t> pickNatAccount(1, NAT_ACCOUNTS);
+        std::uniform_int_distribution<uint32_t> pickAccount(1, options.ips * 2);
+        std::bernoulli_distribution behindNat(0.5);
+
+        std::vector<Login> logins(options.logins);
+        for (Login& login : logins)
+        {
+            if (behindNat(random))
+            {
+                login.accountId = pickNatAccount(random);
+                login.ip = natIps[pickNat(random)];
+            }
+            else
+            {
+                login.accountId = NAT_ACCOUNTS + pickAccount(random);
+                login.ip = ips[login.accountId % options.ips];
+            }
+        }
+
+        AdmissionPolicy policy;
+        policy.maxAccount = 2;
+        policy.rateLimitMaxUniqueAccounts = 3;
+
+        Result result = RunParallel(harness, policy, Split(logins, threads), options.ips / 4 / threads);
+        PrintResult("nat", result, harness);
+    }
+
+    // 3. 재접속 폭주: clients 명이 접속해 있다가 모두 끊긴 뒤 무작위 순서로 다시 접속
+    void RunReconnectStorm(Options const& options, uint32_t threads)
+    {
+        std::mt19937_64 random(options.seed + 2);
+
+        // 대부분은 주소 하나에 혼자, 일부는 가정/PC방처럼 주소를 공유합니다.
+        uint32_t ipCount = std::max<uint32_t>(1, options.clients * 4 / 5);
+        std::vector<IpAddress> ips(ipCount);
+        for (IpAddress& ip : ips)
+        {
+            ip = RandomV4(random);
+        }
+
+        std::vector<Login> logins(options.clients);
+        for (uint32_t i = 0; i < options.clients; ++i)
+        {
+            logins[i].accountId = i + 1;
+            logins[i].ip = ips[i % ipCount];
+        }
+
+        AdmissionPolicy policy;
+        policy.maxAccount = 3;
+        policy.rateLimitMaxUniqueAccounts = 3;
+
+        Harness harness;
+
+        // 접속 상태를 만든 뒤 (측정하지 않음) 모든 세션을 끊습니다.
+        RunParallel(harness, policy, Split(logins, threads), 0);
+        for (Login const& login : logins)
+        {
+            harness.sessions.OnPlayerLeft(login.accountId);
+            harness.sessions.OnSessionClosed(login.accountId);
+        }
+
+        harness.clock.Advance(VirtualClock::LOGINS_PER_SECOND * 30);
+
+        std::shuffle(logins.begin(), logins.end(), random);
+        Result result = RunParallel(harness, policy, Split(logins, threads), 0);
+        PrintResult("storm", result, harness);
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+
+            uint64_t value = std::strtoull(argv[i + 1], nullptr, 10);
+            if (!std::strcmp(argv[i], "--logins"))
+                options.logins = value;
+            else if (!std::strcmp(argv[i], "--ips"))
+                options.ips = static_cast<uint32_t>(std::max<uint64_t>(1, value));
+            else if (!std::strcmp(argv[i], "--clients"))
+                options.clients = static_cast<uint32_t>(value);
+            else if (!std::strcmp(argv[i], "--threads"))
+                options.threads = static_cast<uint32_t>(value);
+            else if (!std::strcmp(argv[i], "--seed"))
+                options.seed = value;
+            else
+                return false;
+
+            ++i;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: %s [--logins N] [--ips N] [--clients N] [--threads N] [--seed N]\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    PrintHeader(threads);
+    RunUniform(options, threads);
+    RunHeavyHitter(options, threads);
+    RunReconnectStorm(options, threads);
+    return 0;
+}
@@ -0,0 +1,488 @@
+// Filename iplimit-logquery.cpp
+// 바이너리 접속 로그 조회 도구 (AzerothCore 없이 빌드)
+//
+// IpLimitManager.AccessLog.Binary 로 남긴 logs/iplimit/*.bin 파일을 메모리 매핑하여 조회합니다.
+// 블록마다 기록된 시각 범위와 IP 블룸 필터로 대부분의 블록을 건너뛰고, 남은 블록은 여러 스레드가 나눠 읽습니다.
+// 조건은 모두 AND 로 적용되며, 같은 종류의 조건(--ip 여러 개 등)은 OR 입니다.
+//
+// 사용법: iplimit-logquery [옵션] <파일 또는 폴더>...
+//   --ip <주소>            IP 조건 (여러 번 지정 가능)
+//   --ip-file <파일>       한 줄에 하나씩 적은 IP 목록
+//   --account <id>         계정 조건 (여러 번 지정 가능)
+//   --since <시각>         이 시각 이후 (포함)   YYYY-MM-DD[ HH:MM:SS] (서버 지역 시간) 또는 유닉스 시간
+//   --until <시각>         이 시각 이전 (미포함)
+//   --summary              기록 대신 (계정, IP) 별 횟수와 처음/마지막 시각을 출력
+//   --threads <N>          조회 스레드 수 (기본: CPU 수)
+//   --stats                건너뛴 블록 수 등 조회 통계를 stderr 로 출력
+//
+// 예) 지난달 이 IP 들을 사용한 계정
+//   iplimit-logquery --ip-file ips.txt --since 2026-09-01 --until 2026-10-01 --summary logs/iplimit
+#include "iplimit-binary-log.h"
+#include "iplimit-mapped-file.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // 이보다 많은 IP 를 찾을 때는 블룸 필터 검사가 레코드 검사보다 비싸므로 건너뜁니다.
+    constexpr std::size_t MAX_BLOOM_PROBES = 4096;
+
+    struct Options
+    {
+        std::unordered_set<IpAddress, IpAddressHash> ips;
+        std::unordered_set<uint32_t> accounts;
+        int64_t since = std::numeric_limits<int64_t>::min();
+        int64_t until = std::numeric_limits<int64_t>::max();
+        bool summary = false;
+        bool stats = false;
+        uint32_t threads = 0;
+        std::vector<std::string> paths;
+    };
+
+    struct Counters
+    {
+        uint64_t blocks = 0;
+        uint64_t skippedByTime = 0;
+        uint64_t skippedByBloom = 0;
+        uint64_t damaged = 0;
+        uint64_t scanned = 0;
+    };
+
+    struct Work
+    {
+        uint32_t file;
+        uint32_t block;
+    };
+
+    std::tm LocalTime(std::time_t time)
+    {
+        std::tm result{};
+#ifdef _WIN32
+        localtime_s(&result, &time);
+#else
+        localtime_r(&time, &result);
+#endif
+        return result;
+    }
+
+    std::string FormatTime(int64_t time)
+    {
+        std::tm local = LocalTime(static_cast<std::time_t>(time));
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d",
+            local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+        return buffer;
+    }
+
+    // AccessAction 값
+    char const* ActionName(uint8_t action)
+    {
+        switch (action)
+        {
+            case 0:  return "login";
+            case 1:  return "character_logout";
+            case 2:  return "account_logout";
+            default: return "unknown";
+        }
+    }
+
+    bool ParseTime(char const* text, int64_t& out)
+    {
+        if (*text && std::strspn(text, "0123456789") == std::strlen(text))
+        {
+            out = std::strtoll(text, nullptr, 10);
+            return true;
+        }
+
+        std::tm local{};
+        int matched = std::sscanf(text, "%d-%d-%d%*[ T]%d:%d:%d",
+            &local.tm_year, &local.tm_mon, &local.tm_mday, &local.tm_hour, &local.tm_min, &local.tm_sec);
+        if (matched != 3 && matched != 6)
+        {
+            return false;
+        }
+
+        local.tm_year -= 1900;
+        local.tm_mon -= 1;
+        local.tm_isdst = -1;
+        out = static_cast<int64_t>(std::mktime(&local));
+        return true;
+    }
+
+    bool LoadIpFile(char const* path, Options& options)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::fprintf(stderr, "cannot open %s\n", path);
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line.erase(std::remove_if(line.begin(), line.end(), [](char c) { return c == ' ' || c == '\t' || c == '\r'; }), line.end());
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+
+            IpAddress ip;
+            if (!IpAddress::Parse(line, ip))
+            {
+                std::fprintf(stderr, "invalid IP in %s: %s\n", path, line.c_str());
+                return false;
+            }
+
+            options.ips.insert(ip);
+        }
+
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            char const* arg = argv[i];
+            if (!std::strcmp(arg, "--summary"))
+            {
+                options.summary = true;
+                continue;
+            }
+
+            if (!std::strcmp(arg, "--stats"))
+            {
+                options.stats = true;
+                continue;
+            }
+
+            if (std::strncmp(arg, "--", 2))
+            {
+                options.paths.push_back(arg);
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+
+            char const* value = argv[++i];
+            if (!std::strcmp(arg, "--ip"))
+            {
+                IpAddress ip;
+                if (!IpAddress::Parse(value, ip))
+                {
+                    std::fprintf(stderr, "invalid IP: %s\n", value);
+                    return false;
+                }
+
+                options.ips.insert(ip);
+            }
+            else if (!std::strcmp(arg, "--ip-file"))
+            {
+                if (!LoadIpFile(value, options))
+                {
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "--account"))
+                options.accounts.insert(static_cast<uint32_t>(std::strtoul(value, nullptr, 10)));
+            else if (!std::strcmp(arg, "--since"))
+            {
+                if (!ParseTime(value, options.since))
+                {
+                    std::fprintf(stderr, "invalid time: %s\n", value);
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "--until"))
+            {
+                if (!ParseTime(value, options.until))
+                {
+                    std::fprintf(stderr, "invalid time: %s\n", value);
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "--threads"))
+                options.threads = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else
+                return false;
+        }
+
+        return !options.paths.empty();
+    }
+
+    // 폴더는 바로 아래의 .bin 파일만 포함합니다.
+    std::vector<std::string> ExpandPaths(std::vector<std::string> const& paths)
+    {
+        std::vector<std::string> files;
+        for (std::string const& path : paths)
+        {
+            std::error_code ec;
+            if (!std::filesystem::is_directory(path, ec))
+            {
+                files.push_back(path);
+                continue;
+            }
+
+            std::vector<std::string> found;
+            for (std::filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec))
+            {
+                if (it->is_regular_file(ec) && it->path().extension() == ".bin")
+                {
+                    found.push_back(it->path().string());
+                }
+            }
+
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        }
+
+        return files;
+    }
+
+    class Query
+    {
+    public:
+        Query(Options const& options, std::vector<std::unique_ptr<MappedFile>> const& files)
+            : _options(options), _files(files), _probeIps(options.ips.size() <= MAX_BLOOM_PROBES)
+        {
+        }
+
+        void Run(std::vector<Work> const& work, uint32_t threads)
+        {
+            std::vector<std::vector<BinaryAccessLog::Record>> matches(threads);
+            std::vector<Counters> counters(threads);
+            std::vector<std::thread> workers;
+            std::atomic<std::size_t> next{ 0 };
+
+            for (uint32_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t]
+                {
+                    // 블록 하나가 32KB 남짓이므로 한 번에 몇 개씩 가져가 원자 연산 경합을 줄입니다.
+                    constexpr std::size_t BATCH = 16;
+                    for (std::size_t begin; (begin = next.fetch_add(BATCH, std::memory_order_relaxed)) < work.size();)
+                    {
+                        std::size_t end = std::min(work.size(), begin + BATCH);
+                        for (std::size_t i = begin; i < end; ++i)
+                        {
+                            ScanBlock(work[i], matches[t], counters[t]);
+                        }
+                    }
+                });
+            }
+
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+
+            for (uint32_t t = 0; t < threads; ++t)
+            {
+                _results.insert(_results.end(), matches[t].begin(), matches[t].end());
+                _counters.blocks += counters[t].blocks;
+                _counters.skippedByTime += counters[t].skippedByTime;
+                _counters.skippedByBloom += counters[t].skippedByBloom;
+                _counters.damaged += counters[t].damaged;
+                _counters.scanned += counters[t].scanned;
+            }
+
+            std::stable_sort(_results.begin(), _results.end(), [](BinaryAccessLog::Record const& left, BinaryAccessLog::Record const& right)
+            {
+                return left.time < right.time;
+            });
+        }
+
+        std::vector<BinaryAccessLog::Record> const& GetResults() const { return _results; }
+        Counters const& GetCounters() const { return _counters; }
+
+    private:
+        void ScanBlock(Work const& work, std::vector<BinaryAccessLog::Record>& out, Counters& counters) const
+        {
+            MappedFile const& file = *_files[work.file];
+            ++counters.blocks;
+
+            BinaryAccessLog::BlockInfo block;
+            if (!BinaryAccessLog::ReadBlock(file.Data(), file.Size(), work.block, block))
+            {
+                ++counters.damaged;
+                return;
+            }
+
+            if (!block.recordCount || block.maxTime < _options.since || block.minTime >= _options.until)
+            {
+                ++counters.skippedByTime;
+                return;
+            }
+
+            if (!_options.ips.empty() && _probeIps)
+            {
+                bool mayContain = false;
+                for (IpAddress const& ip : _options.ips)
+                {
+                    if (BinaryAccessLog::BloomMayContain(block.bloom, ip))
+                    {
+                        mayContain = true;
+                        break;
+                    }
+                }
+
+                if (!mayContain)
+                {
+                    ++counters.skippedByBloom;
+                    return;
+                }
+            }
+
+            counters.scanned += block.recordCount;
+            for (uint32_t i = 0; i < block.recordCount; ++i)
+            {
+                BinaryAccessLog::Record record = BinaryAccessLog::DecodeRecord(block.records + std::size_t(i) * BinaryAccessLog::RECORD_SIZE);
+                if (record.time < _options.since || record.time >= _options.until)
+                {
+                    continue;
+                }
+
+                if (!_options.ips.empty() && !_options.ips.count(record.ip))
+                {
+                    continue;
+                }
+
+                if (!_options.accounts.empty() && !_options.accounts.count(record.accountId))
+                {
+                    continue;
+                }
+
+                out.push_back(record);
+            }
+        }
+
+        Options const& _options;
+        std::vector<std::unique_ptr<MappedFile>> const& _files;
+        bool _probeIps;
+        std::vector<BinaryAccessLog::Record> _results;
+        Counters _counters;
+    };
+
+    void PrintRecords(std::vector<BinaryAccessLog::Record> const& records)
+    {
+        std::printf("datetime,ip_address,account_id,action\n");
+        for (BinaryAccessLog::Record const& record : records)
+        {
+            std::printf("%s,%s,%u,%s\n", FormatTime(record.time).c_str(), record.ip.ToString().c_str(), record.accountId, ActionName(record.action));
+        }
+    }
+
+    // 로그인 기록만 셉니다. (종료 기록은 같은 세션의 짝이므로 제외)
+    void PrintSummary(std::vector<BinaryAccessLog::Record> const& records)
+    {
+        struct Entry
+        {
+            uint64_t logins = 0;
+            int64_t first = 0;
+            int64_t last = 0;
+        };
+
+        std::map<std::pair<uint32_t, IpAddress>, Entry> entries;
+        for (BinaryAccessLog::Record const& record : records)
+        {
+            if (record.action != 0)
+            {
+                continue;
+            }
+
+            Entry& entry = entries[{ record.accountId, record.ip }];
+            if (!entry.logins++)
+            {
+                entry.first = record.time;
+            }
+
+            entry.last = record.time;
+        }
+
+        std::printf("account_id,ip_address,logins,first_seen,last_seen\n");
+        for (auto const& [key, entry] : entries)
+        {
+            std::printf("%u,%s,%llu,%s,%s\n", key.first, key.second.ToString().c_str(), static_cast<unsigned long long>(entry.logins),
+                FormatTime(entry.first).c_str(), FormatTime(entry.last).c_str());
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: %s [--ip ADDR]... [--ip-file FILE] [--account ID]... [--since TIME] [--until TIME] [--summary] [--threads N] [--stats] <file|directory>...\n", argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<Work> work;
+    for (std::string const& path : ExpandPaths(options.paths))
+    {
+        auto file = std::make_unique<MappedFile>();
+        if (!file->Open(path) || !BinaryAccessLog::IsValidFile(file->Data(), file->Size()))
+        {
+            std::fprintf(stderr, "skipping %s: not a binary access log (version %u)\n", path.c_str(), BinaryAccessLog::VERSION);
+            continue;
+        }
+
+        uint32_t index = static_cast<uint32_t>(files.size());
+        std::size_t blocks = BinaryAccessLog::BlockCount(file->Size());
+        for (std::size_t block = 0; block < blocks; ++block)
+        {
+            work.push_back({ index, static_cast<uint32_t>(block) });
+        }
+
+        files.push_back(std::move(file));
+    }
+
+    uint32_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<uint32_t>(std::max<std::size_t>(1, std::min<std::size_t>(threads, work.size())));
+
+    Query query(options, files);
+    query.Run(work, threads);
+
+    if (options.summary)
+    {
+        PrintSummary(query.GetResults());
+    }
+    else
+    {
+        PrintRecords(query.GetResults());
+    }
+
+    if (options.stats)
+    {
+        Counters const& counters = query.GetCounters();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "files %zu, blocks %llu (time-skipped %llu, bloom-skipped %llu, damaged %llu), records scanned %llu, matched %zu, threads %u, %.3fs\n",
+            files.size(), static_cast<unsigned long long>(counters.blocks), static_cast<unsigned long long>(counters.skippedByTime),
+            static_cast<unsigned long long>(counters.skippedByBloom), static_cast<unsigned long long>(counters.damaged),
+            static_cast<unsigned long long>(counters.scanned), query.GetResults().size(), threads, elapsed);
+    }
+
+    return 0;
+}
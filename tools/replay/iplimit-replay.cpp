@@ -0,0 +1,1008 @@
+// Filename iplimit-replay.cpp
+// 접속 로그 재생 시뮬레이터 (AzerothCore 없이 빌드)
+//
+// logs/iplimit 의 접속 로그(CSV, .csv.gz 또는 바이너리 .bin)를 시각 순으로 읽어, 서버와 같은 판정 엔진에
+// 가상 시계로 흘려 보내고 정책별 판정 결과를 집계합니다. "지난주에 MaxUniqueAccounts = 2, 6시간 창이었다면
+// 몇 명이 거부되었을까" 같은 질문에 답하거나, 실제 트래픽 모양으로 엔진의 처리량을 잴 때 사용합니다.
+//
+// 재생 방식
+//   - 로그의 login 은 계정 인증(세션 시작)이므로, 기본값(FriendlyKick = 0)처럼 세션 단계에서 판정합니다.
+//     --stage world 는 로그인과 동시에 월드에 입장한 것으로 보고 Admit 으로 판정합니다.
+//   - 거부된 세션은 바로 끊은 것으로 보고, 그 뒤 로그에 남은 같은 세션의 종료 기록은 무시합니다.
+//   - 모듈은 세션 종료 훅이 없어 캐릭터 종료만 기록하므로, 모든 종료 기록(CSV logout, .bin 의 두 종료)을 세션 종료로 봅니다.
+//   - GM 우회는 로그로 알 수 없으므로 적용하지 않습니다.
+//
+// 병렬화: 이벤트를 IP 해시로 --threads 개의 구역으로 나누고, 구역마다 정책별 엔진을 따로 두어 동시에 재생합니다.
+// 같은 IP의 이벤트는 항상 같은 구역에서 순서대로 처리되므로 IP별 판정은 단일 스레드 재생과 같습니다.
+// 계정이 다른 구역의 IP로 옮겨 가면 이전 구역의 세션을 닫아 주므로, 차이는 옛 IP의 늦은 종료 기록 정도입니다.
+// 파일은 여러 개를 미리 읽어 두되 파일 순서(= 시각 순서)대로 재생합니다.
+//
+// 사용법: iplimit-replay [옵션] <파일 또는 폴더>...
+//   --policy <설정>        재생할 정책 (여러 번 지정 가능, 기본: 모듈 기본값)
+//                          max=1,unique=1,window=1h,burst=0,refill=12,strikes=3,bans=60/600/3600,approx=0
+//                          (max/unique/burst 가 0 이면 해당 제한을 끔, 폭주 제한은 burst=5 처럼 지정할 때만 켜짐,
+//                           approx 는 근사 모드 오차 %)
+//   --allowlist <파일>     한 줄에 "<ip|cidr> <max_connections> <max_unique_accounts>" (custom_allowed_ips)
+//   --stage session|world  판정 시점 (기본: session)
+//   --format csv|bin       폴더에서 읽을 로그 형식 (기본: csv, 파일은 확장자로 판단)
+//   --since <시각>         이 시각 이후 (포함)   YYYY-MM-DD[ HH:MM:SS] (서버 지역 시간) 또는 유닉스 시간
+//   --until <시각>         이 시각 이전 (미포함)
+//   --threads <N>          재생 구역 수 (기본: CPU 수)
+//
+// 예) 지난주 로그를 현재 정책과 6시간/2계정 정책으로 비교
+//   iplimit-replay --since 2026-10-05 --until 2026-10-12 --policy unique=1 --policy unique=2,window=6h logs/iplimit
+#include "iplimit-admission-engine.h"
+#include "iplimit-binary-log.h"
+#include "iplimit-burst-limiter.h"
+#include "iplimit-mapped-file.h"
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    // 정리(만료 기록 제거) 간격 (가상 시간, 초)
+    constexpr uint32_t SWEEP_INTERVAL = 3600;
+
+    enum class EventAction : uint8_t
+    {
+        LOGIN,
+        CHARACTER_LOGOUT,
+        ACCOUNT_LOGOUT
+    };
+
+    struct Event
+    {
+        IpAddress ip;
+        uint32_t time = 0;
+        uint32_t accountId = 0;
+        EventAction action = EventAction::LOGIN;
+    };
+
+    struct PolicySpec
+    {
+        std::string name;
+        AdmissionPolicy policy;
+        double approximateError = 0.0;      // 0 이면 정확한 시간 창만 사용
+    };
+
+    struct Options
+    {
+        std::vector<PolicySpec> policies;
+        std::string allowListPath;
+        AdmissionStage stage = AdmissionStage::SESSION;
+        bool binary = false;
+        int64_t since = std::numeric_limits<int64_t>::min();
+        int64_t until = std::numeric_limits<int64_t>::max();
+        uint32_t threads = 0;
+        std::vector<std::string> paths;
+    };
+
+    // 파일 하나를 읽은 결과 (기록 순서)
+    struct Chunk
+    {
+        std::string path;
+        std::vector<Event> events;
+        uint64_t invalid = 0;
+        uint32_t minTime = std::numeric_limits<uint32_t>::max();
+        uint32_t maxTime = 0;
+        std::string error;
+    };
+
+    struct Tally
+    {
+        uint64_t logins = 0;
+        uint64_t admitted = 0;
+        uint64_t rate = 0;
+        uint64_t concurrent = 0;
+        uint64_t burst = 0;
+        uint64_t banned = 0;
+    };
+
+    class ReplayClock : public AdmissionClock
+    {
+    public:
+        uint32_t Now() const override { return _now; }
+        void Set(uint32_t now) { _now = now; }
+
+    private:
+        uint32_t _now = 0;
+    };
+
+    // 구역 하나에서 정책 하나를 재생하는 엔진과 상태
+    struct Simulation
+    {
+        MemoryAdmissionStorage::HistoryMap history;
+        IpSessionRegistry sessions;
+        BurstLimiter burst;
+        ReplayClock clock;
+        MemoryAdmissionStorage storage{ history, sessions };
+        AdmissionEngine engine{ clock, storage, nullptr, &burst };
+
+        Tally tally;
+        std::unordered_set<uint32_t> deniedAccounts;
+        std::unordered_set<uint32_t> rejectedSessions;  // 거부되어 끊긴 세션의 계정 (종료 기록 무시)
+        uint32_t lastSweep = 0;
+    };
+
+    std::tm LocalTime(std::time_t time)
+    {
+        std::tm result{};
+#ifdef _WIN32
+        localtime_s(&result, &time);
+#else
+        localtime_r(&time, &result);
+#endif
+        return result;
+    }
+
+    std::string FormatTime(int64_t time)
+    {
+        std::tm local = LocalTime(static_cast<std::time_t>(time));
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d",
+            local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+        return buffer;
+    }
+
+    bool ParseTime(char const* text, int64_t& out)
+    {
+        if (*text && std::strspn(text, "0123456789") == std::strlen(text))
+        {
+            out = std::strtoll(text, nullptr, 10);
+            return true;
+        }
+
+        std::tm local{};
+        int matched = std::sscanf(text, "%d-%d-%d%*[ T]%d:%d:%d",
+            &local.tm_year, &local.tm_mon, &local.tm_mday, &local.tm_hour, &local.tm_min, &local.tm_sec);
+        if (matched != 3 && matched != 6)
+        {
+            return false;
+        }
+
+        local.tm_year -= 1900;
+        local.tm_mon -= 1;
+        local.tm_isdst = -1;
+        out = static_cast<int64_t>(std::mktime(&local));
+        return true;
+    }
+
+    // 30, 90s, 15m, 6h, 7d
+    bool ParseDuration(std::string_view text, uint32_t& out)
+    {
+        if (text.empty())
+        {
+            return false;
+        }
+
+        uint32_t unit = 1;
+        switch (text.back())
+        {
+            case 's': unit = 1; break;
+            case 'm': unit = 60; break;
+            case 'h': unit = 3600; break;
+            case 'd': unit = 86400; break;
+            default: break;
+        }
+
+        if (text.back() < '0' || text.back() > '9')
+        {
+            text.remove_suffix(1);
+        }
+
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string_view::npos)
+        {
+            return false;
+        }
+
+        out = static_cast<uint32_t>(std::strtoul(std::string(text).c_str(), nullptr, 10)) * unit;
+        return true;
+    }
+
+    bool ParsePolicy(std::string const& text, PolicySpec& spec)
+    {
+        // AdmissionPolicy 의 기본값은 conf/mod-iplimit-manager.conf.dist 와 같습니다.
+        spec.name = text.empty() ? "default" : text;
+
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            std::size_t equals = item.find('=');
+            if (equals == std::string::npos)
+            {
+                return false;
+            }
+
+            std::string key = item.substr(0, equals);
+            std::string value = item.substr(equals + 1);
+            uint32_t number = 0;
+
+            if (key == "max" || key == "unique" || key == "burst" || key == "refill" || key == "strikes")
+            {
+                if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+                {
+                    return false;
+                }
+
+                number = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+            }
+
+            if (key == "max")
+            {
+                spec.policy.maxAccountEnable = number != 0;
+                spec.policy.maxAccount = number;
+            }
+            else if (key == "unique")
+            {
+                spec.policy.rateLimitEnable = number != 0;
+                spec.policy.rateLimitMaxUniqueAccounts = number;
+            }
+            else if (key == "window")
+            {
+                if (!ParseDuration(value, spec.policy.rateLimitTimeWindow))
+                {
+                    return false;
+                }
+            }
+            else if (key == "burst")
+            {
+                spec.policy.burstEnable = number != 0;
+                spec.policy.burst.capacity = std::max<uint32_t>(1, number);
+            }
+            else if (key == "refill")
+            {
+                spec.policy.burst.refillSeconds = std::max<uint32_t>(1, number);
+            }
+            else if (key == "strikes")
+            {
+                spec.policy.burst.banThreshold = std::max<uint32_t>(1, number);
+            }
+            else if (key == "bans")
+            {
+                std::stringstream durations(value);
+                std::string duration;
+                spec.policy.burst.banLevels = 0;
+                while (std::getline(durations, duration, '/') && spec.policy.burst.banLevels < BurstPolicy::MAX_BAN_LEVELS)
+                {
+                    if (!ParseDuration(duration, spec.policy.burst.banDurations[spec.policy.burst.banLevels]))
+                    {
+                        return false;
+                    }
+
+                    ++spec.policy.burst.banLevels;
+                }
+
+                if (!spec.policy.burst.banLevels)
+                {
+                    return false;
+                }
+            }
+            else if (key == "approx")
+            {
+                spec.approximateError = std::strtod(value.c_str(), nullptr);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool LoadAllowList(std::string const& path, AdmissionEngine::AllowList& allowList)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::fprintf(stderr, "cannot open %s\n", path.c_str());
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::stringstream stream(line);
+            std::string address;
+            IpLimitSettings settings{ 0, 0 };
+            if (!(stream >> address) || address[0] == '#')
+            {
+                continue;
+            }
+
+            IpPrefix prefix;
+            if (!IpPrefix::Parse(address, prefix) || !(stream >> settings.maxConnections >> settings.maxUniqueAccounts))
+            {
+                std::fprintf(stderr, "invalid allow list line in %s: %s\n", path.c_str(), line.c_str());
+                return false;
+            }
+
+            allowList.Insert(prefix, settings);
+        }
+
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            char const* arg = argv[i];
+            if (std::strncmp(arg, "--", 2))
+            {
+                options.paths.push_back(arg);
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+
+            char const* value = argv[++i];
+            if (!std::strcmp(arg, "--policy"))
+            {
+                PolicySpec spec;
+                if (!ParsePolicy(value, spec))
+                {
+                    std::fprintf(stderr, "invalid policy: %s\n", value);
+                    return false;
+                }
+
+                options.policies.push_back(spec);
+            }
+            else if (!std::strcmp(arg, "--allowlist"))
+                options.allowListPath = value;
+            else if (!std::strcmp(arg, "--stage"))
+            {
+                if (!std::strcmp(value, "session"))
+                    options.stage = AdmissionStage::SESSION;
+                else if (!std::strcmp(value, "world"))
+                    options.stage = AdmissionStage::WORLD;
+                else
+                    return false;
+            }
+            else if (!std::strcmp(arg, "--format"))
+            {
+                if (!std::strcmp(value, "csv"))
+                    options.binary = false;
+                else if (!std::strcmp(value, "bin"))
+                    options.binary = true;
+                else
+                    return false;
+            }
+            else if (!std::strcmp(arg, "--since"))
+            {
+                if (!ParseTime(value, options.since))
+                {
+                    std::fprintf(stderr, "invalid time: %s\n", value);
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "--until"))
+            {
+                if (!ParseTime(value, options.until))
+                {
+                    std::fprintf(stderr, "invalid time: %s\n", value);
+                    return false;
+                }
+            }
+            else if (!std::strcmp(arg, "--threads"))
+                options.threads = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else
+                return false;
+        }
+
+        if (options.policies.empty())
+        {
+            PolicySpec spec;
+            ParsePolicy("", spec);
+            options.policies.push_back(spec);
+        }
+
+        return !options.paths.empty();
+    }
+
+    bool IsBinaryPath(std::string const& path)
+    {
+        return std::filesystem::path(path).extension() == ".bin";
+    }
+
+    bool IsCsvPath(std::string const& path)
+    {
+        return path.ends_with(".csv") || path.ends_with(".csv.gz");
+    }
+
+    // 폴더는 바로 아래의 로그 파일만 포함합니다. 파일명(날짜_서버 시작 시각.순번)순이 곧 시각 순서입니다.
+    std::vector<std::string> ExpandPaths(Options const& options)
+    {
+        std::vector<std::string> files;
+        for (std::string const& path : options.paths)
+        {
+            std::error_code ec;
+            if (!std::filesystem::is_directory(path, ec))
+            {
+                files.push_back(path);
+                continue;
+            }
+
+            std::vector<std::string> found;
+            for (std::filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec))
+            {
+                std::string name = it->path().string();
+                if (it->is_regular_file(ec) && (options.binary ? IsBinaryPath(name) : IsCsvPath(name)))
+                {
+                    found.push_back(name);
+                }
+            }
+
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        }
+
+        return files;
+    }
+
+    uint32_t ShardOf(IpAddress const& ip, uint32_t shards)
+    {
+        return static_cast<uint32_t>((IpAddressHash()(ip) >> 16) % shards);
+    }
+
+    void AddEvent(Options const& options, Chunk& chunk, int64_t time, Event& event)
+    {
+        if (time < options.since || time >= options.until || time < 0 || time > std::numeric_limits<uint32_t>::max())
+        {
+            return;
+        }
+
+        event.time = static_cast<uint32_t>(time);
+        chunk.minTime = std::min(chunk.minTime, event.time);
+        chunk.maxTime = std::max(chunk.maxTime, event.time);
+        chunk.events.push_back(event);
+    }
+
+    // 이벤트를 IP 구역으로 나눕니다. (파일 순서대로 한 스레드에서 호출)
+    // 계정이 다른 구역의 IP로 다시 로그인하면, 한 레지스트리에서 세션이 옮겨 가는 것과 같도록
+    // 이전 구역에 같은 시각의 종료 이벤트를 넣습니다. 그러지 않으면 종료 기록이 없는 세션이 이전 구역에 계속 남습니다.
+    class EventRouter
+    {
+    public:
+        explicit EventRouter(uint32_t shards) : _shards(shards) { }
+
+        void Route(std::vector<Event> const& events, std::vector<std::vector<Event>>& out)
+        {
+            out.assign(_shards, {});
+            for (Event const& event : events)
+            {
+                uint32_t shard = ShardOf(event.ip, _shards);
+                if (event.action == EventAction::LOGIN)
+                {
+                    auto inserted = _sessionShards.try_emplace(event.accountId, shard);
+                    if (!inserted.second && inserted.first->second != shard)
+                    {
+                        Event close = event;
+                        close.action = EventAction::ACCOUNT_LOGOUT;
+                        out[inserted.first->second].push_back(close);
+                        inserted.first->second = shard;
+                    }
+                }
+                else
+                {
+                    _sessionShards.erase(event.accountId);
+                }
+
+                out[shard].push_back(event);
+            }
+        }
+
+    private:
+        uint32_t _shards;
+        std::unordered_map<uint32_t, uint32_t> _sessionShards;  // 계정 -> 마지막 세션의 구역
+    };
+
+    // datetime,ip_address,account_id,account_username,action
+    // 날짜 부분은 바뀔 때만 mktime 으로 자정 시각을 구하고, 시:분:초는 더합니다.
+    class CsvLineParser
+    {
+    public:
+        bool Parse(std::string_view line, int64_t& time, Event& event)
+        {
+            std::string_view fields[5];
+            std::size_t count = 0;
+            while (count < 5)
+            {
+                std::size_t comma = line.find(',');
+                fields[count++] = line.substr(0, comma);
+                if (comma == std::string_view::npos)
+                {
+                    break;
+                }
+
+                line.remove_prefix(comma + 1);
+            }
+
+            if (count != 5 || fields[0].size() != 19 || fields[0][10] != ' ')
+            {
+                return false;
+            }
+
+            std::string_view date = fields[0].substr(0, 10);
+            if (date != _date)
+            {
+                std::tm local{};
+                if (std::sscanf(std::string(date).c_str(), "%d-%d-%d", &local.tm_year, &local.tm_mon, &local.tm_mday) != 3)
+                {
+                    return false;
+                }
+
+                local.tm_year -= 1900;
+                local.tm_mon -= 1;
+                local.tm_isdst = -1;
+                _midnight = static_cast<int64_t>(std::mktime(&local));
+                _date = date;
+            }
+
+            std::string_view clock = fields[0].substr(11);
+            auto digits = [&clock](std::size_t at) { return (clock[at] - '0') * 10 + (clock[at + 1] - '0'); };
+            time = _midnight + digits(0) * 3600 + digits(3) * 60 + digits(6);
+
+            if (!IpAddress::Parse(fields[1], event.ip))
+            {
+                return false;
+            }
+
+            event.accountId = static_cast<uint32_t>(std::strtoul(std::string(fields[2]).c_str(), nullptr, 10));
+
+            std::string_view action = fields[4];
+            if (!action.empty() && action.back() == '\r')
+            {
+                action.remove_suffix(1);
+            }
+
+            if (action == "login")
+                event.action = EventAction::LOGIN;
+            else if (action == "logout")
+                event.action = EventAction::ACCOUNT_LOGOUT;
+            else
+                return false;
+
+            return true;
+        }
+
+    private:
+        std::string _date;
+        int64_t _midnight = 0;
+    };
+
+    // gzopen 은 압축되지 않은 파일도 그대로 읽으므로 .csv 와 .csv.gz 를 같은 경로로 처리합니다.
+    void ReadCsv(Options const& options, Chunk& chunk)
+    {
+        gzFile file = gzopen(chunk.path.c_str(), "rb");
+        if (!file)
+        {
+            chunk.error = "cannot open";
+            return;
+        }
+
+        gzbuffer(file, 256 * 1024);
+
+        CsvLineParser parser;
+        std::vector<char> buffer(1 << 20);
+        std::string carry;
+        bool header = true;
+
+        auto handleLine = [&](std::string_view line)
+        {
+            if (header)
+            {
+                header = false;
+                if (line.starts_with("datetime,"))
+                {
+                    return;
+                }
+            }
+
+            if (line.empty())
+            {
+                return;
+            }
+
+            int64_t time = 0;
+            Event event;
+            if (!parser.Parse(line, time, event))
+            {
+                ++chunk.invalid;
+                return;
+            }
+
+            AddEvent(options, chunk, time, event);
+        };
+
+        int read;
+        while ((read = gzread(file, buffer.data(), static_cast<unsigned>(buffer.size()))) > 0)
+        {
+            std::string_view data(buffer.data(), static_cast<std::size_t>(read));
+            std::size_t newline;
+            while ((newline = data.find('\n')) != std::string_view::npos)
+            {
+                if (carry.empty())
+                {
+                    handleLine(data.substr(0, newline));
+                }
+                else
+                {
+                    carry.append(data.substr(0, newline));
+                    handleLine(carry);
+                    carry.clear();
+                }
+
+                data.remove_prefix(newline + 1);
+            }
+
+            carry.append(data);
+        }
+
+        if (read < 0)
+        {
+            int code = 0;
+            chunk.error = gzerror(file, &code);
+        }
+
+        if (!carry.empty())
+        {
+            handleLine(carry);
+        }
+
+        gzclose(file);
+    }
+
+    void ReadBinary(Options const& options, Chunk& chunk)
+    {
+        MappedFile file;
+        if (!file.Open(chunk.path))
+        {
+            chunk.error = "cannot open";
+            return;
+        }
+
+        if (!BinaryAccessLog::IsValidFile(file.Data(), file.Size()))
+        {
+            chunk.error = "not a binary access log";
+            return;
+        }
+
+        for (std::size_t index = 0, blocks = BinaryAccessLog::BlockCount(file.Size()); index < blocks; ++index)
+        {
+            BinaryAccessLog::BlockInfo block;
+            if (!BinaryAccessLog::ReadBlock(file.Data(), file.Size(), index, block))
+            {
+                ++chunk.invalid;
+                continue;
+            }
+
+            if (block.maxTime < options.since || block.minTime >= options.until)
+            {
+                continue;
+            }
+
+            for (uint32_t i = 0; i < block.recordCount; ++i)
+            {
+                BinaryAccessLog::Record record = BinaryAccessLog::DecodeRecord(block.records + i * BinaryAccessLog::RECORD_SIZE);
+                if (record.action > static_cast<uint8_t>(EventAction::ACCOUNT_LOGOUT))
+                {
+                    ++chunk.invalid;
+                    continue;
+                }
+
+                Event event;
+                event.ip = record.ip;
+                event.accountId = record.accountId;
+                event.action = static_cast<EventAction>(record.action);
+                AddEvent(options, chunk, record.time, event);
+            }
+        }
+    }
+
+    Chunk ReadChunk(Options const& options, std::string const& path)
+    {
+        Chunk chunk;
+        chunk.path = path;
+
+        if (IsBinaryPath(path))
+        {
+            ReadBinary(options, chunk);
+        }
+        else
+        {
+            ReadCsv(options, chunk);
+        }
+
+        return chunk;
+    }
+
+    // 모듈의 SweepLoginHistory 와 같이 시간 창이 지난 기록과 빈 IP를 지웁니다. (구역마다 한 스레드이므로 한 번에 전체)
+    void Sweep(Simulation& simulation, AdmissionPolicy const& policy, uint32_t now)
+    {
+        simulation.history.ForEachShard([&](std::size_t, auto& historyMap)
+        {
+            std::size_t cursor = 0;
+            historyMap.sweep(cursor, historyMap.capacity(), [&](IpAddress const&, LoginWindow& window)
+            {
+                window.Expire(now, policy.rateLimitTimeWindow);
+                return window.Empty();
+            });
+
+            historyMap.shrink_to_fit();
+        });
+
+        // BurstLimiter::Sweep 은 호출마다 샤드 하나를 끝까지 돕니다.
+        simulation.storage.SweepSketches(now);
+        for (std::size_t i = 0; i < MemoryAdmissionStorage::HistoryMap::SHARD_COUNT; ++i)
+        {
+            simulation.burst.Sweep(policy.burst, now, std::numeric_limits<uint32_t>::max());
+        }
+    }
+
+    void Replay(Simulation& simulation, AdmissionPolicy const& policy, AdmissionStage stage, std::vector<Event> const& events)
+    {
+        for (Event const& event : events)
+        {
+            simulation.clock.Set(event.time);
+
+            if (event.action != EventAction::LOGIN)
+            {
+                if (simulation.rejectedSessions.erase(event.accountId))
+                {
+                    continue;
+                }
+
+                simulation.sessions.OnPlayerLeft(event.accountId);
+                simulation.sessions.OnSessionClosed(event.accountId);
+                continue;
+            }
+
+            simulation.rejectedSessions.erase(event.accountId);
+            simulation.sessions.OnSessionOpened(event.accountId, event.ip);
+
+            AdmissionDecision decision;
+            if (stage == AdmissionStage::SESSION)
+            {
+                decision = simulation.engine.AdmitSession(policy, event.accountId, event.ip);
+                if (decision.admitted)
+                {
+                    simulation.sessions.OnSessionAdmitted(event.accountId, event.ip);
+                }
+            }
+            else
+            {
+                simulation.sessions.OnPlayerEntered(event.accountId, event.ip);
+                decision = simulation.engine.Admit(policy, event.accountId, event.ip, 0);
+            }
+
+            Tally& tally = simulation.tally;
+            ++tally.logins;
+            if (decision.admitted)
+            {
+                ++tally.admitted;
+            }
+            else
+            {
+                switch (decision.reason)
+                {
+                    case KickReason::RATE_LIMIT:       ++tally.rate; break;
+                    case KickReason::CONCURRENT_LIMIT: ++tally.concurrent; break;
+                    case KickReason::BURST_LIMIT:      ++tally.burst; break;
+                    case KickReason::TEMP_BAN:         ++tally.banned; break;
+                }
+
+                simulation.deniedAccounts.insert(event.accountId);
+                simulation.rejectedSessions.insert(event.accountId);
+                simulation.sessions.OnPlayerLeft(event.accountId);
+                simulation.sessions.OnSessionClosed(event.accountId);
+            }
+
+            if (event.time >= simulation.lastSweep + SWEEP_INTERVAL)
+            {
+                if (simulation.lastSweep)
+                {
+                    Sweep(simulation, policy, event.time);
+                }
+
+                simulation.lastSweep = event.time;
+            }
+        }
+    }
+
+    void PrintResults(Options const& options, std::vector<std::vector<std::unique_ptr<Simulation>>> const& simulations)
+    {
+        std::printf("%-40s %10s %10s %9s %10s %9s %9s %14s\n",
+            "policy", "logins", "admitted", "rate", "concurrent", "burst", "banned", "denied accts");
+
+        for (std::size_t p = 0; p < options.policies.size(); ++p)
+        {
+            Tally total;
+            std::unordered_set<uint32_t> deniedAccounts;
+            for (auto const& shard : simulations)
+            {
+                Simulation const& simulation = *shard[p];
+                total.logins += simulation.tally.logins;
+                total.admitted += simulation.tally.admitted;
+                total.rate += simulation.tally.rate;
+                total.concurrent += simulation.tally.concurrent;
+                total.burst += simulation.tally.burst;
+                total.banned += simulation.tally.banned;
+                deniedAccounts.insert(simulation.deniedAccounts.begin(), simulation.deniedAccounts.end());
+            }
+
+            std::printf("%-40s %10llu %10llu %9llu %10llu %9llu %9llu %14zu\n",
+                options.policies[p].name.c_str(),
+                static_cast<unsigned long long>(total.logins),
+                static_cast<unsigned long long>(total.admitted),
+                static_cast<unsigned long long>(total.rate),
+                static_cast<unsigned long long>(total.concurrent),
+                static_cast<unsigned long long>(total.burst),
+                static_cast<unsigned long long>(total.banned),
+                deniedAccounts.size());
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "usage: %s [--policy key=value,...]... [--allowlist FILE] [--stage session|world] [--format csv|bin]\n"
+            "       [--since TIME] [--until TIME] [--threads N] <file or directory>...\n", argv[0]);
+        return 1;
+    }
+
+    AdmissionEngine::AllowList allowList;
+    if (!options.allowListPath.empty() && !LoadAllowList(options.allowListPath, allowList))
+    {
+        return 1;
+    }
+
+    std::vector<std::string> files = ExpandPaths(options);
+    if (files.empty())
+    {
+        std::fprintf(stderr, "no access log files found\n");
+        return 1;
+    }
+
+    uint32_t shards = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    // 구역 x 정책 별 엔진
+    std::vector<std::vector<std::unique_ptr<Simulation>>> simulations(shards);
+    for (auto& shard : simulations)
+    {
+        for (PolicySpec const& spec : options.policies)
+        {
+            auto simulation = std::make_unique<Simulation>();
+            simulation->engine.ReplaceAllowList(AdmissionEngine::AllowList(allowList));
+            if (spec.approximateError > 0.0)
+            {
+                simulation->storage.EnableSketches(UniqueAccountSketch::PrecisionForError(spec.approximateError / 100.0), 24, 64);
+            }
+
+            shard.push_back(std::move(simulation));
+        }
+    }
+
+    uint64_t events = 0;
+    uint64_t invalid = 0;
+    uint32_t minTime = std::numeric_limits<uint32_t>::max();
+    uint32_t maxTime = 0;
+    double replaySeconds = 0.0;
+
+    EventRouter router(shards);
+    std::vector<std::vector<Event>> shardEvents;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // 다음 파일들을 미리 읽어 두고, 읽은 순서가 아닌 파일 순서대로 재생합니다.
+    std::deque<std::future<Chunk>> reading;
+    std::size_t next = 0;
+    auto fill = [&]()
+    {
+        while (next < files.size() && reading.size() < std::max<std::size_t>(2, shards / 2))
+        {
+            reading.push_back(std::async(std::launch::async, ReadChunk, std::cref(options), files[next++]));
+        }
+    };
+
+    fill();
+    while (!reading.empty())
+    {
+        Chunk chunk = reading.front().get();
+        reading.pop_front();
+        fill();
+
+        if (!chunk.error.empty())
+        {
+            std::fprintf(stderr, "%s: %s\n", chunk.path.c_str(), chunk.error.c_str());
+        }
+
+        events += chunk.events.size();
+        invalid += chunk.invalid;
+        if (chunk.events.empty())
+        {
+            continue;
+        }
+
+        minTime = std::min(minTime, chunk.minTime);
+        maxTime = std::max(maxTime, chunk.maxTime);
+
+        auto replayStart = std::chrono::steady_clock::now();
+
+        router.Route(chunk.events, shardEvents);
+        chunk.events = {};
+
+        std::vector<std::thread> workers;
+        workers.reserve(shards);
+        for (uint32_t s = 0; s < shards; ++s)
+        {
+            workers.emplace_back([&, s]()
+            {
+                for (std::size_t p = 0; p < options.policies.size(); ++p)
+                {
+                    Replay(*simulations[s][p], options.policies[p].policy, options.stage, shardEvents[s]);
+                }
+            });
+        }
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        replaySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!events)
+    {
+        std::fprintf(stderr, "no events in range\n");
+        return 1;
+    }
+
+    uint64_t decisions = 0;
+    for (auto const& shard : simulations)
+    {
+        for (auto const& simulation : shard)
+        {
+            decisions += simulation->tally.logins;
+        }
+    }
+
+    double span = static_cast<double>(maxTime - minTime);
+    std::printf("files: %zu, events: %llu (invalid %llu), range: %s ~ %s, threads: %u, stage: %s\n",
+        files.size(), static_cast<unsigned long long>(events), static_cast<unsigned long long>(invalid),
+        FormatTime(minTime).c_str(), FormatTime(maxTime).c_str(), shards, options.stage == AdmissionStage::SESSION ? "session" : "world");
+    PrintResults(options, simulations);
+    std::printf("decisions: %llu in %.2fs (replay %.2fs): %.0f decisions/s, %.0fx real time\n",
+        static_cast<unsigned long long>(decisions), wallSeconds, replaySeconds,
+        replaySeconds > 0.0 ? static_cast<double>(decisions) / replaySeconds : 0.0,
+        wallSeconds > 0.0 ? span / wallSeconds : 0.0);
+    return 0;
+}